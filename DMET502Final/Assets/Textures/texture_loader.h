@@ -1,38 +1,11 @@
 #pragma once
-#include <GLUT/glut.h>
-#include <stdio.h>
+#include "../../TextureManager.h"
 
-GLuint loadBMP(const char* filename) {
-    FILE* file = fopen(filename, "rb");
-    if (!file) { printf("Failed to open %s\n", filename); return 0; }
-
-    unsigned char header[54];
-    fread(header, 1, 54, file);
-
-    unsigned int dataPos   = *(int*)&(header[0x0A]);
-    unsigned int imageSize = *(int*)&(header[0x22]);
-    unsigned int width     = *(int*)&(header[0x12]);
-    unsigned int height    = *(int*)&(header[0x16]);
-
-    if (imageSize == 0) imageSize = width * height * 3;
-    if (dataPos == 0) dataPos = 54;
-
-    unsigned char* data = new unsigned char[imageSize];
-    fread(data, 1, imageSize, file);
-    fclose(file);
-
-    GLuint texID;
-    glGenTextures(1, &texID);
-    glBindTexture(GL_TEXTURE_2D, texID);
-
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height,
-                 0, GL_BGR, GL_UNSIGNED_BYTE, data);
-
-    delete[] data;
-    return texID;
+// Legacy entry point, kept inline so it can be included from several
+// translation units. Goes through the shared texture registry: repeated
+// loads of one file share a texture; pair with textures.release().
+inline TextureHandle loadBMP(const char* filename) {
+    return textures.acquire(filename);
 }
 //
 //  texture_loader.h
@@ -40,4 +13,3 @@ GLuint loadBMP(const char* filename) {
 //
 //  Created by omar on 08/12/2025.
 //
-
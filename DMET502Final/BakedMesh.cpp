@@ -0,0 +1,172 @@
+#include "BakedMesh.h"
+#include <cstdio>
+#include <cstring>
+#include <cstddef>
+#include <sys/stat.h>
+
+namespace {
+
+const char BAKED_MAGIC[4] = { 'B', 'M', 'S', 'H' };
+
+uint64_t fnv1a(const char *data, size_t size) {
+    uint64_t h = 1469598103934665603ULL;
+    for (size_t i = 0; i < size; i++) {
+        h ^= (unsigned char)data[i];
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+bool statSource(const std::string &path, uint64_t &size, int64_t &mtime) {
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0) return false;
+    size = (uint64_t)st.st_size;
+    mtime = (int64_t)st.st_mtime;
+    return true;
+}
+
+bool hashSource(const std::string &path, uint64_t &hash) {
+    MappedFile src;
+    if (!src.open(path)) return false;
+    hash = fnv1a(src.data(), src.size());
+    return true;
+}
+
+// Records a new mtime in an otherwise valid cache so the next launch
+// can skip the content hash.
+void restamp(const std::string &bakePath, int64_t mtime) {
+    FILE *f = fopen(bakePath.c_str(), "r+b");
+    if (!f) return;
+    if (fseek(f, offsetof(BakedMeshHeader, sourceMtime), SEEK_SET) == 0)
+        fwrite(&mtime, sizeof(mtime), 1, f);
+    fclose(f);
+}
+
+}
+
+std::string bakedMeshPath(const std::string &sourcePath) {
+    return sourcePath + ".bake";
+}
+
+BakedMeshFile::BakedMeshFile() : verts(nullptr), idx(nullptr) {
+    memset(&header, 0, sizeof(header));
+}
+
+void BakedMeshFile::close() {
+    file.close();
+    verts = nullptr;
+    idx = nullptr;
+    memset(&header, 0, sizeof(header));
+}
+
+bool BakedMeshFile::open(const std::string &sourcePath) {
+    close();
+    if (!file.open(bakedMeshPath(sourcePath))) return false;
+
+    if (file.size() < sizeof(BakedMeshHeader)) { close(); return false; }
+    memcpy(&header, file.data(), sizeof(header));
+
+    // Blobs in order, header < vertices <= indices <= end of file, with
+    // each bound checked before it is added to so nothing can wrap
+    uint64_t vertexEnd = header.vertexOffset + (uint64_t)header.vertexCount * sizeof(MeshVertex);
+    bool valid = memcmp(header.magic, BAKED_MAGIC, 4) == 0 &&
+                 header.version == BAKED_MESH_VERSION &&
+                 header.headerSize == sizeof(BakedMeshHeader) &&
+                 header.vertexStride == sizeof(MeshVertex) &&
+                 header.vertexOffset % 16 == 0 &&
+                 header.vertexOffset >= sizeof(BakedMeshHeader) &&
+                 header.vertexOffset <= file.size() &&
+                 vertexEnd <= file.size() &&
+                 header.indexOffset % sizeof(uint32_t) == 0 &&
+                 header.indexOffset >= vertexEnd &&
+                 header.indexOffset <= file.size() &&
+                 header.indexOffset + (uint64_t)header.indexCount * sizeof(uint32_t) <= file.size() &&
+                 header.lodCount >= 1 && header.lodCount <= BAKED_MESH_MAX_LODS;
+    uint64_t lodIndices = 0;
+    for (uint32_t i = 0; valid && i < header.lodCount; i++) {
+        if (header.lodIndexCount[i] % 3 != 0) valid = false;
+        lodIndices += header.lodIndexCount[i];
+    }
+    if (!valid || lodIndices != header.indexCount) { close(); return false; }
+
+    // Drawing indexes per-vertex arrays with these unchecked, so one bad
+    // value would write out of bounds; far cheaper than parsing the OBJ.
+    const uint32_t *scan = (const uint32_t *)(file.data() + header.indexOffset);
+    for (uint32_t i = 0; i < header.indexCount; i++)
+        if (scan[i] >= header.vertexCount) { close(); return false; }
+
+    // A missing source means the cache shipped on its own; use it as is.
+    uint64_t size;
+    int64_t mtime;
+    if (statSource(sourcePath, size, mtime)) {
+        if (size != header.sourceSize) { close(); return false; }
+        if (mtime != header.sourceMtime) {
+            // Touched but maybe not edited (e.g. a fresh checkout)
+            uint64_t hash;
+            if (!hashSource(sourcePath, hash) || hash != header.sourceHash) { close(); return false; }
+            restamp(bakedMeshPath(sourcePath), mtime);
+        }
+    }
+
+    verts = (const MeshVertex *)(file.data() + header.vertexOffset);
+    idx = (const unsigned int *)(file.data() + header.indexOffset);
+    return true;
+}
+
+bool writeBakedMesh(const std::string &sourcePath,
+                    const std::vector<MeshVertex> &vertices,
+                    const std::vector<unsigned int> &indices,
+                    const std::vector<uint32_t> &lodIndexCounts,
+                    const std::vector<float> &lodErrors) {
+    if (lodIndexCounts.empty() || lodIndexCounts.size() > BAKED_MESH_MAX_LODS ||
+        lodErrors.size() != lodIndexCounts.size()) return false;
+
+    BakedMeshHeader h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, BAKED_MAGIC, 4);
+    h.version = BAKED_MESH_VERSION;
+    h.headerSize = sizeof(BakedMeshHeader);
+    h.vertexStride = sizeof(MeshVertex);
+    if (!statSource(sourcePath, h.sourceSize, h.sourceMtime)) return false;
+    if (!hashSource(sourcePath, h.sourceHash)) return false;
+
+    h.vertexCount = (uint32_t)vertices.size();
+    h.indexCount = (uint32_t)indices.size();
+    h.vertexOffset = (sizeof(BakedMeshHeader) + 15) & ~(uint64_t)15;
+    h.indexOffset = h.vertexOffset + (uint64_t)vertices.size() * sizeof(MeshVertex);
+
+    h.lodCount = (uint32_t)lodIndexCounts.size();
+    for (uint32_t i = 0; i < h.lodCount; i++) {
+        h.lodIndexCount[i] = lodIndexCounts[i];
+        h.lodError[i] = lodErrors[i];
+    }
+
+    for (int k = 0; k < 3; k++) { h.boundsMin[k] = 0.0f; h.boundsMax[k] = 0.0f; }
+    for (size_t i = 0; i < vertices.size(); i++) {
+        const float p[3] = { vertices[i].px, vertices[i].py, vertices[i].pz };
+        for (int k = 0; k < 3; k++) {
+            if (i == 0 || p[k] < h.boundsMin[k]) h.boundsMin[k] = p[k];
+            if (i == 0 || p[k] > h.boundsMax[k]) h.boundsMax[k] = p[k];
+        }
+    }
+
+    std::string finalPath = bakedMeshPath(sourcePath);
+    std::string tmpPath = finalPath + ".tmp";
+    FILE *f = fopen(tmpPath.c_str(), "wb");
+    if (!f) return false;
+
+    static const char zeros[16] = { 0 };
+    bool ok = fwrite(&h, sizeof(h), 1, f) == 1 &&
+              fwrite(zeros, 1, h.vertexOffset - sizeof(h), f) == h.vertexOffset - sizeof(h);
+    if (ok && !vertices.empty())
+        ok = fwrite(&vertices[0], sizeof(MeshVertex), vertices.size(), f) == vertices.size();
+    if (ok && !indices.empty())
+        ok = fwrite(&indices[0], sizeof(unsigned int), indices.size(), f) == indices.size();
+    ok = (fclose(f) == 0) && ok;
+
+    if (!ok || rename(tmpPath.c_str(), finalPath.c_str()) != 0) {
+        remove(tmpPath.c_str());
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,78 @@
+#ifndef BAKEDMESH_H
+#define BAKEDMESH_H
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include "GpuMesh.h"
+#include "MappedFile.h"
+
+// Binary mesh cache written next to the source OBJ ("<file>.obj.bake").
+// Layout (native byte order):
+//   BakedMeshHeader
+//   MeshVertex[vertexCount]        at vertexOffset (16-byte aligned)
+//   uint32_t[indexCount]           at indexOffset
+// The index array holds every level of detail back to back, full mesh
+// first; all levels share the vertices (see MeshSimplify.h).
+// The header records the source file's size, mtime and content hash;
+// a cache whose stamp no longer matches its source is ignored. Layout and
+// every index are checked on open whether or not the source exists.
+const uint32_t BAKED_MESH_VERSION = 2;
+const uint32_t BAKED_MESH_MAX_LODS = 4;
+
+struct BakedMeshHeader {
+    char     magic[4];          // "BMSH"
+    uint32_t version;
+    uint32_t headerSize;
+    uint32_t vertexStride;      // sizeof(MeshVertex)
+    uint64_t sourceSize;
+    int64_t  sourceMtime;
+    uint64_t sourceHash;        // FNV-1a 64 of the OBJ bytes
+    uint32_t vertexCount;
+    uint32_t indexCount;
+    uint64_t vertexOffset;
+    uint64_t indexOffset;
+    float    boundsMin[3];
+    float    boundsMax[3];
+    uint32_t lodCount;          // 1..BAKED_MESH_MAX_LODS
+    uint32_t lodIndexCount[BAKED_MESH_MAX_LODS];
+    float    lodError[BAKED_MESH_MAX_LODS];     // model units, 0 for the full mesh
+};
+
+// Read-only view of a validated cache file; the blobs point straight into
+// the mapping and stay valid until close().
+class BakedMeshFile {
+public:
+    BakedMeshFile();
+
+    bool open(const std::string &sourcePath);
+    void close();
+
+    const MeshVertex *vertices() const { return verts; }
+    const unsigned int *indices() const { return idx; }
+    uint32_t vertexCount() const { return header.vertexCount; }
+    uint32_t indexCount() const { return header.indexCount; }
+    const float *boundsMin() const { return header.boundsMin; }
+    const float *boundsMax() const { return header.boundsMax; }
+    uint32_t lodCount() const { return header.lodCount; }
+    uint32_t lodIndexCount(int lod) const { return header.lodIndexCount[lod]; }
+    float lodError(int lod) const { return header.lodError[lod]; }
+
+private:
+    MappedFile file;
+    BakedMeshHeader header;
+    const MeshVertex *verts;
+    const unsigned int *idx;
+};
+
+std::string bakedMeshPath(const std::string &sourcePath);
+
+// Writes the cache atomically (temp file + rename). `indices` holds the
+// levels back to back, lodIndexCounts[i] indices each.
+bool writeBakedMesh(const std::string &sourcePath,
+                    const std::vector<MeshVertex> &vertices,
+                    const std::vector<unsigned int> &indices,
+                    const std::vector<uint32_t> &lodIndexCounts,
+                    const std::vector<float> &lodErrors);
+
+#endif
@@ -0,0 +1,146 @@
+#include "BakedTexture.h"
+#include "MappedFile.h"
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <sys/stat.h>
+
+namespace {
+
+const char BAKED_MAGIC[4] = { 'B', 'T', 'E', 'X' };
+
+bool statSource(const std::string &path, uint64_t &size, int64_t &mtime) {
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0) return false;
+    size = (uint64_t)st.st_size;
+    mtime = (int64_t)st.st_mtime;
+    return true;
+}
+
+size_t levelBytes(uint32_t format, uint32_t width, uint32_t height) {
+    if (format == TEXTURE_BC1) return bc1LevelSize((int)width, (int)height);
+    return (size_t)width * height * 3;
+}
+
+bool parse(const MappedFile &file, BakedTextureHeader &header, DecodedImage &out) {
+    if (file.size() < sizeof(BakedTextureHeader)) return false;
+    memcpy(&header, file.data(), sizeof(header));
+
+    bool valid = memcmp(header.magic, BAKED_MAGIC, 4) == 0 &&
+                 header.version == BAKED_TEXTURE_VERSION &&
+                 header.headerSize == sizeof(BakedTextureHeader) &&
+                 (header.format == TEXTURE_BGR8 || header.format == TEXTURE_BC1) &&
+                 header.levelCount > 0 && header.levelCount <= 32 &&
+                 sizeof(header) + (uint64_t)header.levelCount * sizeof(BakedTextureLevel) <= file.size();
+    if (!valid) return false;
+
+    const BakedTextureLevel *table = (const BakedTextureLevel *)(file.data() + sizeof(header));
+    out.format = (int)header.format;
+    out.levels.resize(header.levelCount);
+    for (uint32_t i = 0; i < header.levelCount; i++) {
+        const BakedTextureLevel &l = table[i];
+        if (l.width == 0 || l.height == 0 ||
+            l.size != levelBytes(header.format, l.width, l.height) ||
+            l.offset + l.size > file.size()) {
+            out.levels.clear();
+            return false;
+        }
+        out.levels[i].width = (int)l.width;
+        out.levels[i].height = (int)l.height;
+        out.levels[i].pixels.assign(file.data() + l.offset, file.data() + l.offset + l.size);
+    }
+    return true;
+}
+
+}
+
+std::string bakedTexturePath(const std::string &sourcePath) {
+    return sourcePath + ".btex";
+}
+
+bool isBakedTextureFile(const std::string &path) {
+    char magic[4];
+    FILE *f = fopen(path.c_str(), "rb");
+    if (!f) return false;
+    bool ok = fread(magic, 1, 4, f) == 4 && memcmp(magic, BAKED_MAGIC, 4) == 0;
+    fclose(f);
+    return ok;
+}
+
+bool readBakedTextureFile(const std::string &path, DecodedImage &out) {
+    MappedFile file;
+    BakedTextureHeader header;
+    if (!file.open(path) || !parse(file, header, out)) {
+        std::cout << "ERROR: Invalid texture container: " << path << "\n";
+        return false;
+    }
+    return true;
+}
+
+bool readBakedTexture(const std::string &sourcePath, DecodedImage &out) {
+    MappedFile file;
+    if (!file.open(bakedTexturePath(sourcePath))) return false;
+
+    BakedTextureHeader header;
+    if (!parse(file, header, out)) return false;
+
+    // A missing source means the container shipped on its own; trust it.
+    uint64_t size;
+    int64_t mtime;
+    if (statSource(sourcePath, size, mtime) &&
+        (size != header.sourceSize || mtime != header.sourceMtime)) {
+        std::cout << "  (stale " << bakedTexturePath(sourcePath) << ", decoding source)\n";
+        out.levels.clear();
+        return false;
+    }
+    return true;
+}
+
+bool writeBakedTexture(const std::string &sourcePath, const DecodedImage &image) {
+    if (image.levels.empty()) return false;
+
+    BakedTextureHeader h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, BAKED_MAGIC, 4);
+    h.version = BAKED_TEXTURE_VERSION;
+    h.headerSize = sizeof(BakedTextureHeader);
+    h.format = (uint32_t)image.format;
+    h.width = (uint32_t)image.levels[0].width;
+    h.height = (uint32_t)image.levels[0].height;
+    h.levelCount = (uint32_t)image.levels.size();
+    if (!statSource(sourcePath, h.sourceSize, h.sourceMtime)) return false;
+
+    std::vector<BakedTextureLevel> table(image.levels.size());
+    uint64_t offset = sizeof(h) + table.size() * sizeof(BakedTextureLevel);
+    for (size_t i = 0; i < table.size(); i++) {
+        offset = (offset + 15) & ~(uint64_t)15;
+        table[i].width = (uint32_t)image.levels[i].width;
+        table[i].height = (uint32_t)image.levels[i].height;
+        table[i].offset = offset;
+        table[i].size = image.levels[i].pixels.size();
+        offset += table[i].size;
+    }
+
+    std::string finalPath = bakedTexturePath(sourcePath);
+    std::string tmpPath = finalPath + ".tmp";
+    FILE *f = fopen(tmpPath.c_str(), "wb");
+    if (!f) return false;
+
+    static const char zeros[16] = { 0 };
+    bool ok = fwrite(&h, sizeof(h), 1, f) == 1 &&
+              fwrite(&table[0], sizeof(BakedTextureLevel), table.size(), f) == table.size();
+    uint64_t written = sizeof(h) + table.size() * sizeof(BakedTextureLevel);
+    for (size_t i = 0; ok && i < table.size(); i++) {
+        size_t pad = (size_t)(table[i].offset - written);
+        ok = fwrite(zeros, 1, pad, f) == pad &&
+             fwrite(&image.levels[i].pixels[0], 1, (size_t)table[i].size, f) == table[i].size;
+        written = table[i].offset + table[i].size;
+    }
+    ok = (fclose(f) == 0) && ok;
+
+    if (!ok || rename(tmpPath.c_str(), finalPath.c_str()) != 0) {
+        remove(tmpPath.c_str());
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,50 @@
+#ifndef BAKEDTEXTURE_H
+#define BAKEDTEXTURE_H
+
+#include <string>
+#include <stdint.h>
+#include "TextureImage.h"
+
+// Pre-mipmapped texture container written by the texconv tool next to the
+// source image ("<file>.bmp.btex"). Layout (native byte order):
+//   BakedTextureHeader
+//   BakedTextureLevel[levelCount]
+//   level data                     each at its offset (16-byte aligned)
+// Levels are stored in the header's TextureFormat, largest first. As with
+// baked meshes, the header stamps the source's size and mtime; a stale
+// container is ignored.
+const uint32_t BAKED_TEXTURE_VERSION = 1;
+
+struct BakedTextureHeader {
+    char     magic[4];          // "BTEX"
+    uint32_t version;
+    uint32_t headerSize;
+    uint32_t format;            // TextureFormat
+    uint32_t width;
+    uint32_t height;
+    uint32_t levelCount;
+    uint32_t reserved;
+    uint64_t sourceSize;
+    int64_t  sourceMtime;
+};
+
+struct BakedTextureLevel {
+    uint32_t width;
+    uint32_t height;
+    uint64_t offset;
+    uint64_t size;
+};
+
+std::string bakedTexturePath(const std::string &sourcePath);
+
+// Loads the container for sourcePath if it exists and is up to date.
+bool readBakedTexture(const std::string &sourcePath, DecodedImage &out);
+
+// Loads a container file directly, without a source stamp check.
+bool isBakedTextureFile(const std::string &path);
+bool readBakedTextureFile(const std::string &path, DecodedImage &out);
+
+// Writes "<sourcePath>.btex" atomically (temp file + rename).
+bool writeBakedTexture(const std::string &sourcePath, const DecodedImage &image);
+
+#endif
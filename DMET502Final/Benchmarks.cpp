@@ -0,0 +1,493 @@
+#include "Benchmarks.h"
+#include "ObjParser.h"
+#include "SpatialGrid.h"
+#include "GameWorld.h"
+#include "OverlapKernels.h"
+#include "LightClusters.h"
+#include "Frustum.h"
+#include "JobSystem.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+namespace {
+
+double secondsSince(std::chrono::steady_clock::time_point start) {
+    std::chrono::duration<double> d = std::chrono::steady_clock::now() - start;
+    return d.count();
+}
+
+// =======================================================
+// OBJ PARSER
+// =======================================================
+
+// Writes a (side+1)^2 vertex grid with v/vt/vn data and `faceCount` triangles.
+bool writeGridObj(const char *path, int faceCount, long &bytes) {
+    FILE *f = fopen(path, "w");
+    if (!f) return false;
+
+    int side = (int)std::ceil(std::sqrt(faceCount / 2.0));
+    if (side < 1) side = 1;
+    int row = side + 1;
+
+    for (int z = 0; z <= side; z++) {
+        for (int x = 0; x <= side; x++) {
+            float h = 0.25f * std::sin(x * 0.31f) * std::cos(z * 0.27f);
+            fprintf(f, "v %.6f %.6f %.6f\n", x * 0.1f, h, z * 0.1f);
+        }
+    }
+    for (int z = 0; z <= side; z++)
+        for (int x = 0; x <= side; x++)
+            fprintf(f, "vt %.6f %.6f\n", float(x) / side, float(z) / side);
+    for (int z = 0; z <= side; z++)
+        for (int x = 0; x <= side; x++)
+            fprintf(f, "vn 0.000000 1.000000 0.000000\n");
+
+    int written = 0;
+    for (int z = 0; z < side && written < faceCount; z++) {
+        for (int x = 0; x < side && written < faceCount; x++) {
+            int a = z * row + x + 1, b = a + 1, c = a + row, d = c + 1;
+            fprintf(f, "f %d/%d/%d %d/%d/%d %d/%d/%d\n", a, a, a, c, c, c, b, b, b);
+            if (++written < faceCount)
+                fprintf(f, "f %d/%d/%d %d/%d/%d %d/%d/%d\n", b, b, b, c, c, c, d, d, d);
+            written++;
+        }
+    }
+
+    bytes = ftell(f);
+    fclose(f);
+    return true;
+}
+
+// The stream-based loop ObjModel::load used before ObjParser.
+struct LegacyFace { std::vector<int> vIdx, tIdx, nIdx; };
+
+size_t legacyParse(const std::string &path, size_t &vertexCount) {
+    struct V { float x, y, z; };
+    struct T { float u, v; };
+    std::vector<V> vertices;
+    std::vector<T> texcoords;
+    std::vector<V> normals;
+    std::vector<LegacyFace> faces;
+
+    std::ifstream file(path);
+    std::string line;
+    while (std::getline(file, line)) {
+        std::stringstream ss(line);
+        std::string type;
+        ss >> type;
+
+        if (type == "v") { V v; ss >> v.x >> v.y >> v.z; vertices.push_back(v); }
+        else if (type == "vt") { T t; ss >> t.u >> t.v; texcoords.push_back(t); }
+        else if (type == "vn") { V n; ss >> n.x >> n.y >> n.z; normals.push_back(n); }
+        else if (type == "f") {
+            LegacyFace face;
+            std::string vertData;
+            while (ss >> vertData) {
+                int v = 0, t = 0, n = 0;
+                char c;
+                std::stringstream vs(vertData);
+                if (vertData.find("//") != std::string::npos) vs >> v >> c >> c >> n;
+                else if (vertData.find("/") != std::string::npos) {
+                    if (vertData.find("/") != vertData.rfind("/")) vs >> v >> c >> t >> c >> n;
+                    else vs >> v >> c >> t;
+                }
+                else vs >> v;
+
+                face.vIdx.push_back(v - 1);
+                face.tIdx.push_back(t > 0 ? t - 1 : -1);
+                face.nIdx.push_back(n > 0 ? n - 1 : -1);
+            }
+            faces.push_back(face);
+        }
+    }
+
+    vertexCount = vertices.size();
+    return faces.size();
+}
+
+void report(const char *name, double seconds, long bytes, size_t faces) {
+    double mb = bytes / (1024.0 * 1024.0);
+    std::cout << "  " << name << " : " << seconds * 1000.0 << " ms, "
+              << (seconds > 0 ? mb / seconds : 0.0) << " MB/s, "
+              << (seconds > 0 ? faces / seconds : 0.0) << " faces/s\n";
+}
+
+// =======================================================
+// SPATIAL GRID
+// =======================================================
+const float GRID_ARENA_HALF = 36.0f;   // WORLD_HALF
+const float GRID_CELL_SIZE  = 2.5f;
+const float QUERY_RADIUS    = 0.5f;    // playerRadius
+
+struct GridEntity { float x, z, radius; };
+
+// Counts overlaps the way handlePlayerCollisions() used to: every entity, every tick.
+int bruteForceHits(const std::vector<GridEntity> &entities, float x, float z) {
+    int hits = 0;
+    for (size_t i = 0; i < entities.size(); i++) {
+        float dx = x - entities[i].x, dz = z - entities[i].z;
+        if (std::sqrt(dx * dx + dz * dz) < QUERY_RADIUS + entities[i].radius) hits++;
+    }
+    return hits;
+}
+
+int gridHits(const SpatialGrid &grid, const std::vector<GridEntity> &entities,
+             float maxRadius, float x, float z, std::vector<int> &scratch) {
+    scratch.clear();
+    grid.query(x, z, QUERY_RADIUS + maxRadius, scratch);
+    int hits = 0;
+    for (size_t i = 0; i < scratch.size(); i++) {
+        const GridEntity &e = entities[scratch[i]];
+        float dx = x - e.x, dz = z - e.z, minD = QUERY_RADIUS + e.radius;
+        if (dx * dx + dz * dz < minD * minD) hits++;
+    }
+    return hits;
+}
+
+
+// =======================================================
+// ENTITY LAYOUT
+// =======================================================
+
+// The array-of-structs layout obstacles used before the ECS.
+struct LegacyVec3 { float x, y, z; };
+struct LegacyObstacle { LegacyVec3 pos, vel; float radius, mass; std::string type; bool grounded; };
+
+int legacyPass(std::vector<LegacyObstacle> &obstacles, float px, float pz, float pr, float dt) {
+    for (size_t i = 0; i < obstacles.size(); i++) {
+        LegacyObstacle &o = obstacles[i];
+        if (o.type == "icicle" && !o.grounded) {
+            o.vel.y += -4.2f * dt;
+            o.pos.y += o.vel.y * dt;
+            if (o.pos.y <= 0.35f) { o.pos.y = 0.35f; o.vel.y = 0.0f; o.grounded = true; }
+        }
+    }
+    int hits = 0;
+    for (size_t i = 0; i < obstacles.size(); i++) {
+        float dx = px - obstacles[i].pos.x, dz = pz - obstacles[i].pos.z;
+        if (std::sqrt(dx * dx + dz * dz) < pr + obstacles[i].radius) hits++;
+    }
+    return hits;
+}
+
+int ecsPass(World &world, float px, float pz, float pr, float dt, std::vector<int> &scratch) {
+    world.each(OBSTACLE_ARCHETYPE, [&](ChunkView &v) { icicleFallChunk(v, dt); });
+    scratch.resize(ECS_CHUNK_CAPACITY);
+    int hits = 0;
+    world.each(OBSTACLE_ARCHETYPE, [&](ChunkView &v) {
+        hits += (int)findOverlaps(v.f(COMP_POSITION, POS_X), v.f(COMP_POSITION, POS_Z), v.f(COMP_RADIUS),
+                                  v.count, px, pz, pr, (int)v.firstRow, scratch.data());
+    });
+    return hits;
+}
+
+void spawnBenchmarkObstacles(World &world, const std::vector<LegacyObstacle> &legacy) {
+    registerGameComponents(world);
+    for (size_t i = 0; i < legacy.size(); i++) {
+        const LegacyObstacle &o = legacy[i];
+        spawnObstacle(world, o.pos.x, o.pos.y, o.pos.z, o.radius,
+                      o.type == "icicle" ? OBSTACLE_ICICLE : OBSTACLE_STONE, o.grounded);
+    }
+}
+
+// =======================================================
+// LIGHT CLUSTERS
+// =======================================================
+
+// gluPerspective(fovY, aspect, zNear, zFar), column-major.
+void perspective(float fovY, float aspect, float zNear, float zFar, float m[16]) {
+    float f = 1.0f / std::tan(fovY * 3.14159265f / 360.0f);
+    for (int i = 0; i < 16; i++) m[i] = 0.0f;
+    m[0] = f / aspect;
+    m[5] = f;
+    m[10] = (zFar + zNear) / (zNear - zFar);
+    m[11] = -1.0f;
+    m[14] = 2.0f * zFar * zNear / (zNear - zFar);
+}
+
+bool sameClusters(const LightClusters &a, const LightClusters &b) {
+    return a.offsets() == b.offsets() && a.counts() == b.counts() && a.indices() == b.indices();
+}
+}
+
+int runObjParserBenchmark(int faceCount) {
+    if (faceCount <= 0) faceCount = 1000000;
+
+    char path[] = "/tmp/objbenchXXXXXX";
+    int fd = mkstemp(path);
+    if (fd < 0) {
+        std::cout << "ERROR: Cannot create temporary OBJ file\n";
+        return 1;
+    }
+    close(fd);
+
+    long bytes = 0;
+    if (!writeGridObj(path, faceCount, bytes)) {
+        std::cout << "ERROR: Cannot write " << path << "\n";
+        unlink(path);
+        return 1;
+    }
+
+    std::cout << "OBJ parser benchmark: " << faceCount << " faces, "
+              << bytes / (1024.0 * 1024.0) << " MB\n";
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    size_t legacyVerts = 0;
+    size_t legacyFaces = legacyParse(path, legacyVerts);
+    double legacySeconds = secondsSince(start);
+
+    start = std::chrono::steady_clock::now();
+    ObjData data;
+    parseObjFile(path, data);
+    double fastSeconds = secondsSince(start);
+
+    unlink(path);
+
+    report("stringstream", legacySeconds, bytes, legacyFaces);
+    report("ObjParser   ", fastSeconds, bytes, data.faceCount());
+    std::cout << "  speedup : " << (fastSeconds > 0 ? legacySeconds / fastSeconds : 0.0) << "x\n";
+
+    if (legacyFaces != data.faceCount() || legacyVerts != data.vertexCount()) {
+        std::cout << "ERROR: parsers disagree (" << legacyFaces << " vs "
+                  << data.faceCount() << " faces)\n";
+        return 1;
+    }
+    return 0;
+}
+
+int runSpatialGridBenchmark(int maxEntities) {
+    if (maxEntities <= 0) maxEntities = 100000;
+    const int queries = 20000;
+
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> pos(-GRID_ARENA_HALF + 1.0f, GRID_ARENA_HALF - 1.0f);
+    std::uniform_real_distribution<float> rad(0.5f, 1.1f);
+
+    std::vector<float> qx(queries), qz(queries);
+    for (int i = 0; i < queries; i++) { qx[i] = pos(rng); qz[i] = pos(rng); }
+
+    // The arena stays fixed, so grid cost tracks local density (candidates
+    // per query) while brute force tracks the total count.
+    std::cout << "Spatial grid benchmark: " << queries << " player queries per entity count\n";
+    bool ok = true;
+
+    for (int n = 100; n <= maxEntities; n *= 10) {
+        std::vector<GridEntity> entities(n);
+        SpatialGrid grid;
+        grid.reset(GRID_ARENA_HALF, GRID_CELL_SIZE);
+        float maxRadius = 0.0f;
+        for (int i = 0; i < n; i++) {
+            entities[i].x = pos(rng);
+            entities[i].z = pos(rng);
+            entities[i].radius = rad(rng);
+            maxRadius = std::max(maxRadius, entities[i].radius);
+            grid.insert(i, entities[i].x, entities[i].z);
+        }
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        long bruteTotal = 0;
+        for (int q = 0; q < queries; q++) bruteTotal += bruteForceHits(entities, qx[q], qz[q]);
+        double bruteSeconds = secondsSince(start);
+
+        std::vector<int> scratch;
+        start = std::chrono::steady_clock::now();
+        long gridTotal = 0, candidates = 0;
+        for (int q = 0; q < queries; q++) {
+            gridTotal += gridHits(grid, entities, maxRadius, qx[q], qz[q], scratch);
+            candidates += (long)scratch.size();
+        }
+        double gridSeconds = secondsSince(start);
+
+        std::cout << "  " << n << " entities : brute force " << bruteSeconds * 1e9 / queries
+                  << " ns/query, grid " << gridSeconds * 1e9 / queries << " ns/query ("
+                  << (gridSeconds > 0 ? bruteSeconds / gridSeconds : 0.0) << "x, "
+                  << double(candidates) / queries << " candidates/query)\n";
+
+        if (bruteTotal != gridTotal) {
+            std::cout << "ERROR: grid found " << gridTotal << " overlaps, brute force "
+                      << bruteTotal << "\n";
+            ok = false;
+        }
+    }
+    return ok ? 0 : 1;
+}
+
+int runEntityLayoutBenchmark(int entityCount) {
+    if (entityCount <= 0) entityCount = 100000;
+    const int passes = 200;
+    const float dt = 1.0f / 120.0f, pr = 0.5f;
+
+    std::mt19937 rng(99);
+    std::uniform_real_distribution<float> pos(-35.0f, 35.0f);
+    std::uniform_real_distribution<float> height(12.5f, 15.5f);
+
+    std::vector<LegacyObstacle> legacy(entityCount);
+    for (int i = 0; i < entityCount; i++) {
+        bool icicle = (i & 1) != 0;
+        LegacyObstacle &o = legacy[i];
+        o.pos.x = pos(rng); o.pos.z = pos(rng);
+        o.pos.y = icicle ? height(rng) : 1.0f;
+        o.vel.x = o.vel.y = o.vel.z = 0.0f;
+        o.radius = icicle ? 0.5f : 1.1f;
+        o.mass = icicle ? 0.8f : 9999.0f;
+        o.type = icicle ? "icicle" : "stone";
+        o.grounded = !icicle;
+    }
+    std::vector<float> qx(passes), qz(passes);
+    for (int p = 0; p < passes; p++) { qx[p] = pos(rng); qz[p] = pos(rng); }
+    std::vector<LegacyObstacle> initial = legacy;
+
+    std::cout << "Entity layout benchmark: " << entityCount << " obstacles (half icicles), "
+              << passes << " integrate + overlap passes\n";
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    long legacyHits = 0;
+    for (int p = 0; p < passes; p++) legacyHits += legacyPass(legacy, qx[p], qz[p], pr, dt);
+    double legacySeconds = secondsSince(start);
+    double processed = double(entityCount) * passes;
+    std::cout << "  AoS + string + sqrt : " << processed / (legacySeconds * 1e9) << " entities/ns\n";
+
+    bool ok = true;
+    SimdLevel original = activeSimdLevel();
+    std::vector<int> scratch;
+    for (int level = SIMD_SCALAR; level <= bestSimdLevel(); level++) {
+        World world;
+        spawnBenchmarkObstacles(world, initial);
+        setSimdLevel((SimdLevel)level);
+
+        start = std::chrono::steady_clock::now();
+        long hits = 0;
+        for (int p = 0; p < passes; p++) hits += ecsPass(world, qx[p], qz[p], pr, dt, scratch);
+        double seconds = secondsSince(start);
+
+        std::cout << "  ECS chunks " << simdLevelName((SimdLevel)level) << " : "
+                  << processed / (seconds * 1e9) << " entities/ns ("
+                  << (seconds > 0 ? legacySeconds / seconds : 0.0) << "x)\n";
+        if (hits != legacyHits) {
+            std::cout << "ERROR: " << hits << " overlaps, legacy found " << legacyHits << "\n";
+            ok = false;
+        }
+    }
+    setSimdLevel(original);
+    return ok ? 0 : 1;
+}
+
+int runLightClusterBenchmark(int maxLights) {
+    if (maxLights <= 0) maxLights = 4096;
+    const int width = 1280, height = 800;
+
+    float projection[16];
+    perspective(60.0f, float(width) / height, 0.1f, 300.0f, projection);
+
+    // Crystal-like lights over the arena, seen from one end at head height
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> across(-GRID_ARENA_HALF, GRID_ARENA_HALF);
+    std::uniform_real_distribution<float> up(0.5f, 6.0f);
+    std::uniform_real_distribution<float> reach(3.0f, 12.0f);
+
+    std::cout << "Light cluster benchmark: " << width << "x" << height << ", "
+              << LightClusters::TILE_SIZE << " px tiles x " << LightClusters::DEPTH_SLICES
+              << " slices, " << jobs.threadCount() << " job threads\n";
+    bool ok = true;
+
+    std::vector<int> sweep;
+    for (int n = 6; n < maxLights; n = n < 16 ? 16 : n * 4) sweep.push_back(n);
+    sweep.push_back(maxLights);
+    for (size_t s = 0; s < sweep.size(); s++) {
+        int n = sweep[s];
+        std::vector<float> x(n), y(n), z(n), r(n);
+        for (int i = 0; i < n; i++) {
+            x[i] = across(rng);
+            y[i] = up(rng) - 2.0f;                      // eye at y = 2
+            z[i] = across(rng) - GRID_ARENA_HALF;       // eye at the +z wall, looking down -z
+            r[i] = reach(rng);
+        }
+
+        int repeats = std::max(5, 20000 / n);
+        LightClusters serial, parallel;
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (int k = 0; k < repeats; k++)
+            serial.build(projection, width, height, x.data(), y.data(), z.data(), r.data(), n, 0, false);
+        double serialMs = secondsSince(start) * 1000.0 / repeats;
+
+        start = std::chrono::steady_clock::now();
+        for (int k = 0; k < repeats; k++)
+            parallel.build(projection, width, height, x.data(), y.data(), z.data(), r.data(), n, 0, true);
+        double parallelMs = secondsSince(start) * 1000.0 / repeats;
+
+        size_t lit = 0;
+        for (size_t c = 0; c < serial.counts().size(); c++) lit += serial.counts()[c] > 0;
+        std::cout << "  " << n << " lights : " << serialMs << " ms serial, " << parallelMs
+                  << " ms parallel, " << serial.indices().size() << " entries, "
+                  << (lit ? double(serial.indices().size()) / lit : 0.0) << " avg / "
+                  << serial.maxClusterLights() << " max per lit cluster\n";
+
+        if (!sameClusters(serial, parallel)) {
+            std::cout << "ERROR: parallel binning differs from serial at " << n << " lights\n";
+            ok = false;
+        }
+    }
+    return ok ? 0 : 1;
+}
+
+int runFrustumCullBenchmark(int sphereCount) {
+    if (sphereCount <= 0) sphereCount = 100000;
+    const int passes = std::max(10, 20000000 / sphereCount);
+
+    // The game's camera at the +z wall, looking down -z across the arena
+    float projection[16], modelview[16];
+    perspective(60.0f, 1280.0f / 800.0f, 0.1f, 300.0f, projection);
+    for (int i = 0; i < 16; i++) modelview[i] = (i % 5 == 0) ? 1.0f : 0.0f;
+    modelview[13] = -2.0f;
+    modelview[14] = -GRID_ARENA_HALF;
+    Frustum frustum;
+    frustum.extract(projection, modelview);
+
+    std::mt19937 rng(11);
+    std::uniform_real_distribution<float> across(-GRID_ARENA_HALF, GRID_ARENA_HALF);
+    std::uniform_real_distribution<float> up(0.0f, 15.0f);
+    std::uniform_real_distribution<float> size(0.3f, 1.5f);
+    std::vector<float> x(sphereCount), y(sphereCount), z(sphereCount), r(sphereCount);
+    for (int i = 0; i < sphereCount; i++) {
+        x[i] = across(rng);
+        y[i] = up(rng);
+        z[i] = across(rng);
+        r[i] = size(rng);
+    }
+
+    std::cout << "Frustum cull benchmark: " << sphereCount << " spheres, " << passes << " passes\n";
+    bool ok = true;
+    SimdLevel original = activeSimdLevel();
+    std::vector<int> visible(sphereCount), reference;
+    for (int level = SIMD_SCALAR; level <= bestSimdLevel(); level++) {
+        setSimdLevel((SimdLevel)level);
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        size_t kept = 0;
+        for (int p = 0; p < passes; p++)
+            kept = cullSpheres(frustum, x.data(), y.data(), z.data(), r.data(), sphereCount, visible.data());
+        double seconds = secondsSince(start);
+
+        std::cout << "  " << simdLevelName((SimdLevel)level) << " : "
+                  << seconds * 1e9 / (double(sphereCount) * passes) << " ns per sphere, "
+                  << kept << " visible\n";
+        visible.resize(kept);
+        if (level == SIMD_SCALAR) reference = visible;
+        else if (visible != reference) {
+            std::cout << "ERROR: " << simdLevelName((SimdLevel)level) << " result differs from scalar\n";
+            ok = false;
+        }
+        visible.resize(sphereCount);
+    }
+    setSimdLevel(original);
+    return ok ? 0 : 1;
+}
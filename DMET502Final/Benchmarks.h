@@ -0,0 +1,27 @@
+#ifndef BENCHMARKS_H
+#define BENCHMARKS_H
+
+// Command-line micro-benchmarks (run from main() before any window is
+// created). Each returns a process exit code.
+
+// --bench-obj [faces]: parses a generated triangle mesh with the old
+// stringstream loader and the memory-mapped ObjParser.
+int runObjParserBenchmark(int faceCount);
+
+// --bench-grid [entities]: per-query cost of player-vs-entity overlap
+// tests, brute force against SpatialGrid, for growing entity counts.
+int runSpatialGridBenchmark(int maxEntities);
+
+// --bench-soa [entities]: the old Obstacle structs (string type, sqrt
+// distance) against ECS chunk columns with each overlap kernel.
+int runEntityLayoutBenchmark(int entityCount);
+
+// --bench-lights [max]: clustered light binning (LightClusters) for 6 up
+// to `max` lights, serial and on the job system.
+int runLightClusterBenchmark(int maxLights);
+
+// --bench-cull [spheres]: sphere-vs-frustum culling with each SIMD level,
+// checked against the scalar result.
+int runFrustumCullBenchmark(int sphereCount);
+
+#endif
@@ -0,0 +1,169 @@
+#include "Ecs.h"
+#include <cstring>
+#include <new>
+
+namespace {
+
+// Starts the lifetime of a column's float or uint32_t objects, all zero.
+void constructColumn(void *storage, FieldType type) {
+    for (size_t i = 0; i < ECS_CHUNK_CAPACITY; i++) {
+        if (type == FIELD_FLOAT) new (static_cast<float *>(storage) + i) float(0.0f);
+        else new (static_cast<uint32_t *>(storage) + i) uint32_t(0);
+    }
+}
+
+}
+
+World::World() {
+    for (int i = 0; i < ECS_MAX_COMPONENTS; i++) {
+        fieldCounts[i] = 0;
+        fieldTypes[i] = FIELD_FLOAT;
+    }
+}
+
+void World::registerComponent(int component, int fieldCount, FieldType type) {
+    fieldCounts[component] = fieldCount;
+    fieldTypes[component] = type;
+}
+
+Archetype *World::archetype(ComponentMask mask) {
+    for (size_t i = 0; i < archetypes.size(); i++)
+        if (archetypes[i]->mask == mask) return archetypes[i].get();
+    return nullptr;
+}
+
+Archetype &World::findOrCreate(ComponentMask mask) {
+    Archetype *existing = archetype(mask);
+    if (existing) return *existing;
+
+    std::unique_ptr<Archetype> a(new Archetype());
+    a->mask = mask;
+    a->totalFields = 0;
+    a->rows = 0;
+    for (int c = 0; c < ECS_MAX_COMPONENTS; c++) {
+        if (mask & componentBit(c)) {
+            a->fieldBase[c] = a->totalFields;
+            a->totalFields += fieldCounts[c];
+            a->columnTypes.insert(a->columnTypes.end(), fieldCounts[c], fieldTypes[c]);
+        } else {
+            a->fieldBase[c] = -1;
+        }
+    }
+    archetypes.push_back(std::move(a));
+    return *archetypes.back();
+}
+
+Entity World::create(ComponentMask mask) {
+    Archetype &a = findOrCreate(mask);
+
+    size_t slot;
+    if (a.rows == a.chunks.size() * ECS_CHUNK_CAPACITY) {
+        std::unique_ptr<Chunk> chunk(new Chunk());
+        chunk->columns.resize((size_t)a.totalFields * ECS_COLUMN_BYTES);
+        for (int col = 0; col < a.totalFields; col++)
+            constructColumn(&chunk->columns[(size_t)col * ECS_COLUMN_BYTES], a.columnTypes[col]);
+        a.chunks.push_back(std::move(chunk));
+    }
+    size_t row = a.rows++;
+    Chunk &chunk = chunkOf(a, row, slot);
+    chunk.count++;
+
+    Entity e;
+    if (!freeSlots.empty()) {
+        e.index = freeSlots.back();
+        freeSlots.pop_back();
+    } else {
+        e.index = (uint32_t)locations.size();
+        Location l = { 0, nullptr, 0 };
+        locations.push_back(l);
+    }
+    Location &loc = locations[e.index];
+    loc.generation = loc.generation + 1 ? loc.generation + 1 : 1;
+    loc.archetype = &a;
+    loc.row = row;
+    e.generation = loc.generation;
+
+    chunk.entities[slot] = e;
+    for (int col = 0; col < a.totalFields; col++) {
+        void *column = &chunk.columns[(size_t)col * ECS_COLUMN_BYTES];
+        if (a.columnTypes[col] == FIELD_FLOAT) static_cast<float *>(column)[slot] = 0.0f;
+        else static_cast<uint32_t *>(column)[slot] = 0;
+    }
+    return e;
+}
+
+bool World::alive(Entity e) const {
+    return e.valid() && e.index < locations.size() &&
+           locations[e.index].generation == e.generation && locations[e.index].archetype;
+}
+
+void World::destroy(Entity e) {
+    if (!alive(e)) return;
+    Location &loc = locations[e.index];
+    Archetype &a = *loc.archetype;
+
+    size_t holeSlot, lastSlot;
+    Chunk &hole = chunkOf(a, loc.row, holeSlot);
+    size_t lastRow = a.rows - 1;
+    Chunk &last = chunkOf(a, lastRow, lastSlot);
+
+    if (lastRow != loc.row) {
+        for (int col = 0; col < a.totalFields; col++)
+            std::memcpy(&hole.columns[(size_t)col * ECS_COLUMN_BYTES + holeSlot * 4],
+                        &last.columns[(size_t)col * ECS_COLUMN_BYTES + lastSlot * 4], 4);
+        Entity moved = last.entities[lastSlot];
+        hole.entities[holeSlot] = moved;
+        locations[moved.index].row = loc.row;
+    }
+
+    last.count--;
+    a.rows--;
+    if (last.count == 0) a.chunks.pop_back();
+
+    loc.archetype = nullptr;
+    freeSlots.push_back(e.index);
+}
+
+void World::clear() {
+    // Archetypes survive (callers may hold pointers to them); chunks go.
+    for (size_t a = 0; a < archetypes.size(); a++) {
+        archetypes[a]->chunks.clear();
+        archetypes[a]->rows = 0;
+    }
+    // Keep generations so stale handles stay invalid
+    freeSlots.clear();
+    for (size_t i = 0; i < locations.size(); i++) {
+        locations[i].archetype = nullptr;
+        freeSlots.push_back((uint32_t)(locations.size() - 1 - i));
+    }
+}
+
+float *World::f(Entity e, int component, int field) {
+    if (!alive(e)) return nullptr;
+    Location &loc = locations[e.index];
+    if (loc.archetype->fieldBase[component] < 0) return nullptr;
+    size_t slot;
+    Chunk &chunk = chunkOf(*loc.archetype, loc.row, slot);
+    return loc.archetype->f(chunk, component, field) + slot;
+}
+
+uint32_t *World::u(Entity e, int component, int field) {
+    if (!alive(e)) return nullptr;
+    Location &loc = locations[e.index];
+    if (loc.archetype->fieldBase[component] < 0) return nullptr;
+    size_t slot;
+    Chunk &chunk = chunkOf(*loc.archetype, loc.row, slot);
+    return loc.archetype->u(chunk, component, field) + slot;
+}
+
+void World::chunks(ComponentMask required, std::vector<ChunkView> &out) {
+    out.clear();
+    each(required, [&](ChunkView &v) { out.push_back(v); });
+}
+
+size_t World::count(ComponentMask required) const {
+    size_t n = 0;
+    for (size_t a = 0; a < archetypes.size(); a++)
+        if ((archetypes[a]->mask & required) == required) n += archetypes[a]->rows;
+    return n;
+}
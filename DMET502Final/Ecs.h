@@ -0,0 +1,154 @@
+#ifndef ECS_H
+#define ECS_H
+
+#include <vector>
+#include <memory>
+#include <stdint.h>
+#include <cstddef>
+
+// Minimal archetype ECS.
+//
+// A component is a fixed number of 32-bit fields (float or uint32). Every
+// distinct component set is an archetype whose entities live in fixed-size
+// chunks, and inside a chunk each field of each component is its own dense
+// column, so systems stream exactly the data they use. Removing an entity
+// moves the archetype's last row into the hole; rows of entities that are
+// never destroyed therefore stay put, which lets SpatialGrid index them.
+
+const int ECS_MAX_COMPONENTS = 32;
+const size_t ECS_CHUNK_CAPACITY = 512;
+
+typedef uint32_t ComponentMask;
+
+inline ComponentMask componentBit(int component) { return (ComponentMask)1 << component; }
+
+// Stable handle: the generation changes when the slot is reused.
+struct Entity {
+    uint32_t index;
+    uint32_t generation;
+
+    Entity() : index(0), generation(0) {}
+    bool valid() const { return generation != 0; }
+};
+
+class World;
+
+// Every field is 4 bytes, either a float or a uint32_t; all fields of a
+// component share one type.
+enum FieldType { FIELD_FLOAT, FIELD_UINT };
+const size_t ECS_COLUMN_BYTES = ECS_CHUNK_CAPACITY * 4;
+
+// Columns live in one byte buffer per chunk. When a chunk is created each
+// column has float or uint32_t objects constructed in it, per its
+// component's FieldType, and Archetype::f()/u() hand out pointers to
+// those objects. Rows move with memcpy between columns of the same type.
+struct Chunk {
+    std::vector<unsigned char> columns;     // totalFields * ECS_COLUMN_BYTES
+    Entity entities[ECS_CHUNK_CAPACITY];
+    size_t count;
+
+    Chunk() : count(0) {}
+};
+
+struct Archetype {
+    ComponentMask mask;
+    int fieldBase[ECS_MAX_COMPONENTS];  // first column of each component, -1 if absent
+    int totalFields;
+    std::vector<FieldType> columnTypes;     // per column
+    std::vector<std::unique_ptr<Chunk> > chunks;
+    size_t rows;
+
+    void *column(Chunk &chunk, int component, int field) const {
+        return &chunk.columns[(size_t)(fieldBase[component] + field) * ECS_COLUMN_BYTES];
+    }
+    float *f(Chunk &chunk, int component, int field = 0) const {
+        return static_cast<float *>(column(chunk, component, field));
+    }
+    uint32_t *u(Chunk &chunk, int component, int field = 0) const {
+        return static_cast<uint32_t *>(column(chunk, component, field));
+    }
+};
+
+// One chunk's worth of a query: `count` rows starting at archetype row
+// `firstRow`.
+struct ChunkView {
+    const Archetype *archetype;
+    Chunk *chunk;
+    size_t count;
+    size_t firstRow;
+
+    float *f(int component, int field = 0) const {
+        return archetype->f(*chunk, component, field);
+    }
+    uint32_t *u(int component, int field = 0) const {
+        return archetype->u(*chunk, component, field);
+    }
+    Entity entity(size_t i) const { return chunk->entities[i]; }
+};
+
+class World {
+public:
+    World();
+
+    // Field counts must be registered before entities use the component;
+    // f() is for FIELD_FLOAT components, u() for FIELD_UINT ones.
+    void registerComponent(int component, int fieldCount, FieldType type = FIELD_FLOAT);
+
+    Entity create(ComponentMask mask);
+    void destroy(Entity e);
+    bool alive(Entity e) const;
+    void clear();
+
+    float *f(Entity e, int component, int field = 0);
+    uint32_t *u(Entity e, int component, int field = 0);
+
+    // Archetype with exactly this component set (nullptr if none exists yet).
+    Archetype *archetype(ComponentMask mask);
+
+    // Resolves a dense archetype row to its chunk and slot.
+    static Chunk &chunkOf(const Archetype &a, size_t row, size_t &slot) {
+        slot = row % ECS_CHUNK_CAPACITY;
+        return *a.chunks[row / ECS_CHUNK_CAPACITY];
+    }
+
+    // Calls fn(ChunkView&) for every non-empty chunk whose archetype has
+    // all of `required`.
+    template <typename Fn>
+    void each(ComponentMask required, Fn fn) {
+        for (size_t a = 0; a < archetypes.size(); a++) {
+            Archetype &arch = *archetypes[a];
+            if ((arch.mask & required) != required) continue;
+            for (size_t c = 0; c < arch.chunks.size(); c++) {
+                Chunk &chunk = *arch.chunks[c];
+                if (chunk.count == 0) continue;
+                ChunkView view = { &arch, &chunk, chunk.count, c * ECS_CHUNK_CAPACITY };
+                fn(view);
+            }
+        }
+    }
+
+    // The chunks each() would visit, for splitting a query across threads.
+    void chunks(ComponentMask required, std::vector<ChunkView> &out);
+
+    size_t count(ComponentMask required) const;
+
+private:
+    struct Location {
+        uint32_t generation;
+        Archetype *archetype;
+        size_t row;
+    };
+
+    World(const World &);
+    World &operator=(const World &);
+
+    Archetype &findOrCreate(ComponentMask mask);
+
+    int fieldCounts[ECS_MAX_COMPONENTS];
+    FieldType fieldTypes[ECS_MAX_COMPONENTS];
+    std::vector<std::unique_ptr<Archetype> > archetypes;
+    std::vector<Location> locations;
+    std::vector<uint32_t> freeSlots;
+};
+
+#endif
@@ -0,0 +1,93 @@
+#include "FramePacing.h"
+#include "GLPlatform.h"
+#include <thread>
+#include <cstring>
+
+#ifdef __APPLE__
+#include <OpenGL/OpenGL.h>
+#else
+#include <GL/glx.h>
+#endif
+
+// =======================================================
+// SWAP INTERVAL
+// =======================================================
+#ifdef __APPLE__
+
+bool setSwapInterval(int interval) {
+    CGLContextObj context = CGLGetCurrentContext();
+    if (!context) return false;
+    GLint value = interval;
+    return CGLSetParameter(context, kCGLCPSwapInterval, &value) == kCGLNoError;
+}
+
+#else
+
+namespace {
+
+typedef void (*SwapIntervalEXT)(Display *, GLXDrawable, int);
+typedef int (*SwapIntervalInt)(int);
+
+void *glxProc(const char *name) {
+    return (void *)glXGetProcAddressARB((const GLubyte *)name);
+}
+
+// Whole-word match in a space-separated extension list.
+bool hasExtension(const char *list, const char *name) {
+    if (!list) return false;
+    size_t n = strlen(name);
+    for (const char *p = strstr(list, name); p; p = strstr(p + n, name))
+        if ((p == list || p[-1] == ' ') && (p[n] == ' ' || p[n] == '\0')) return true;
+    return false;
+}
+
+}
+
+bool setSwapInterval(int interval) {
+    // Three extensions do the same job; drivers ship different subsets
+    Display *display = glXGetCurrentDisplay();
+    GLXDrawable drawable = glXGetCurrentDrawable();
+    if (!display || !drawable) return false;
+
+    // glvnd hands out a stub for any glX* name, so a non-null entry point
+    // proves nothing; only the extension string does
+    const char *extensions = glXQueryExtensionsString(display, DefaultScreen(display));
+
+    if (hasExtension(extensions, "GLX_EXT_swap_control")) {
+        SwapIntervalEXT ext = (SwapIntervalEXT)glxProc("glXSwapIntervalEXT");
+        if (ext) {
+            ext(display, drawable, interval);
+            return true;
+        }
+    }
+    if (hasExtension(extensions, "GLX_MESA_swap_control")) {
+        SwapIntervalInt mesa = (SwapIntervalInt)glxProc("glXSwapIntervalMESA");
+        if (mesa) return mesa(interval) == 0;
+    }
+    // SGI rejects 0, so it can only turn vsync on
+    if (hasExtension(extensions, "GLX_SGI_swap_control") && interval > 0) {
+        SwapIntervalInt sgi = (SwapIntervalInt)glxProc("glXSwapIntervalSGI");
+        if (sgi) return sgi(interval) == 0;
+    }
+    return false;
+}
+
+#endif
+
+// =======================================================
+// FRAME LIMITER
+// =======================================================
+void FrameLimiter::setRate(double framesPerSecond) {
+    fps = framesPerSecond > 0 ? framesPerSecond : 0;
+    if (fps > 0)
+        period = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / fps));
+    next = Clock::now();
+}
+
+void FrameLimiter::wait() {
+    if (fps <= 0) return;
+    next += period;
+    Clock::time_point now = Clock::now();
+    if (next < now) next = now;
+    std::this_thread::sleep_until(next);
+}
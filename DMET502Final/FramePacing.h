@@ -0,0 +1,31 @@
+#ifndef FRAMEPACING_H
+#define FRAMEPACING_H
+
+#include <chrono>
+
+// Asks the driver to sync buffer swaps of the current GL context to the
+// display: 1 = vsync, 0 = swap immediately. Returns false when the
+// platform exposes no swap-interval control (the driver default stays).
+bool setSwapInterval(int interval);
+
+// Caps the redraw rate. wait() sleeps until the next frame is due; after
+// a slow frame the schedule restarts instead of rushing to catch up.
+class FrameLimiter {
+public:
+    FrameLimiter() : fps(0) {}
+
+    // 0 = unlimited.
+    void setRate(double framesPerSecond);
+    double rate() const { return fps; }
+
+    void wait();
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    double fps;
+    Clock::duration period;
+    Clock::time_point next;
+};
+
+#endif
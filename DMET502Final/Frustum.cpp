@@ -0,0 +1,115 @@
+#include "Frustum.h"
+#include "OverlapKernels.h"
+#include <cmath>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define FRUSTUM_X86 1
+#include <immintrin.h>
+#endif
+
+void Frustum::extract(const float projection[16], const float modelview[16]) {
+    // clip = projection * modelview, column-major
+    float m[16];
+    for (int col = 0; col < 4; col++)
+        for (int row = 0; row < 4; row++) {
+            float sum = 0.0f;
+            for (int k = 0; k < 4; k++) sum += projection[k * 4 + row] * modelview[col * 4 + k];
+            m[col * 4 + row] = sum;
+        }
+
+    // -w <= x, y, z <= w: left, right, bottom, top, near, far
+    for (int i = 0; i < 6; i++) {
+        int row = i / 2;
+        float sign = (i & 1) ? -1.0f : 1.0f;
+        float pa = m[3] + sign * m[row];
+        float pb = m[7] + sign * m[4 + row];
+        float pc = m[11] + sign * m[8 + row];
+        float pd = m[15] + sign * m[12 + row];
+        float len = std::sqrt(pa * pa + pb * pb + pc * pc);
+        float inv = len > 0.0f ? 1.0f / len : 0.0f;
+        a[i] = pa * inv;
+        b[i] = pb * inv;
+        c[i] = pc * inv;
+        d[i] = pd * inv;
+    }
+}
+
+bool Frustum::sphereVisible(float x, float y, float z, float radius) const {
+    for (int i = 0; i < 6; i++)
+        if (a[i] * x + b[i] * y + c[i] * z + d[i] < -radius) return false;
+    return true;
+}
+
+namespace {
+
+size_t cullScalar(const Frustum &f, const float *x, const float *y, const float *z,
+                  const float *r, size_t count, int base, int *out) {
+    size_t n = 0;
+    for (size_t i = 0; i < count; i++)
+        if (f.sphereVisible(x[i], y[i], z[i], r[i])) out[n++] = base + (int)i;
+    return n;
+}
+
+#ifdef FRUSTUM_X86
+// Four spheres per step, all six planes; a lane stays set while the
+// sphere is on the inside of every plane so far. Same operation order
+// as sphereVisible(), so the paths agree bit for bit.
+size_t cullSSE2(const Frustum &f, const float *x, const float *y, const float *z,
+                const float *r, size_t count, int base, int *out) {
+    size_t n = 0, i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128 X = _mm_loadu_ps(x + i), Y = _mm_loadu_ps(y + i), Z = _mm_loadu_ps(z + i);
+        __m128 negR = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(r + i));
+        __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for (int p = 0; p < 6; p++) {
+            __m128 dist = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(f.a[p]), X), _mm_mul_ps(_mm_set1_ps(f.b[p]), Y));
+            dist = _mm_add_ps(_mm_add_ps(dist, _mm_mul_ps(_mm_set1_ps(f.c[p]), Z)), _mm_set1_ps(f.d[p]));
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(dist, negR));
+        }
+        int mask = _mm_movemask_ps(inside);
+        while (mask) {
+            out[n++] = base + (int)i + __builtin_ctz(mask);
+            mask &= mask - 1;
+        }
+    }
+    return n + cullScalar(f, x + i, y + i, z + i, r + i, count - i, base + (int)i, out + n);
+}
+
+__attribute__((target("avx2")))
+size_t cullAVX2(const Frustum &f, const float *x, const float *y, const float *z,
+                const float *r, size_t count, int base, int *out) {
+    size_t n = 0, i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256 X = _mm256_loadu_ps(x + i), Y = _mm256_loadu_ps(y + i), Z = _mm256_loadu_ps(z + i);
+        __m256 negR = _mm256_sub_ps(_mm256_setzero_ps(), _mm256_loadu_ps(r + i));
+        __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+        for (int p = 0; p < 6; p++) {
+            __m256 dist = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(f.a[p]), X),
+                                        _mm256_mul_ps(_mm256_set1_ps(f.b[p]), Y));
+            dist = _mm256_add_ps(_mm256_add_ps(dist, _mm256_mul_ps(_mm256_set1_ps(f.c[p]), Z)),
+                                 _mm256_set1_ps(f.d[p]));
+            inside = _mm256_and_ps(inside, _mm256_cmp_ps(dist, negR, _CMP_GE_OQ));
+        }
+        int mask = _mm256_movemask_ps(inside);
+        while (mask) {
+            out[n++] = base + (int)i + __builtin_ctz(mask);
+            mask &= mask - 1;
+        }
+    }
+    return n + cullSSE2(f, x + i, y + i, z + i, r + i, count - i, base + (int)i, out + n);
+}
+#endif
+
+}
+
+size_t cullSpheres(const Frustum &frustum, const float *x, const float *y, const float *z,
+                   const float *radius, size_t count, int *out) {
+#ifdef FRUSTUM_X86
+    switch (activeSimdLevel()) {
+    case SIMD_AVX2: return cullAVX2(frustum, x, y, z, radius, count, 0, out);
+    case SIMD_SSE2: return cullSSE2(frustum, x, y, z, radius, count, 0, out);
+    default: break;
+    }
+#endif
+    return cullScalar(frustum, x, y, z, radius, count, 0, out);
+}
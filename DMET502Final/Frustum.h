@@ -0,0 +1,26 @@
+#ifndef FRUSTUM_H
+#define FRUSTUM_H
+
+#include <cstddef>
+
+// The six clip planes of a camera in world space. Each plane is
+// (a, b, c, d) with a unit normal pointing inside, so a*x + b*y + c*z + d
+// is the signed distance of a point from it.
+struct Frustum {
+    float a[6], b[6], c[6], d[6];
+
+    // From column-major GL matrices (as read back with glGetFloatv).
+    void extract(const float projection[16], const float modelview[16]);
+
+    // Conservative: a sphere near a corner may pass without touching.
+    bool sphereVisible(float x, float y, float z, float radius) const;
+};
+
+// Tests spheres [0, count) from structure-of-arrays columns and writes
+// the index of each one that touches the frustum to out (room for
+// `count` entries). Returns the number written, in ascending order.
+// Uses the SIMD level of OverlapKernels; every path gives the same result.
+size_t cullSpheres(const Frustum &frustum, const float *x, const float *y, const float *z,
+                   const float *radius, size_t count, int *out);
+
+#endif
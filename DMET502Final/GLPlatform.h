@@ -0,0 +1,19 @@
+#ifndef GLPLATFORM_H
+#define GLPLATFORM_H
+
+// macOS ships GLUT as a framework; everywhere else (Linux build
+// machines, Mesa) it lives under GL/, and buffer-object entry points
+// need GL_GLEXT_PROTOTYPES to be declared. The renderbench target
+// (OFFSCREEN_GLUT) swaps GLUT for an EGL-backed stand-in.
+#ifdef __APPLE__
+#include <GLUT/glut.h>
+#else
+#define GL_GLEXT_PROTOTYPES
+#ifdef OFFSCREEN_GLUT
+#include "Tools/OffscreenGlut.h"
+#else
+#include <GL/glut.h>
+#endif
+#endif
+
+#endif
@@ -0,0 +1,258 @@
+#include "GLStateCache.h"
+#include <cstring>
+#include <sstream>
+
+GLStateCache glState;
+
+namespace {
+
+const char *kindNames[GLStateCache::KIND_COUNT] = {
+    "enables", "textures", "materials", "colors", "blending", "fog"
+};
+
+const int FRONT = 1, BACK = 2;
+
+int faceBits(GLenum face) {
+    if (face == GL_FRONT) return FRONT;
+    if (face == GL_BACK) return BACK;
+    return FRONT | BACK;
+}
+
+// Bit per material slot: ambient, diffuse, specular, emission, shininess.
+int materialBits(GLenum pname) {
+    switch (pname) {
+    case GL_AMBIENT: return 1;
+    case GL_DIFFUSE: return 2;
+    case GL_AMBIENT_AND_DIFFUSE: return 3;
+    case GL_SPECULAR: return 4;
+    case GL_EMISSION: return 8;
+    case GL_SHININESS: return 16;
+    default: return 0;
+    }
+}
+
+}
+
+GLStateCache::GLStateCache() {
+    beginFrame();
+}
+
+void GLStateCache::invalidate() {
+    for (int i = 0; i < CAP_COUNT; i++) caps[i] = -1;
+    textureKnown = false;
+    memset(materialKnown, 0, sizeof(materialKnown));
+    colorMaterialKnown = false;
+    colorKnown = false;
+    blendKnown = false;
+    fogDensityKnown = fogModeKnown = fogColorKnown = false;
+}
+
+void GLStateCache::beginFrame() {
+    invalidate();
+    memset(stats, 0, sizeof(stats));
+}
+
+void GLStateCache::count(Kind k, bool issued) {
+    if (issued) stats[k].issued++;
+    else stats[k].skipped++;
+}
+
+int GLStateCache::capIndex(GLenum cap) {
+    switch (cap) {
+    case GL_TEXTURE_2D: return 0;
+    case GL_LIGHTING: return 1;
+    case GL_COLOR_MATERIAL: return 2;
+    case GL_FOG: return 3;
+    case GL_BLEND: return 4;
+    case GL_DEPTH_TEST: return 5;
+    case GL_NORMALIZE: return 6;
+    default:
+        if (cap >= GL_LIGHT0 && cap <= GL_LIGHT7) return 7 + (int)(cap - GL_LIGHT0);
+        return -1;
+    }
+}
+
+// =======================================================
+// ENABLES + TEXTURE
+// =======================================================
+void GLStateCache::set(GLenum cap, bool on) {
+    int i = capIndex(cap);
+    if (i >= 0 && caps[i] == (on ? 1 : 0)) {
+        count(ENABLES, false);
+        return;
+    }
+    if (on) glEnable(cap);
+    else glDisable(cap);
+    count(ENABLES, true);
+    if (i >= 0) caps[i] = on ? 1 : 0;
+    if (cap == GL_COLOR_MATERIAL && on) colorMaterialTouched();
+}
+
+void GLStateCache::bindTexture2D(GLuint name) {
+    if (textureKnown && texture == name) {
+        count(TEXTURES, false);
+        return;
+    }
+    glBindTexture(GL_TEXTURE_2D, name);
+    count(TEXTURES, true);
+    textureKnown = true;
+    texture = name;
+}
+
+// =======================================================
+// MATERIALS + COLOUR
+// While GL_COLOR_MATERIAL is on, every glColor rewrites the material
+// slots it tracks, and a glMaterial on those slots lasts only until the
+// next glColor; both directions invalidate the other side.
+// =======================================================
+void GLStateCache::colorMaterialTouched() {
+    if (caps[capIndex(GL_COLOR_MATERIAL)] == 0) return;
+    int faces = colorMaterialKnown ? faceBits(colorMaterialFace) : FRONT | BACK;
+    int params = colorMaterialKnown ? materialBits(colorMaterialMode) : 31;
+    for (int f = 0; f < 2; f++) {
+        if (!(faces & (1 << f))) continue;
+        for (int p = 0; p < MATERIAL_PARAMS; p++)
+            if (params & (1 << p)) materialKnown[f][p] = false;
+    }
+}
+
+void GLStateCache::material(GLenum face, GLenum pname, const GLfloat *values) {
+    int faces = faceBits(face);
+    int params = materialBits(pname);
+    int n = pname == GL_SHININESS ? 1 : 4;
+
+    bool same = params != 0;
+    for (int f = 0; f < 2 && same; f++) {
+        if (!(faces & (1 << f))) continue;
+        for (int p = 0; p < MATERIAL_PARAMS && same; p++)
+            if ((params & (1 << p)) &&
+                (!materialKnown[f][p] || memcmp(materials[f][p], values, n * sizeof(GLfloat)) != 0))
+                same = false;
+    }
+    if (same) {
+        count(MATERIALS, false);
+        return;
+    }
+
+    glMaterialfv(face, pname, values);
+    count(MATERIALS, true);
+    for (int f = 0; f < 2; f++) {
+        if (!(faces & (1 << f))) continue;
+        for (int p = 0; p < MATERIAL_PARAMS; p++) {
+            if (!(params & (1 << p))) continue;
+            materialKnown[f][p] = true;
+            memcpy(materials[f][p], values, n * sizeof(GLfloat));
+        }
+    }
+
+    // The next glColor must reach GL again to restore a tracked slot
+    if (caps[capIndex(GL_COLOR_MATERIAL)] != 0 &&
+        (!colorMaterialKnown ||
+         ((faceBits(colorMaterialFace) & faces) && (materialBits(colorMaterialMode) & params))))
+        colorKnown = false;
+}
+
+void GLStateCache::colorMaterial(GLenum face, GLenum mode) {
+    if (colorMaterialKnown && colorMaterialFace == face && colorMaterialMode == mode) {
+        count(MATERIALS, false);
+        return;
+    }
+    glColorMaterial(face, mode);
+    count(MATERIALS, true);
+    colorMaterialKnown = true;
+    colorMaterialFace = face;
+    colorMaterialMode = mode;
+    colorMaterialTouched();
+}
+
+void GLStateCache::color(GLfloat r, GLfloat g, GLfloat b, GLfloat a) {
+    if (colorKnown && currentColor[0] == r && currentColor[1] == g &&
+        currentColor[2] == b && currentColor[3] == a) {
+        count(COLORS, false);
+        return;
+    }
+    glColor4f(r, g, b, a);
+    count(COLORS, true);
+    colorKnown = true;
+    currentColor[0] = r;
+    currentColor[1] = g;
+    currentColor[2] = b;
+    currentColor[3] = a;
+    colorMaterialTouched();
+}
+
+void GLStateCache::colorArrayDrawn() {
+    colorKnown = false;
+    colorMaterialTouched();
+}
+
+// =======================================================
+// BLENDING + FOG
+// =======================================================
+void GLStateCache::blendFunc(GLenum src, GLenum dst) {
+    if (blendKnown && blendSrc == src && blendDst == dst) {
+        count(BLENDING, false);
+        return;
+    }
+    glBlendFunc(src, dst);
+    count(BLENDING, true);
+    blendKnown = true;
+    blendSrc = src;
+    blendDst = dst;
+}
+
+void GLStateCache::fogDensity(GLfloat density) {
+    if (fogDensityKnown && fogDensityValue == density) {
+        count(FOG, false);
+        return;
+    }
+    glFogf(GL_FOG_DENSITY, density);
+    count(FOG, true);
+    fogDensityKnown = true;
+    fogDensityValue = density;
+}
+
+void GLStateCache::fogMode(GLint mode) {
+    if (fogModeKnown && fogModeValue == mode) {
+        count(FOG, false);
+        return;
+    }
+    glFogi(GL_FOG_MODE, mode);
+    count(FOG, true);
+    fogModeKnown = true;
+    fogModeValue = mode;
+}
+
+void GLStateCache::fogColor(const GLfloat rgba[4]) {
+    if (fogColorKnown && memcmp(fogColorValue, rgba, sizeof(fogColorValue)) == 0) {
+        count(FOG, false);
+        return;
+    }
+    glFogfv(GL_FOG_COLOR, rgba);
+    count(FOG, true);
+    fogColorKnown = true;
+    memcpy(fogColorValue, rgba, sizeof(fogColorValue));
+}
+
+// =======================================================
+// COUNTERS
+// =======================================================
+GLStateCache::Counters GLStateCache::total() const {
+    Counters t = { 0, 0 };
+    for (int k = 0; k < KIND_COUNT; k++) {
+        t.issued += stats[k].issued;
+        t.skipped += stats[k].skipped;
+    }
+    return t;
+}
+
+std::string GLStateCache::frameSummary() const {
+    Counters t = total();
+    std::ostringstream out;
+    out << "GL state: " << t.issued << " issued, " << t.skipped << " skipped (";
+    for (int k = 0; k < KIND_COUNT; k++)
+        out << (k ? ", " : "") << kindNames[k] << " " << stats[k].skipped << "/"
+            << stats[k].issued + stats[k].skipped;
+    out << ")";
+    return out.str();
+}
@@ -0,0 +1,92 @@
+#ifndef GLSTATECACHE_H
+#define GLSTATECACHE_H
+
+#include <string>
+#include "GLPlatform.h"
+
+// Shadows the fixed-function state the renderer changes per draw (common
+// enables, the bound 2D texture, material colours, current colour,
+// colour-material mode, blend function and fog) and drops calls that
+// would leave it unchanged. GL thread only.
+//
+// State the cache did not set is "unknown" and the next call goes to GL.
+// Anything that changes tracked state behind the cache's back must be
+// followed by invalidate(); renderScene() calls beginFrame() once the
+// frame's texture uploads are done, so nothing leaks between frames.
+class GLStateCache {
+public:
+    enum Kind { ENABLES, TEXTURES, MATERIALS, COLORS, BLENDING, FOG, KIND_COUNT };
+
+    struct Counters {
+        unsigned long issued;
+        unsigned long skipped;
+    };
+
+    GLStateCache();
+
+    void invalidate();
+    // Invalidates and zeroes the counters.
+    void beginFrame();
+
+    void enable(GLenum cap) { set(cap, true); }
+    void disable(GLenum cap) { set(cap, false); }
+    void set(GLenum cap, bool on);
+
+    void bindTexture2D(GLuint texture);
+
+    // GL_AMBIENT, GL_DIFFUSE, GL_AMBIENT_AND_DIFFUSE, GL_SPECULAR,
+    // GL_EMISSION (4 values) or GL_SHININESS (1 value).
+    void material(GLenum face, GLenum pname, const GLfloat *values);
+    void colorMaterial(GLenum face, GLenum mode);
+
+    void color(GLfloat r, GLfloat g, GLfloat b, GLfloat a = 1.0f);
+    // A draw with a colour array leaves the current colour undefined
+    // (and, through colour material, the tracked material too).
+    void colorArrayDrawn();
+
+    void blendFunc(GLenum src, GLenum dst);
+
+    void fogDensity(GLfloat density);
+    void fogMode(GLint mode);
+    void fogColor(const GLfloat rgba[4]);
+
+    const Counters &counters(Kind k) const { return stats[k]; }
+    Counters total() const;
+    // One line: issued / skipped per kind since beginFrame().
+    std::string frameSummary() const;
+
+private:
+    enum { CAP_COUNT = 15, MATERIAL_PARAMS = 5 };
+
+    static int capIndex(GLenum cap);
+    void count(Kind k, bool issued);
+    // Forgets the material colours colour material can overwrite.
+    void colorMaterialTouched();
+
+    Counters stats[KIND_COUNT];
+
+    signed char caps[CAP_COUNT];        // -1 unknown, 0 off, 1 on
+    bool textureKnown;
+    GLuint texture;
+
+    // [front/back][ambient, diffuse, specular, emission, shininess]
+    bool materialKnown[2][MATERIAL_PARAMS];
+    GLfloat materials[2][MATERIAL_PARAMS][4];
+    bool colorMaterialKnown;
+    GLenum colorMaterialFace, colorMaterialMode;
+
+    bool colorKnown;
+    GLfloat currentColor[4];
+
+    bool blendKnown;
+    GLenum blendSrc, blendDst;
+
+    bool fogDensityKnown, fogModeKnown, fogColorKnown;
+    GLfloat fogDensityValue;
+    GLint fogModeValue;
+    GLfloat fogColorValue[4];
+};
+
+extern GLStateCache glState;
+
+#endif
@@ -0,0 +1,147 @@
+#include "GameWorld.h"
+#include "OverlapKernels.h"
+#include <cmath>
+
+void registerGameComponents(World &world) {
+    world.registerComponent(COMP_POSITION, 3);
+    world.registerComponent(COMP_VELOCITY, 1);
+    world.registerComponent(COMP_RADIUS, 1);
+    world.registerComponent(COMP_OBSTACLE, 2, FIELD_UINT);
+    world.registerComponent(COMP_COLLECTIBLE, 1, FIELD_UINT);
+    world.registerComponent(COMP_BOB, 3);
+    world.registerComponent(COMP_PULSE, 2);
+    world.registerComponent(COMP_FOLLOW, 2);
+    world.registerComponent(COMP_PORTAL, 0);
+}
+
+namespace {
+
+void setPosition(World &world, Entity e, float x, float y, float z) {
+    *world.f(e, COMP_POSITION, POS_X) = x;
+    *world.f(e, COMP_POSITION, POS_Y) = y;
+    *world.f(e, COMP_POSITION, POS_Z) = z;
+}
+
+}
+
+Entity spawnObstacle(World &world, float x, float y, float z, float radius,
+                     ObstacleKind kind, bool grounded) {
+    Entity e = world.create(OBSTACLE_ARCHETYPE);
+    setPosition(world, e, x, y, z);
+    *world.f(e, COMP_RADIUS) = radius;
+    *world.u(e, COMP_OBSTACLE, OBSTACLE_KIND) = (uint32_t)kind;
+    *world.u(e, COMP_OBSTACLE, OBSTACLE_FLAGS) = grounded ? ENTITY_GROUNDED : 0;
+    return e;
+}
+
+Entity spawnCollectible(World &world, float x, float y, float z, float radius, float bobPhase) {
+    Entity e = world.create(COLLECTIBLE_ARCHETYPE);
+    setPosition(world, e, x, y, z);
+    *world.f(e, COMP_RADIUS) = radius;
+    *world.f(e, COMP_BOB, BOB_PHASE) = bobPhase;
+    return e;
+}
+
+Entity spawnCrystal(World &world, float x, float y, float z, float glowPhase) {
+    Entity e = world.create(CRYSTAL_ARCHETYPE);
+    setPosition(world, e, x, y, z);
+    *world.f(e, COMP_PULSE, PULSE_PHASE) = glowPhase;
+    return e;
+}
+
+Entity spawnFireSpirit(World &world, float side, float height) {
+    Entity e = world.create(FIRE_SPIRIT_ARCHETYPE);
+    *world.f(e, COMP_FOLLOW, FOLLOW_SIDE) = side;
+    *world.f(e, COMP_FOLLOW, FOLLOW_HEIGHT) = height;
+    return e;
+}
+
+Entity spawnPortal(World &world, float x, float y, float z, float radius) {
+    Entity e = world.create(PORTAL_ARCHETYPE);
+    setPosition(world, e, x, y, z);
+    *world.f(e, COMP_RADIUS) = radius;
+    return e;
+}
+
+void icicleFallChunk(const ChunkView &v, float dt) {
+    float *y = v.f(COMP_POSITION, POS_Y);
+    float *vy = v.f(COMP_VELOCITY);
+    const uint32_t *kind = v.u(COMP_OBSTACLE, OBSTACLE_KIND);
+    uint32_t *flags = v.u(COMP_OBSTACLE, OBSTACLE_FLAGS);
+
+    for (size_t i = 0; i < v.count; i++) {
+        if (kind[i] != OBSTACLE_ICICLE || (flags[i] & ENTITY_GROUNDED)) continue;
+        vy[i] += -4.2f * dt;
+        y[i] += vy[i] * dt;
+        if (y[i] <= 0.35f) {
+            y[i] = 0.35f;
+            vy[i] = 0.0f;
+            flags[i] |= ENTITY_GROUNDED;
+        }
+    }
+}
+
+void collectibleBobChunk(const ChunkView &v, float time) {
+    const float *phase = v.f(COMP_BOB, BOB_PHASE);
+    float *offset = v.f(COMP_BOB, BOB_OFFSET);
+    float *spin = v.f(COMP_BOB, BOB_SPIN);
+    for (size_t i = 0; i < v.count; i++) {
+        offset[i] = std::sin(time * 2 + phase[i]) * 0.25f;
+        spin[i] = time * 60 + phase[i] * 20;
+    }
+}
+
+void crystalPulseChunk(const ChunkView &v, float time) {
+    const float *phase = v.f(COMP_PULSE, PULSE_PHASE);
+    float *wave = v.f(COMP_PULSE, PULSE_WAVE);
+    for (size_t i = 0; i < v.count; i++) wave[i] = std::sin(time * 2.0f + phase[i]);
+}
+
+void followSystem(World &world, float px, float py, float pz, float yaw, float time) {
+    // Right vector relative to player direction
+    float rx = std::cos(yaw), rz = std::sin(yaw);
+    float hover = std::sin(time * 3.0f) * 0.2f;
+
+    ComponentMask required = componentBit(COMP_POSITION) | componentBit(COMP_FOLLOW);
+    world.each(required, [&](ChunkView &v) {
+        float *x = v.f(COMP_POSITION, POS_X);
+        float *y = v.f(COMP_POSITION, POS_Y);
+        float *z = v.f(COMP_POSITION, POS_Z);
+        const float *side = v.f(COMP_FOLLOW, FOLLOW_SIDE);
+        const float *height = v.f(COMP_FOLLOW, FOLLOW_HEIGHT);
+        for (size_t i = 0; i < v.count; i++) {
+            x[i] = px + rx * side[i];
+            z[i] = pz + rz * side[i];
+            y[i] = py + height[i] + hover;
+        }
+    });
+}
+
+size_t findOverlappingRows(const Archetype &archetype, const std::vector<int> &rows,
+                           float px, float pz, float pr, std::vector<int> &out) {
+    out.resize(rows.size());
+    size_t n = rows.empty() ? 0 : findOverlappingRows(archetype, rows.data(), rows.size(),
+                                                       px, pz, pr, out.data());
+    out.resize(n);
+    return n;
+}
+
+size_t findOverlappingRows(const Archetype &archetype, const int *rows, size_t count,
+                           float px, float pz, float pr, int *out) {
+    size_t n = 0;
+    for (size_t i = 0; i < count;) {
+        size_t slot;
+        Chunk &chunk = World::chunkOf(archetype, (size_t)rows[i], slot);
+        int chunkEnd = rows[i] - (int)slot + (int)ECS_CHUNK_CAPACITY;
+
+        size_t j = i + 1;
+        while (j < count && rows[j] == rows[j - 1] + 1 && rows[j] < chunkEnd) j++;
+
+        const float *x = archetype.f(chunk, COMP_POSITION, POS_X);
+        const float *z = archetype.f(chunk, COMP_POSITION, POS_Z);
+        const float *r = archetype.f(chunk, COMP_RADIUS);
+        n += findOverlaps(x + slot, z + slot, r + slot, j - i, px, pz, pr, rows[i], out + n);
+        i = j;
+    }
+    return n;
+}
@@ -0,0 +1,81 @@
+#ifndef GAMEWORLD_H
+#define GAMEWORLD_H
+
+#include "Ecs.h"
+#include <vector>
+
+// Game components. Each is a fixed set of 32-bit fields (see Ecs.h); the
+// field enums below name them.
+enum GameComponent {
+    COMP_POSITION,      // POS_X, POS_Y, POS_Z
+    COMP_VELOCITY,      // vertical speed
+    COMP_RADIUS,        // XZ collision radius
+    COMP_OBSTACLE,      // OBSTACLE_KIND, OBSTACLE_FLAGS
+    COMP_COLLECTIBLE,   // flags
+    COMP_BOB,           // BOB_PHASE, BOB_OFFSET, BOB_SPIN
+    COMP_PULSE,         // PULSE_PHASE, PULSE_WAVE
+    COMP_FOLLOW,        // FOLLOW_SIDE, FOLLOW_HEIGHT
+    COMP_PORTAL,        // tag
+    COMP_COUNT
+};
+
+enum { POS_X, POS_Y, POS_Z };
+enum { OBSTACLE_KIND, OBSTACLE_FLAGS };
+enum { BOB_PHASE, BOB_OFFSET, BOB_SPIN };
+enum { PULSE_PHASE, PULSE_WAVE };
+enum { FOLLOW_SIDE, FOLLOW_HEIGHT };
+
+enum ObstacleKind {
+    OBSTACLE_STONE  = 0,
+    OBSTACLE_ICICLE = 1
+};
+
+// Bits in the OBSTACLE_FLAGS / COMP_COLLECTIBLE fields.
+const uint32_t ENTITY_GROUNDED  = 1u << 0;
+const uint32_t ENTITY_COLLECTED = 1u << 1;
+
+const ComponentMask OBSTACLE_ARCHETYPE =
+    (1u << COMP_POSITION) | (1u << COMP_VELOCITY) | (1u << COMP_RADIUS) | (1u << COMP_OBSTACLE);
+const ComponentMask COLLECTIBLE_ARCHETYPE =
+    (1u << COMP_POSITION) | (1u << COMP_RADIUS) | (1u << COMP_COLLECTIBLE) | (1u << COMP_BOB);
+const ComponentMask CRYSTAL_ARCHETYPE = (1u << COMP_POSITION) | (1u << COMP_PULSE);
+const ComponentMask FIRE_SPIRIT_ARCHETYPE = (1u << COMP_POSITION) | (1u << COMP_FOLLOW);
+const ComponentMask PORTAL_ARCHETYPE =
+    (1u << COMP_POSITION) | (1u << COMP_RADIUS) | (1u << COMP_PORTAL);
+
+void registerGameComponents(World &world);
+
+// Spawn helpers; all fields not given start at zero.
+Entity spawnObstacle(World &world, float x, float y, float z, float radius,
+                     ObstacleKind kind, bool grounded);
+Entity spawnCollectible(World &world, float x, float y, float z, float radius, float bobPhase);
+Entity spawnCrystal(World &world, float x, float y, float z, float glowPhase);
+Entity spawnFireSpirit(World &world, float side, float height);
+Entity spawnPortal(World &world, float x, float y, float z, float radius);
+
+// ---- systems ----
+// Each system has a per-chunk kernel so callers can spread a query's
+// chunks over the job system; chunks never share rows.
+
+// Falling icicles; grounded ones are skipped. Icicles only move along Y,
+// so their grid cells never change.
+void icicleFallChunk(const ChunkView &v, float dt);
+
+// Writes BOB_OFFSET / BOB_SPIN and PULSE_WAVE for the given time.
+void collectibleBobChunk(const ChunkView &v, float time);
+void crystalPulseChunk(const ChunkView &v, float time);
+
+// Keeps followers beside the player, on its right-hand side.
+void followSystem(World &world, float px, float py, float pz, float yaw, float time);
+
+// Circle-overlap test against an archetype's rows listed in ascending
+// order (e.g. SpatialGrid::query output). Runs of consecutive rows within
+// one chunk go to the SIMD kernel together. Returns the overlapping rows.
+size_t findOverlappingRows(const Archetype &archetype, const std::vector<int> &rows,
+                           float px, float pz, float pr, std::vector<int> &out);
+
+// Same over rows[0, count); out needs room for `count` rows.
+size_t findOverlappingRows(const Archetype &archetype, const int *rows, size_t count,
+                           float px, float pz, float pr, int *out);
+
+#endif
@@ -0,0 +1,137 @@
+#include "GpuMesh.h"
+#include <cstdio>
+#include <cstring>
+#include <cstddef>
+
+DrawStats drawStats = { 0, 0 };
+
+namespace {
+
+unsigned long trianglesIn(GLenum mode, GLsizei indexCount) {
+    if (mode == GL_TRIANGLES) return (unsigned long)indexCount / 3;
+    if (mode == GL_TRIANGLE_STRIP || mode == GL_TRIANGLE_FAN)
+        return indexCount > 2 ? (unsigned long)indexCount - 2 : 0;
+    return 0;
+}
+
+}
+
+GpuMesh::GpuMesh()
+    : vbo(0), ibo(0), displayList(0), indexCount(0), numVertices(0), primitive(GL_TRIANGLES) {}
+
+GpuMesh::~GpuMesh() {
+    release();
+}
+
+bool GpuMesh::buffersSupported() {
+    static int cached = -1;
+    if (cached >= 0) return cached == 1;
+
+    // Buffer objects are core since GL 1.5.
+    const char *version = (const char *)glGetString(GL_VERSION);
+    int major = 0, minor = 0;
+    if (version) sscanf(version, "%d.%d", &major, &minor);
+
+    bool ok = major > 1 || (major == 1 && minor >= 5);
+    if (!ok) {
+        const char *ext = (const char *)glGetString(GL_EXTENSIONS);
+        ok = ext && strstr(ext, "GL_ARB_vertex_buffer_object") != nullptr;
+    }
+    cached = ok ? 1 : 0;
+    return ok;
+}
+
+void GpuMesh::release() {
+    if (vbo) glDeleteBuffers(1, &vbo);
+    if (ibo) glDeleteBuffers(1, &ibo);
+    if (displayList) glDeleteLists(displayList, 1);
+    vbo = ibo = displayList = 0;
+    indexCount = 0;
+    numVertices = 0;
+}
+
+void GpuMesh::bindArrays(const MeshVertex *base) const {
+    const char *p = (const char *)base;
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_NORMAL_ARRAY);
+    glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+    glVertexPointer(3, GL_FLOAT, sizeof(MeshVertex), p + offsetof(MeshVertex, px));
+    glNormalPointer(GL_FLOAT, sizeof(MeshVertex), p + offsetof(MeshVertex, nx));
+    glTexCoordPointer(2, GL_FLOAT, sizeof(MeshVertex), p + offsetof(MeshVertex, u));
+}
+
+void GpuMesh::unbindArrays() const {
+    glDisableClientState(GL_VERTEX_ARRAY);
+    glDisableClientState(GL_NORMAL_ARRAY);
+    glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+}
+
+void GpuMesh::upload(const std::vector<MeshVertex> &verts,
+                     const std::vector<unsigned int> &indices,
+                     GLenum mode) {
+    upload(verts.empty() ? nullptr : &verts[0], verts.size(),
+           indices.empty() ? nullptr : &indices[0], indices.size(), mode);
+}
+
+void GpuMesh::upload(const MeshVertex *verts, size_t vertCount,
+                     const unsigned int *indices, size_t idxCount,
+                     GLenum mode) {
+    release();
+    if (!verts || !indices || vertCount == 0 || idxCount == 0) return;
+
+    primitive = mode;
+    indexCount = (GLsizei)idxCount;
+    numVertices = vertCount;
+
+    if (buffersSupported()) {
+        glGenBuffers(1, &vbo);
+        glBindBuffer(GL_ARRAY_BUFFER, vbo);
+        glBufferData(GL_ARRAY_BUFFER, vertCount * sizeof(MeshVertex), verts, GL_STATIC_DRAW);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+        glGenBuffers(1, &ibo);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, idxCount * sizeof(unsigned int), indices, GL_STATIC_DRAW);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+        return;
+    }
+
+    // Fallback: the driver copies client arrays into the list at compile time.
+    displayList = glGenLists(1);
+    glNewList(displayList, GL_COMPILE);
+    bindArrays(verts);
+    glDrawElements(primitive, indexCount, GL_UNSIGNED_INT, indices);
+    unbindArrays();
+    glEndList();
+}
+
+void GpuMesh::draw() const {
+    if (!displayList && !vbo) return;
+    drawStats.calls++;
+    drawStats.triangles += trianglesIn(primitive, indexCount);
+    if (displayList) {
+        glCallList(displayList);
+        return;
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo);
+    bindArrays(nullptr);
+    glDrawElements(primitive, indexCount, GL_UNSIGNED_INT, nullptr);
+    unbindArrays();
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void appendQuad(std::vector<MeshVertex> &verts, std::vector<unsigned int> &indices,
+                const MeshVertex &a, const MeshVertex &b,
+                const MeshVertex &c, const MeshVertex &d) {
+    unsigned int base = (unsigned int)verts.size();
+    verts.push_back(a);
+    verts.push_back(b);
+    verts.push_back(c);
+    verts.push_back(d);
+
+    indices.push_back(base);     indices.push_back(base + 1); indices.push_back(base + 2);
+    indices.push_back(base);     indices.push_back(base + 2); indices.push_back(base + 3);
+}
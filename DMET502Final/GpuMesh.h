@@ -0,0 +1,63 @@
+#ifndef GPUMESH_H
+#define GPUMESH_H
+
+#include <vector>
+#include "GLPlatform.h"
+
+// Interleaved position / normal / UV vertex used by every retained mesh.
+struct MeshVertex {
+    float px, py, pz;
+    float nx, ny, nz;
+    float u, v;
+};
+
+// Geometry uploaded once and drawn with a single call. Uses vertex buffer
+// objects when the context has them, otherwise compiles a display list.
+class GpuMesh {
+public:
+    GpuMesh();
+    ~GpuMesh();
+
+    void upload(const std::vector<MeshVertex> &verts,
+                const std::vector<unsigned int> &indices,
+                GLenum mode = GL_TRIANGLES);
+    void upload(const MeshVertex *verts, size_t vertCount,
+                const unsigned int *indices, size_t idxCount,
+                GLenum mode = GL_TRIANGLES);
+    void draw() const;
+    void release();
+
+    bool empty() const { return indexCount == 0; }
+    size_t vertexCount() const { return numVertices; }
+
+    static bool buffersSupported();
+
+private:
+    GpuMesh(const GpuMesh &);
+    GpuMesh &operator=(const GpuMesh &);
+
+    void bindArrays(const MeshVertex *base) const;
+    void unbindArrays() const;
+
+    GLuint vbo;
+    GLuint ibo;
+    GLuint displayList;
+    GLsizei indexCount;
+    size_t numVertices;
+    GLenum primitive;
+};
+
+// Draw calls and triangles submitted by GpuMesh and InstanceBatch since
+// the last reset (GL thread only); the render benchmark reads them.
+struct DrawStats {
+    unsigned long calls;
+    unsigned long triangles;
+};
+extern DrawStats drawStats;
+
+// Appends a quad (corners in winding order) as two indexed triangles.
+void appendQuad(std::vector<MeshVertex> &verts, std::vector<unsigned int> &indices,
+                const MeshVertex &a, const MeshVertex &b,
+                const MeshVertex &c, const MeshVertex &d);
+
+#endif
@@ -0,0 +1,160 @@
+#include "InstanceBatch.h"
+#include "GLStateCache.h"
+#include <cmath>
+#include <cstring>
+#include <cstddef>
+
+namespace {
+
+const float DEG2RAD = 3.14159265358979f / 180.0f;
+
+void identity(float m[9]) {
+    static const float I[9] = { 1,0,0, 0,1,0, 0,0,1 };
+    memcpy(m, I, sizeof(I));
+}
+
+// Inverse transpose of a 3x3 (cofactor matrix / determinant).
+void normalMatrix(const float m[9], float out[9]) {
+    float c[9] = {
+        m[4]*m[8] - m[5]*m[7], m[5]*m[6] - m[3]*m[8], m[3]*m[7] - m[4]*m[6],
+        m[2]*m[7] - m[1]*m[8], m[0]*m[8] - m[2]*m[6], m[1]*m[6] - m[0]*m[7],
+        m[1]*m[5] - m[2]*m[4], m[2]*m[3] - m[0]*m[5], m[0]*m[4] - m[1]*m[3]
+    };
+    float det = m[0]*c[0] + m[1]*c[1] + m[2]*c[2];
+    if (std::fabs(det) < 1e-12f) { identity(out); return; }
+    for (int i = 0; i < 9; i++) out[i] = c[i] / det;
+}
+
+}
+
+InstanceBatch::InstanceBatch() : mesh(nullptr), objectLinearUV(false), dirty(true) {
+    identity(base);
+    identity(normalBase);
+    memset(expandedColor, 0, sizeof(expandedColor));
+}
+
+void InstanceBatch::setMesh(const PrimitiveGeometry *m) {
+    if (m != mesh) dirty = true;
+    mesh = m;
+}
+
+void InstanceBatch::setBaseTransform(const float m[9]) {
+    memcpy(base, m, sizeof(base));
+    normalMatrix(base, normalBase);
+    dirty = true;
+}
+
+void InstanceBatch::setObjectLinearUV(bool enabled) {
+    if (enabled != objectLinearUV) dirty = true;
+    objectLinearUV = enabled;
+}
+
+void InstanceBatch::expandInstance(size_t k, const float rgba[4]) {
+    size_t nv = mesh->verts.size();
+    const InstanceData &inst = instances[k];
+    float s = std::sin(inst.yawDegrees * DEG2RAD);
+    float c = std::cos(inst.yawDegrees * DEG2RAD);
+
+    BatchVertex *out = vertices.data() + k * nv;
+    for (size_t i = 0; i < nv; i++, out++) {
+        const MeshVertex &v = mesh->verts[i];
+
+        float lx = base[0]*v.px + base[1]*v.py + base[2]*v.pz;
+        float ly = base[3]*v.px + base[4]*v.py + base[5]*v.pz;
+        float lz = base[6]*v.px + base[7]*v.py + base[8]*v.pz;
+        float mx = normalBase[0]*v.nx + normalBase[1]*v.ny + normalBase[2]*v.nz;
+        float my = normalBase[3]*v.nx + normalBase[4]*v.ny + normalBase[5]*v.nz;
+        float mz = normalBase[6]*v.nx + normalBase[7]*v.ny + normalBase[8]*v.nz;
+        float len = std::sqrt(mx*mx + my*my + mz*mz);
+        if (len > 0) { mx /= len; my /= len; mz /= len; }
+
+        // Rotate about Y (glRotatef(yaw, 0,1,0)), then scale and translate
+        out->px = inst.x + inst.scale * ( c*lx + s*lz);
+        out->py = inst.y + inst.scale * ly;
+        out->pz = inst.z + inst.scale * (-s*lx + c*lz);
+        out->nx =  c*mx + s*mz;
+        out->ny =  my;
+        out->nz = -s*mx + c*mz;
+
+        if (objectLinearUV) { out->u = v.px; out->v = v.py; }
+        else                { out->u = v.u;  out->v = v.v;  }
+    }
+    colorInstance(k, rgba);
+}
+
+void InstanceBatch::colorInstance(size_t k, const float rgba[4]) {
+    size_t nv = mesh->verts.size();
+    float pulse = instances[k].pulse;
+    float r = rgba[0] * pulse, g = rgba[1] * pulse, b = rgba[2] * pulse;
+
+    BatchVertex *out = vertices.data() + k * nv;
+    for (size_t i = 0; i < nv; i++, out++) {
+        out->r = r; out->g = g; out->b = b; out->a = rgba[3];
+    }
+}
+
+void InstanceBatch::expand(const float rgba[4]) {
+    size_t nv = mesh->verts.size();
+    size_t ni = mesh->indices.size();
+    vertices.resize(nv * instances.size());
+    indices.resize(ni * instances.size());
+
+    for (size_t k = 0; k < instances.size(); k++) {
+        expandInstance(k, rgba);
+
+        unsigned int offset = (unsigned int)(k * nv);
+        unsigned int *idx = &indices[k * ni];
+        for (size_t i = 0; i < ni; i++) idx[i] = mesh->indices[i] + offset;
+    }
+
+    expandedInstances = instances;
+    memcpy(expandedColor, rgba, sizeof(expandedColor));
+    dirty = false;
+}
+
+void InstanceBatch::refresh(const float rgba[4]) {
+    for (size_t k = 0; k < instances.size(); k++) {
+        const InstanceData &now = instances[k];
+        InstanceData &was = expandedInstances[k];
+        if (memcmp(&now, &was, offsetof(InstanceData, pulse)) != 0)
+            expandInstance(k, rgba);
+        else if (now.pulse != was.pulse)
+            colorInstance(k, rgba);
+        else
+            continue;
+        was = now;
+    }
+}
+
+void InstanceBatch::draw(const float rgba[4]) {
+    if (!mesh || instances.empty()) return;
+
+    // Grounded icicles, stones and crystals' positions rarely change, so
+    // while the instance count and colour hold only the instances that
+    // moved are expanded again, and a pulse change only rewrites colours.
+    bool reuse = !dirty &&
+                 expandedInstances.size() == instances.size() &&
+                 memcmp(expandedColor, rgba, sizeof(expandedColor)) == 0;
+    if (reuse) refresh(rgba);
+    else expand(rgba);
+
+    const char *p = (const char *)&vertices[0];
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_NORMAL_ARRAY);
+    glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+    glEnableClientState(GL_COLOR_ARRAY);
+    glVertexPointer(3, GL_FLOAT, sizeof(BatchVertex), p + offsetof(BatchVertex, px));
+    glNormalPointer(GL_FLOAT, sizeof(BatchVertex), p + offsetof(BatchVertex, nx));
+    glTexCoordPointer(2, GL_FLOAT, sizeof(BatchVertex), p + offsetof(BatchVertex, u));
+    glColorPointer(4, GL_FLOAT, sizeof(BatchVertex), p + offsetof(BatchVertex, r));
+
+    glDrawElements(GL_TRIANGLES, (GLsizei)indices.size(), GL_UNSIGNED_INT, &indices[0]);
+    drawStats.calls++;
+    drawStats.triangles += indices.size() / 3;
+
+    glDisableClientState(GL_COLOR_ARRAY);
+    glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+    glDisableClientState(GL_NORMAL_ARRAY);
+    glDisableClientState(GL_VERTEX_ARRAY);
+    glState.colorArrayDrawn();
+}
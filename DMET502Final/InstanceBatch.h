@@ -0,0 +1,70 @@
+#ifndef INSTANCEBATCH_H
+#define INSTANCEBATCH_H
+
+#include <vector>
+#include "PrimitiveMeshes.h"
+
+// Per-instance record packed once per frame. Bob and spin are resolved
+// from the entity's phase when the instance is added.
+struct InstanceData {
+    float x, y, z;
+    float yawDegrees;
+    float scale;
+    float pulse;    // multiplies the batch colour
+};
+
+// Draws every instance of one mesh with a single glDrawElements call.
+// The fixed-function pipeline has no per-instance attributes, so the
+// instances are expanded into one streamed vertex array on the CPU; only
+// the instances whose packed record changed are expanded again.
+class InstanceBatch {
+public:
+    InstanceBatch();
+
+    void setMesh(const PrimitiveGeometry *mesh);
+    // 3x3 row-major linear transform applied to the unit mesh first
+    // (e.g. the icicle's -90 degree tilt and cone proportions).
+    void setBaseTransform(const float m[9]);
+    // Emit the mesh's object-space x/y as texture coordinates, matching
+    // GL_OBJECT_LINEAR texgen with the s=(1,0,0) t=(0,1,0) planes.
+    void setObjectLinearUV(bool enabled);
+
+    void clear() { instances.clear(); }
+    void add(const InstanceData &d) { instances.push_back(d); }
+    // Direct access for filling many instances at once (e.g. in parallel).
+    void resize(size_t count) { instances.resize(count); }
+    InstanceData *data() { return instances.data(); }
+    size_t size() const { return instances.size(); }
+
+    // Per-vertex colour is rgba scaled by each instance's pulse (alpha untouched).
+    void draw(const float rgba[4]);
+
+private:
+    struct BatchVertex {
+        float px, py, pz;
+        float nx, ny, nz;
+        float u, v;
+        float r, g, b, a;
+    };
+
+    void expand(const float rgba[4]);
+    // Re-expands only the instances that changed since the last expand().
+    void refresh(const float rgba[4]);
+    void expandInstance(size_t k, const float rgba[4]);
+    void colorInstance(size_t k, const float rgba[4]);
+
+    const PrimitiveGeometry *mesh;
+    float base[9];
+    float normalBase[9];
+    bool objectLinearUV;
+
+    std::vector<InstanceData> instances;
+    std::vector<InstanceData> expandedInstances;
+    float expandedColor[4];
+    bool dirty;
+
+    std::vector<BatchVertex> vertices;
+    std::vector<unsigned int> indices;
+};
+
+#endif
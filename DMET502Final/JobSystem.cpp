@@ -0,0 +1,204 @@
+#include "JobSystem.h"
+#include <algorithm>
+
+JobSystem jobs;
+
+namespace {
+
+// The first OUTSIDE_QUEUES queues belong to threads not started by the
+// job system (GLUT, the sim thread, headless main), handed out on first
+// use; beyond that many such threads, they share.
+const int OUTSIDE_QUEUES = 4;
+std::atomic<int> nextOutside(0);
+
+// Index of the calling thread's queue, -1 until assigned.
+thread_local int workerIndex = -1;
+// Owner of the task this thread is executing, -1 outside any task.
+thread_local int currentOwner = -1;
+
+int queueIndex() {
+    if (workerIndex < 0) workerIndex = nextOutside.fetch_add(1) % OUTSIDE_QUEUES;
+    return workerIndex;
+}
+
+// Tasks submitted while executing a task keep that task's owner, so the
+// outside thread waiting on it can help with nested work.
+int submitter() {
+    return currentOwner >= 0 ? currentOwner : queueIndex();
+}
+
+}
+
+// =======================================================
+// JOB GRAPH
+// =======================================================
+JobId JobGraph::add(const char *name, std::function<void()> fn, std::initializer_list<JobId> deps) {
+    JobId id = (JobId)nodes.size();
+    nodes.push_back(Node());
+    Node &n = nodes.back();
+    n.name = name;
+    n.fn = fn;
+    for (JobId d : deps) {
+        nodes[d].successors.push_back(id);
+        n.dependencies++;
+    }
+    return id;
+}
+
+// =======================================================
+// JOB SYSTEM
+// =======================================================
+JobSystem::JobSystem() : queued(0), stopping(false) {
+    for (int i = 0; i < OUTSIDE_QUEUES; i++) queues.push_back(std::unique_ptr<Queue>(new Queue()));
+}
+
+JobSystem::~JobSystem() {
+    shutdown();
+}
+
+void JobSystem::start(int threads) {
+    if (!workers.empty()) return;
+    if (threads <= 0) {
+        int hw = (int)std::thread::hardware_concurrency();
+        threads = hw > 0 ? hw : 1;
+    }
+    stopping = false;
+    // Every queue exists before any worker can look at the vector
+    while ((int)queues.size() < OUTSIDE_QUEUES + threads - 1)
+        queues.push_back(std::unique_ptr<Queue>(new Queue()));
+    for (int i = OUTSIDE_QUEUES; i < (int)queues.size(); i++)
+        workers.push_back(std::thread(&JobSystem::workerLoop, this, i));
+}
+
+void JobSystem::shutdown() {
+    {
+        std::lock_guard<std::mutex> guard(sleepLock);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (size_t i = 0; i < workers.size(); i++) workers[i].join();
+    workers.clear();
+    queues.resize(OUTSIDE_QUEUES);
+}
+
+void JobSystem::workerLoop(int index) {
+    workerIndex = index;
+    while (true) {
+        if (tryRunOne()) continue;
+        std::unique_lock<std::mutex> guard(sleepLock);
+        wake.wait(guard, [this] { return stopping || queued.load() > 0; });
+        if (stopping) return;
+    }
+}
+
+void JobSystem::push(const Task &t) {
+    Queue &q = *queues[queueIndex()];
+    {
+        std::lock_guard<std::mutex> guard(q.lock);
+        q.tasks.push_back(t);
+    }
+    queued++;
+    if (workers.empty()) return;
+    // Taking the lock orders this push against a worker about to sleep
+    { std::lock_guard<std::mutex> guard(sleepLock); }
+    wake.notify_one();
+}
+
+bool JobSystem::tryRunOne() {
+    int self = queueIndex();
+    bool outside = self < OUTSIDE_QUEUES;
+    int n = (int)queues.size();
+    Task t;
+    bool found = false;
+    {
+        Queue &own = *queues[self];
+        std::lock_guard<std::mutex> guard(own.lock);
+        if (!own.tasks.empty()) {
+            t = own.tasks.back();
+            own.tasks.pop_back();
+            found = true;
+        }
+    }
+    for (int k = 1; !found && k < n; k++) {
+        Queue &victim = *queues[(self + k) % n];
+        std::lock_guard<std::mutex> guard(victim.lock);
+        if (victim.tasks.empty()) continue;
+        if (!outside) {
+            t = victim.tasks.front();
+            victim.tasks.pop_front();
+            found = true;
+            continue;
+        }
+        // Outside threads only take back their own work
+        for (std::deque<Task>::iterator it = victim.tasks.begin(); it != victim.tasks.end(); ++it) {
+            if (it->owner != self) continue;
+            t = *it;
+            victim.tasks.erase(it);
+            found = true;
+            break;
+        }
+    }
+    if (!found) return false;
+    queued--;
+    execute(t);
+    return true;
+}
+
+void JobSystem::execute(const Task &t) {
+    int previousOwner = currentOwner;
+    currentOwner = t.owner;
+    if (t.range) {
+        (*t.range)(t.begin, t.end);
+        currentOwner = previousOwner;
+        t.pending->fetch_sub(1);
+        return;
+    }
+
+    JobGraph::Node &node = t.graph->nodes[t.node];
+    if (node.fn) node.fn();
+    currentOwner = previousOwner;
+    for (size_t i = 0; i < node.successors.size(); i++) {
+        JobId s = node.successors[i];
+        if (t.graph->nodes[s].remaining.fetch_sub(1) == 1) {
+            Task next = { t.graph, s, nullptr, 0, 0, nullptr, t.owner };
+            push(next);
+        }
+    }
+    t.graph->finished.fetch_add(1);
+}
+
+void JobSystem::run(JobGraph &graph) {
+    if (graph.nodes.empty()) return;
+    graph.finished = 0;
+    for (size_t i = 0; i < graph.nodes.size(); i++)
+        graph.nodes[i].remaining = graph.nodes[i].dependencies;
+
+    int owner = submitter();
+    for (size_t i = 0; i < graph.nodes.size(); i++) {
+        if (graph.nodes[i].dependencies != 0) continue;
+        Task t = { &graph, (JobId)i, nullptr, 0, 0, nullptr, owner };
+        push(t);
+    }
+    while (graph.finished.load() < graph.nodes.size())
+        if (!tryRunOne()) std::this_thread::yield();
+}
+
+void JobSystem::parallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t)> &fn) {
+    if (count == 0) return;
+    if (grain == 0) grain = 1;
+    size_t slices = (count + grain - 1) / grain;
+    if (slices == 1 || workers.empty()) {
+        fn(0, count);
+        return;
+    }
+
+    std::atomic<size_t> pending(slices - 1);
+    int owner = submitter();
+    for (size_t s = 1; s < slices; s++) {
+        Task t = { nullptr, 0, &fn, s * grain, std::min(count, (s + 1) * grain), &pending, owner };
+        push(t);
+    }
+    fn(0, grain);
+    while (pending.load() > 0)
+        if (!tryRunOne()) std::this_thread::yield();
+}
@@ -0,0 +1,108 @@
+#ifndef JOBSYSTEM_H
+#define JOBSYSTEM_H
+
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <initializer_list>
+
+class JobSystem;
+
+typedef int JobId;
+
+// Jobs for one frame plus the edges between them. A job runs once every
+// job it depends on has finished; independent jobs run in parallel.
+// Dependencies are given at add() time, so the graph is acyclic by
+// construction. Build, run, then clear() and reuse next frame.
+class JobGraph {
+public:
+    JobGraph() : finished(0) {}
+
+    JobId add(const char *name, std::function<void()> fn,
+              std::initializer_list<JobId> deps = std::initializer_list<JobId>());
+    void clear() { nodes.clear(); }
+    size_t size() const { return nodes.size(); }
+
+private:
+    friend class JobSystem;
+
+    struct Node {
+        const char *name;
+        std::function<void()> fn;
+        std::vector<JobId> successors;
+        int dependencies;
+        std::atomic<int> remaining;
+
+        Node() : name(""), dependencies(0), remaining(0) {}
+        Node(const Node &o)
+            : name(o.name), fn(o.fn), successors(o.successors),
+              dependencies(o.dependencies), remaining(o.remaining.load()) {}
+    };
+
+    std::vector<Node> nodes;
+    std::atomic<size_t> finished;
+};
+
+// Work-stealing scheduler. Every thread owns a deque: it pushes and pops
+// at the back, idle threads steal from the front of the others. Threads
+// the pool did not start (GLUT, the sim thread) each get a queue of their
+// own on first use. While one of them waits in run()/parallelFor() it
+// only executes work from its own submissions, so the GL thread never
+// picks up a simulation job and the reverse. Nested parallelFor() inside
+// a job is fine.
+class JobSystem {
+public:
+    JobSystem();
+    ~JobSystem();
+
+    // 0 threads = one per hardware thread, the caller included.
+    void start(int threads = 0);
+    void shutdown();
+    int threadCount() const { return (int)workers.size() + 1; }
+
+    // Blocks until every job in the graph has run.
+    void run(JobGraph &graph);
+
+    // Calls fn(begin, end) over [0, count) in slices of `grain` items and
+    // blocks until all slices are done. A single slice runs inline.
+    void parallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t)> &fn);
+
+private:
+    struct Task {
+        JobGraph *graph;                                  // graph node, or
+        JobId node;
+        const std::function<void(size_t, size_t)> *range; // parallelFor slice
+        size_t begin, end;
+        std::atomic<size_t> *pending;
+        int owner;                                        // queue of the submitting outside thread
+    };
+
+    struct Queue {
+        std::mutex lock;
+        std::deque<Task> tasks;
+    };
+
+    JobSystem(const JobSystem &);
+    JobSystem &operator=(const JobSystem &);
+
+    void workerLoop(int index);
+    void push(const Task &t);
+    bool tryRunOne();
+    void execute(const Task &t);
+
+    std::vector<std::unique_ptr<Queue> > queues;
+    std::vector<std::thread> workers;
+    std::atomic<int> queued;
+    std::mutex sleepLock;
+    std::condition_variable wake;
+    bool stopping;
+};
+
+extern JobSystem jobs;
+
+#endif
@@ -0,0 +1,29 @@
+#include "LevelOfDetail.h"
+#include <cmath>
+
+namespace {
+
+// Coarsest level whose projected error is within `tolerance`.
+int coarsestWithin(const float *error, int levels, float pixelsPerUnit, float tolerance) {
+    int level = 0;
+    while (level + 1 < levels && error[level + 1] * pixelsPerUnit <= tolerance) level++;
+    return level;
+}
+
+}
+
+int selectLod(const float *error, int levels, float pixelsPerUnit, int previous) {
+    if (previous < 0 || previous >= levels)
+        return coarsestWithin(error, levels, pixelsPerUnit, LOD_PIXEL_ERROR);
+
+    // Refine once the current level is clearly too coarse...
+    if (error[previous] * pixelsPerUnit > LOD_PIXEL_ERROR * (1.0f + LOD_HYSTERESIS))
+        return coarsestWithin(error, levels, pixelsPerUnit, LOD_PIXEL_ERROR);
+    // ...and coarsen only to a level clearly fine enough
+    int coarser = coarsestWithin(error, levels, pixelsPerUnit, LOD_PIXEL_ERROR * (1.0f - LOD_HYSTERESIS));
+    return coarser > previous ? coarser : previous;
+}
+
+float circleError(int segments) {
+    return 1.0f - std::cos(3.14159265f / (segments < 3 ? 3 : segments));
+}
@@ -0,0 +1,25 @@
+#ifndef LEVELOFDETAIL_H
+#define LEVELOFDETAIL_H
+
+// Level-of-detail selection by screen-space error. Each level of a mesh
+// records how far (in its own units) it strays from the full mesh; a
+// level is good enough while that error projects to at most
+// LOD_PIXEL_ERROR pixels. Level 0 is the finest.
+enum { MAX_LOD_LEVELS = 4 };
+
+const float LOD_PIXEL_ERROR = 1.0f;
+// Relative band around LOD_PIXEL_ERROR a level must clear before the
+// choice changes, so a distance that wobbles around a boundary does not
+// flip between two levels every frame.
+const float LOD_HYSTERESIS = 0.25f;
+
+// `error` is per level (ascending), `pixelsPerUnit` how many pixels one
+// mesh unit covers at the object's distance. `previous` is last frame's
+// level for the same object, or -1.
+int selectLod(const float *error, int levels, float pixelsPerUnit, int previous);
+
+// Deviation of a circle of radius 1 drawn with `segments` straight
+// sides, i.e. the error of a sphere or cone tessellation.
+float circleError(int segments);
+
+#endif
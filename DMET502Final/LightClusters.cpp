@@ -0,0 +1,187 @@
+#include "LightClusters.h"
+#include "JobSystem.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Unit (a, b) in the plane containing the eye and the given axis.
+void planeNormal(float a, float b, float &na, float &nb) {
+    float len = std::sqrt(a * a + b * b);
+    na = len > 0.0f ? a / len : 0.0f;
+    nb = len > 0.0f ? b / len : 0.0f;
+}
+
+}
+
+LightClusters::LightClusters()
+    : tileCountX(0), tileCountY(0), nearSlice(1.0f), sliceScale(1.0f),
+      lx(nullptr), ly(nullptr), lz(nullptr), lr(nullptr), lightCount(0), base(0),
+      slices(DEPTH_SLICES) {}
+
+// =======================================================
+// FROXEL BOUNDS
+// =======================================================
+void LightClusters::build(const float projection[16], int width, int height,
+                          const float *x, const float *y, const float *z, const float *radius,
+                          size_t count, uint32_t indexBase, bool parallel) {
+    const float *p = projection;
+    tileCountX = std::max(1, (width + TILE_SIZE - 1) / TILE_SIZE);
+    tileCountY = std::max(1, (height + TILE_SIZE - 1) / TILE_SIZE);
+
+    // Exponential slices waste little on the first metre if they start at 1
+    float zNear = p[14] / (p[10] - 1.0f);
+    float zFar = p[14] / (p[10] + 1.0f);
+    nearSlice = std::min(std::max(zNear, 1.0f), zFar * 0.5f);
+    sliceScale = DEPTH_SLICES / std::log(zFar / nearSlice);
+    sliceDepth.resize(DEPTH_SLICES + 1);
+    sliceDepth[0] = 0.0f;
+    for (int s = 1; s < DEPTH_SLICES; s++) sliceDepth[s] = nearSlice * std::exp(s / sliceScale);
+    sliceDepth[DEPTH_SLICES] = zFar;
+
+    // x_ndc >= a  <=>  p0*x + (p8 + a)*z >= 0 for points in front of the eye
+    colLoX.resize(tileCountX);
+    colLoZ.resize(tileCountX);
+    colHiX.resize(tileCountX);
+    colHiZ.resize(tileCountX);
+    for (int i = 0; i < tileCountX; i++) {
+        float a = -1.0f + 2.0f * (i * TILE_SIZE) / width;
+        float b = -1.0f + 2.0f * std::min((i + 1) * TILE_SIZE, width) / width;
+        planeNormal(p[0], p[8] + a, colLoX[i], colLoZ[i]);
+        planeNormal(-p[0], -(p[8] + b), colHiX[i], colHiZ[i]);
+    }
+    rowLoY.resize(tileCountY);
+    rowLoZ.resize(tileCountY);
+    rowHiY.resize(tileCountY);
+    rowHiZ.resize(tileCountY);
+    for (int i = 0; i < tileCountY; i++) {
+        float a = -1.0f + 2.0f * (i * TILE_SIZE) / height;
+        float b = -1.0f + 2.0f * std::min((i + 1) * TILE_SIZE, height) / height;
+        planeNormal(p[5], p[9] + a, rowLoY[i], rowLoZ[i]);
+        planeNormal(-p[5], -(p[9] + b), rowHiY[i], rowHiZ[i]);
+    }
+
+    lx = x;
+    ly = y;
+    lz = z;
+    lr = radius;
+    lightCount = count;
+    base = indexBase;
+    clusterOffsets.resize(clusterCount());
+    clusterCounts.resize(clusterCount());
+
+    if (parallel) jobs.parallelFor(DEPTH_SLICES, 1, [this](size_t b, size_t e) {
+        for (size_t s = b; s < e; s++) binSlice((int)s);
+    });
+    else for (int s = 0; s < DEPTH_SLICES; s++) binSlice(s);
+
+    // Slices are whole runs of clusters, so their lists concatenate
+    size_t total = 0;
+    for (int s = 0; s < DEPTH_SLICES; s++) total += slices[s].indices.size();
+    lightIndices.resize(total);
+    size_t at = 0;
+    int perSlice = tileCountX * tileCountY;
+    for (int s = 0; s < DEPTH_SLICES; s++) {
+        const std::vector<uint32_t> &list = slices[s].indices;
+        std::copy(list.begin(), list.end(), lightIndices.begin() + at);
+        for (int c = s * perSlice; c < (s + 1) * perSlice; c++) clusterOffsets[c] += (uint32_t)at;
+        at += list.size();
+    }
+}
+
+// =======================================================
+// BINNING
+// Each stage filters the previous stage's survivors: depth over all
+// lights, rows over the slice's candidates, then column runs for the
+// row's.
+// =======================================================
+void LightClusters::binSlice(int s) {
+    SliceScratch &sc = slices[s];
+    float zn = sliceDepth[s], zf = sliceDepth[s + 1];
+
+    sc.candidates.resize(lightCount);
+    size_t n = 0;
+    for (size_t i = 0; i < lightCount; i++) {
+        float depth = -lz[i];
+        sc.candidates[n] = (uint32_t)i;
+        n += (depth - lr[i] <= zf) & (depth + lr[i] >= zn);
+    }
+
+    sc.cx.resize(n);
+    sc.cy.resize(n);
+    sc.cz.resize(n);
+    sc.cr.resize(n);
+    for (size_t k = 0; k < n; k++) {
+        uint32_t i = sc.candidates[k];
+        sc.cx[k] = lx[i];
+        sc.cy[k] = ly[i];
+        sc.cz[k] = lz[i];
+        sc.cr[k] = lr[i];
+    }
+    const float *cx = sc.cx.data(), *cy = sc.cy.data(), *cz = sc.cz.data(), *cr = sc.cr.data();
+
+    sc.indices.clear();
+    sc.inRow.resize(n);
+    sc.colFirst.resize(n);
+    sc.colLast.resize(n);
+    sc.colCount.resize(tileCountX + 1);
+    for (int ty = 0; ty < tileCountY; ty++) {
+        int rowCluster = (s * tileCountY + ty) * tileCountX;
+        float loY = rowLoY[ty], loZ = rowLoZ[ty], hiY = rowHiY[ty], hiZ = rowHiZ[ty];
+        size_t m = 0;
+        for (size_t k = 0; k < n; k++) {
+            sc.inRow[m] = (uint32_t)k;
+            m += (loY * cy[k] + loZ * cz[k] >= -cr[k]) & (hiY * cy[k] + hiZ * cz[k] >= -cr[k]);
+        }
+
+        // Column planes move right with tx, so a sphere covers one run of
+        // columns: from the first whose right plane it reaches to the last
+        // whose left plane it reaches. Both ends by binary search.
+        std::fill(sc.colCount.begin(), sc.colCount.end(), 0u);
+        for (size_t j = 0; j < m; j++) {
+            uint32_t k = sc.inRow[j];
+            int lo = 0, hi = tileCountX;
+            while (lo < hi) {
+                int mid = (lo + hi) / 2;
+                if (colHiX[mid] * cx[k] + colHiZ[mid] * cz[k] >= -cr[k]) hi = mid;
+                else lo = mid + 1;
+            }
+            int first = lo;
+            lo = first;
+            hi = tileCountX;
+            while (lo < hi) {
+                int mid = (lo + hi) / 2;
+                if (colLoX[mid] * cx[k] + colLoZ[mid] * cz[k] >= -cr[k]) lo = mid + 1;
+                else hi = mid;
+            }
+            sc.colFirst[j] = first;
+            sc.colLast[j] = lo;     // one past the end
+            for (int tx = first; tx < lo; tx++) sc.colCount[tx]++;
+        }
+
+        // Counting sort by column, capped; lights stay in index order
+        size_t at = sc.indices.size();
+        for (int tx = 0; tx < tileCountX; tx++) {
+            uint32_t found = std::min(sc.colCount[tx], (uint32_t)MAX_CLUSTER_LIGHTS);
+            clusterOffsets[rowCluster + tx] = (uint32_t)at;
+            clusterCounts[rowCluster + tx] = found;
+            sc.colCount[tx] = 0;
+            at += found;
+        }
+        sc.indices.resize(at);
+        for (size_t j = 0; j < m; j++) {
+            uint32_t light = base + sc.candidates[sc.inRow[j]];
+            for (int tx = sc.colFirst[j]; tx < sc.colLast[j]; tx++) {
+                int cluster = rowCluster + tx;
+                if (sc.colCount[tx] < clusterCounts[cluster])
+                    sc.indices[clusterOffsets[cluster] + sc.colCount[tx]++] = light;
+            }
+        }
+    }
+}
+
+size_t LightClusters::maxClusterLights() const {
+    size_t most = 0;
+    for (size_t c = 0; c < clusterCounts.size(); c++) most = std::max(most, (size_t)clusterCounts[c]);
+    return most;
+}
@@ -0,0 +1,74 @@
+#ifndef LIGHTCLUSTERS_H
+#define LIGHTCLUSTERS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+// Assigns point lights to view-space froxels: TILE_SIZE pixel screen
+// tiles times DEPTH_SLICES slices, spaced exponentially from `sliceNear`
+// to the far plane (everything nearer than sliceNear is slice 0).
+//
+// A light (eye-space sphere) lands in every cluster whose frustum it
+// touches: one depth test per slice, one test per tile row against the
+// planes through the eye along the row edges, then a binary search for
+// its run of columns. Lights are kept as SoA columns and the depth and
+// row filters are branch-free loops that write an index and advance by
+// the result, so the compiler can vectorize them. Slices are binned in
+// parallel on the job system, each into its own list.
+class LightClusters {
+public:
+    enum { TILE_SIZE = 32, DEPTH_SLICES = 16, MAX_CLUSTER_LIGHTS = 256 };
+
+    LightClusters();
+
+    // Lights in eye space (x, y, z, radius columns); list entries are
+    // indexBase + the light's position in the columns. `projection` is a
+    // column-major GL perspective matrix.
+    void build(const float projection[16], int width, int height,
+               const float *x, const float *y, const float *z, const float *radius,
+               size_t count, uint32_t indexBase, bool parallel = true);
+
+    int tilesX() const { return tileCountX; }
+    int tilesY() const { return tileCountY; }
+    int clusterCount() const { return tileCountX * tileCountY * DEPTH_SLICES; }
+    // Cluster (tx, ty, slice) is (slice * tilesY + ty) * tilesX + tx.
+    const std::vector<uint32_t> &offsets() const { return clusterOffsets; }
+    const std::vector<uint32_t> &counts() const { return clusterCounts; }
+    const std::vector<uint32_t> &indices() const { return lightIndices; }
+
+    // slice = clamp(floor(log(depth / sliceNear) * depthScale), 0, DEPTH_SLICES - 1)
+    float sliceNear() const { return nearSlice; }
+    float depthScale() const { return sliceScale; }
+
+    size_t maxClusterLights() const;
+
+private:
+    void binSlice(int slice);
+
+    int tileCountX, tileCountY;
+    float nearSlice, sliceScale;
+    std::vector<float> sliceDepth;              // DEPTH_SLICES + 1 boundaries
+
+    // Plane normals (x or y, z) through the eye; a point is inside the
+    // column/row when both dot products are >= 0.
+    std::vector<float> colLoX, colLoZ, colHiX, colHiZ;
+    std::vector<float> rowLoY, rowLoZ, rowHiY, rowHiZ;
+
+    const float *lx, *ly, *lz, *lr;
+    size_t lightCount;
+    uint32_t base;
+
+    struct SliceScratch {
+        std::vector<uint32_t> candidates, inRow;
+        std::vector<int> colFirst, colLast;
+        std::vector<uint32_t> colCount;
+        std::vector<float> cx, cy, cz, cr;
+        std::vector<uint32_t> indices;          // this slice's lists, cluster order
+    };
+    std::vector<SliceScratch> slices;
+
+    std::vector<uint32_t> clusterOffsets, clusterCounts, lightIndices;
+};
+
+#endif
@@ -0,0 +1,415 @@
+#include "Lighting.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+#ifndef GL_RGBA32F_ARB
+#define GL_RGBA32F_ARB 0x8814
+#endif
+#ifndef GL_LUMINANCE32F_ARB
+#define GL_LUMINANCE32F_ARB 0x8818
+#endif
+#ifndef GL_LUMINANCE_ALPHA32F_ARB
+#define GL_LUMINANCE_ALPHA32F_ARB 0x8819
+#endif
+
+Lighting lighting;
+
+namespace {
+
+// Row widths of the light and index textures; powers of two so the
+// shader's row/column split is exact in float.
+const int LIGHT_TEXELS = 4;
+const int LIGHT_TEX_WIDTH = 1024;
+const int INDEX_TEX_WIDTH = 1024;
+const int MAX_GLOBAL_LIGHTS = 4;
+
+// Unit 0 stays the scene's texture (and glState's)
+const int LIGHT_UNIT = 1, CLUSTER_UNIT = 2, INDEX_UNIT = 3;
+
+const char *vertexSource =
+    "#version 120\n"
+    "varying vec3 eyePos;\n"
+    "varying vec3 eyeNormal;\n"
+    "void main() {\n"
+    "    eyePos = (gl_ModelViewMatrix * gl_Vertex).xyz;\n"
+    "    eyeNormal = gl_NormalMatrix * gl_Normal;\n"
+    "    gl_FrontColor = gl_Color;\n"
+    "    gl_TexCoord[0] = gl_TextureMatrix[0] * gl_MultiTexCoord0;\n"
+    "    gl_Position = ftransform();\n"
+    "}\n";
+
+const char *fragmentSource =
+    "#version 120\n"
+    "uniform sampler2D baseTexture;\n"
+    "uniform sampler2D lightData;\n"
+    "uniform sampler2D clusterData;\n"
+    "uniform sampler2D lightIndices;\n"
+    "uniform vec2 lightDataSize, clusterGridSize, indexDataSize;\n"
+    "uniform float tileSize, sliceNear, depthScale, lastSlice;\n"
+    "uniform int globalLights;\n"
+    "uniform bool textured;\n"
+    "uniform bool colorIsEmission;\n"
+    "varying vec3 eyePos;\n"
+    "varying vec3 eyeNormal;\n"
+    "\n"
+    "vec4 texel(sampler2D s, vec2 size, float i) {\n"
+    "    float row = floor(i / size.x);\n"
+    "    return texture2D(s, (vec2(i - row * size.x, row) + 0.5) / size);\n"
+    "}\n"
+    "\n"
+    "vec3 ambientSum, diffuseSum, specularSum;\n"
+    "\n"
+    "// Texels: position + range, diffuse + constant, ambient + linear,\n"
+    "// specular + quadratic\n"
+    "void addLight(float index, vec3 n) {\n"
+    "    float base = index * 4.0;\n"
+    "    vec4 p = texel(lightData, lightDataSize, base);\n"
+    "    vec3 toLight = p.xyz - eyePos;\n"
+    "    float d = length(toLight);\n"
+    "    if (d > p.w) return;\n"
+    "    vec4 diffuse = texel(lightData, lightDataSize, base + 1.0);\n"
+    "    vec4 ambient = texel(lightData, lightDataSize, base + 2.0);\n"
+    "    vec4 specular = texel(lightData, lightDataSize, base + 3.0);\n"
+    "    vec3 l = toLight / d;\n"
+    "    float attenuation = 1.0 / (diffuse.w + ambient.w * d + specular.w * d * d);\n"
+    "    float nl = max(dot(n, l), 0.0);\n"
+    "    ambientSum += attenuation * ambient.rgb;\n"
+    "    diffuseSum += attenuation * nl * diffuse.rgb;\n"
+    "    if (nl > 0.0) {\n"
+    "        float nh = max(dot(n, normalize(l + vec3(0.0, 0.0, 1.0))), 0.0);\n"
+    "        float shine = gl_FrontMaterial.shininess;\n"
+    "        specularSum += attenuation * (shine > 0.0 ? pow(nh, shine) : 1.0) * specular.rgb;\n"
+    "    }\n"
+    "}\n"
+    "\n"
+    "void main() {\n"
+    "    vec3 n = normalize(eyeNormal);\n"
+    "    ambientSum = vec3(0.0);\n"
+    "    diffuseSum = vec3(0.0);\n"
+    "    specularSum = vec3(0.0);\n"
+    "\n"
+    "    for (int i = 0; i < 4; i++) {\n"
+    "        if (i >= globalLights) break;\n"
+    "        addLight(float(i), n);\n"
+    "    }\n"
+    "    vec2 tile = floor(gl_FragCoord.xy / tileSize);\n"
+    "    float slice = clamp(floor(log(max(-eyePos.z, 1e-4) / sliceNear) * depthScale), 0.0, lastSlice);\n"
+    "    vec2 cluster = vec2(tile.x, slice * clusterGridSize.y / (lastSlice + 1.0) + tile.y);\n"
+    "    vec4 list = texture2D(clusterData, (cluster + 0.5) / clusterGridSize);\n"
+    "    for (int i = 0; i < 256; i++) {\n"
+    "        if (float(i) >= list.a) break;\n"
+    "        addLight(texel(lightIndices, indexDataSize, list.r + float(i)).r, n);\n"
+    "    }\n"
+    "\n"
+    "    vec4 matDiffuse = colorIsEmission ? gl_FrontMaterial.diffuse : gl_Color;\n"
+    "    vec4 matAmbient = colorIsEmission ? gl_FrontMaterial.ambient : gl_Color;\n"
+    "    vec3 emission = colorIsEmission ? gl_Color.rgb : gl_FrontMaterial.emission.rgb;\n"
+    "    vec3 lit = emission + matAmbient.rgb * (gl_LightModel.ambient.rgb + ambientSum)\n"
+    "             + matDiffuse.rgb * diffuseSum + gl_FrontMaterial.specular.rgb * specularSum;\n"
+    "    vec4 color = clamp(vec4(lit, matDiffuse.a), 0.0, 1.0);\n"
+    "    if (textured) color *= texture2D(baseTexture, gl_TexCoord[0].st);\n"
+    "\n"
+    "    float fogDepth = gl_Fog.density * abs(eyePos.z);\n"
+    "    float fog = clamp(exp(-fogDepth * fogDepth), 0.0, 1.0);\n"
+    "    gl_FragColor = vec4(mix(gl_Fog.color.rgb, color.rgb, fog), color.a);\n"
+    "}\n";
+
+GLuint compile(GLenum type, const char *source, const char *name) {
+    GLuint shader = glCreateShader(type);
+    glShaderSource(shader, 1, &source, nullptr);
+    glCompileShader(shader);
+    GLint ok = 0;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &ok);
+    if (!ok) {
+        char log[2048] = "";
+        glGetShaderInfoLog(shader, sizeof(log), nullptr, log);
+        std::cout << "ERROR: Lighting " << name << " shader: " << log << "\n";
+        glDeleteShader(shader);
+        return 0;
+    }
+    return shader;
+}
+
+bool hasExtension(const char *name) {
+    const char *ext = (const char *)glGetString(GL_EXTENSIONS);
+    return ext && strstr(ext, name) != nullptr;
+}
+
+// Distance at which the light adds less than 1/256 to every channel;
+// negative when it never falls that far (no falloff).
+float influenceRange(const PointLight &l) {
+    float peak = 0.0f;
+    for (int c = 0; c < 3; c++) peak = std::max(peak, l.ambient[c] + l.diffuse[c] + l.specular[c]);
+    float k = l.constant - 256.0f * peak;       // solve attenuation * peak = 1/256
+    if (k >= 0.0f) return 0.0f;
+    if (l.quadratic > 0.0f)
+        return (-l.linear + std::sqrt(l.linear * l.linear - 4.0f * l.quadratic * k)) / (2.0f * l.quadratic);
+    if (l.linear > 0.0f) return -k / l.linear;
+    return -1.0f;
+}
+
+void setTexel(float *dst, float a, float b, float c, float d) {
+    dst[0] = a;
+    dst[1] = b;
+    dst[2] = c;
+    dst[3] = d;
+}
+
+// Data textures live on their own units, so uploads leave unit 0's
+// binding (which glState tracks) alone.
+void bindDataTexture(int unit, GLuint texture) {
+    glActiveTexture(GL_TEXTURE0 + unit);
+    glBindTexture(GL_TEXTURE_2D, texture);
+}
+
+// (Re)allocates when the texture needs more rows, else updates in place.
+void uploadRows(int unit, GLuint texture, GLint internalFormat, GLenum format, int width, int rows,
+                int &allocatedRows, const float *data) {
+    bindDataTexture(unit, texture);
+    if (rows > allocatedRows) {
+        glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, rows, 0, format, GL_FLOAT, data);
+        allocatedRows = rows;
+    }
+    else
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, rows, format, GL_FLOAT, data);
+}
+
+GLuint makeDataTexture(int unit) {
+    GLuint t;
+    glGenTextures(1, &t);
+    bindDataTexture(unit, t);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    return t;
+}
+
+}
+
+Lighting::Lighting()
+    : program(0), lightTexture(0), clusterTexture(0), indexTexture(0), lightRows(0), indexRows(0),
+      clusterWidth(0), clusterHeight(0), bound(false), textured(false), colorIsEmission(false), lightTotal(0), globalLights(0) {}
+
+// =======================================================
+// SETUP
+// =======================================================
+bool Lighting::init() {
+    const char *version = (const char *)glGetString(GL_VERSION);
+    int major = 0, minor = 0;
+    if (version) sscanf(version, "%d.%d", &major, &minor);
+    if (major < 2) {
+        std::cout << "Per-pixel lighting needs OpenGL 2.0, using fixed-function lights\n";
+        return false;
+    }
+    const char *glsl = (const char *)glGetString(GL_SHADING_LANGUAGE_VERSION);
+    int glslMajor = 0, glslMinor = 0;
+    if (glsl) sscanf(glsl, "%d.%d", &glslMajor, &glslMinor);
+    if (glslMajor * 100 + glslMinor < 120) {
+        std::cout << "Per-pixel lighting needs GLSL 1.20, using fixed-function lights\n";
+        return false;
+    }
+    if (major < 3 && !hasExtension("GL_ARB_texture_float")) {
+        std::cout << "Per-pixel lighting needs float textures, using fixed-function lights\n";
+        return false;
+    }
+
+    GLuint vs = compile(GL_VERTEX_SHADER, vertexSource, "vertex");
+    GLuint fs = vs ? compile(GL_FRAGMENT_SHADER, fragmentSource, "fragment") : 0;
+    if (!fs) {
+        if (vs) glDeleteShader(vs);
+        return false;
+    }
+    GLuint p = glCreateProgram();
+    glAttachShader(p, vs);
+    glAttachShader(p, fs);
+    glLinkProgram(p);
+    glDeleteShader(vs);
+    glDeleteShader(fs);
+    GLint ok = 0;
+    glGetProgramiv(p, GL_LINK_STATUS, &ok);
+    if (!ok) {
+        char log[2048] = "";
+        glGetProgramInfoLog(p, sizeof(log), nullptr, log);
+        std::cout << "ERROR: Lighting shader link: " << log << "\n";
+        glDeleteProgram(p);
+        return false;
+    }
+    program = p;
+
+    glUseProgram(program);
+    glUniform1i(glGetUniformLocation(program, "baseTexture"), 0);
+    glUniform1i(glGetUniformLocation(program, "lightData"), LIGHT_UNIT);
+    glUniform1i(glGetUniformLocation(program, "clusterData"), CLUSTER_UNIT);
+    glUniform1i(glGetUniformLocation(program, "lightIndices"), INDEX_UNIT);
+    uTextured = glGetUniformLocation(program, "textured");
+    uColorIsEmission = glGetUniformLocation(program, "colorIsEmission");
+    uGlobalLights = glGetUniformLocation(program, "globalLights");
+    uTileSize = glGetUniformLocation(program, "tileSize");
+    uLightDataSize = glGetUniformLocation(program, "lightDataSize");
+    uClusterGridSize = glGetUniformLocation(program, "clusterGridSize");
+    uSliceNear = glGetUniformLocation(program, "sliceNear");
+    uDepthScale = glGetUniformLocation(program, "depthScale");
+    uLastSlice = glGetUniformLocation(program, "lastSlice");
+    uIndexDataSize = glGetUniformLocation(program, "indexDataSize");
+    glUseProgram(0);
+
+    lightTexture = makeDataTexture(LIGHT_UNIT);
+    clusterTexture = makeDataTexture(CLUSTER_UNIT);
+    indexTexture = makeDataTexture(INDEX_UNIT);
+    glActiveTexture(GL_TEXTURE0);
+    return true;
+}
+
+// =======================================================
+// LIGHT LIST + CLUSTERS
+// =======================================================
+void Lighting::update(const std::vector<PointLight> &lights, int width, int height) {
+    if (!active()) return;
+
+    float mv[16], proj[16];
+    glGetFloatv(GL_MODELVIEW_MATRIX, mv);
+    glGetFloatv(GL_PROJECTION_MATRIX, proj);
+
+    // Global lights first: the shader shades indices [0, globalLights)
+    // everywhere and finds the rest through the clusters. Lights with no
+    // falloff past that limit are binned with an unbounded range.
+    std::vector<const PointLight *> order;
+    std::vector<float> ranges;
+    std::vector<size_t> local;
+    for (size_t i = 0; i < lights.size(); i++) {
+        float range = influenceRange(lights[i]);
+        if (range == 0.0f) continue;
+        if (range < 0.0f && order.size() < (size_t)MAX_GLOBAL_LIGHTS) {
+            order.push_back(&lights[i]);
+            ranges.push_back(1e30f);
+        }
+        else local.push_back(i);
+    }
+    globalLights = (int)order.size();
+    for (size_t i = 0; i < local.size(); i++) {
+        float range = influenceRange(lights[local[i]]);
+        order.push_back(&lights[local[i]]);
+        ranges.push_back(range < 0.0f ? 1e30f : range);
+    }
+    lightTotal = order.size();
+
+    size_t localCount = order.size() - globalLights;
+    eyeX.resize(localCount);
+    eyeY.resize(localCount);
+    eyeZ.resize(localCount);
+    eyeRange.resize(localCount);
+    lightData.assign((size_t)std::max(1, ((int)order.size() * LIGHT_TEXELS + LIGHT_TEX_WIDTH - 1) / LIGHT_TEX_WIDTH)
+                     * LIGHT_TEX_WIDTH * 4, 0.0f);
+    for (size_t i = 0; i < order.size(); i++) {
+        const PointLight &l = *order[i];
+        const float *p = l.position;
+        float eye[3];
+        for (int r = 0; r < 3; r++) eye[r] = mv[r] * p[0] + mv[4 + r] * p[1] + mv[8 + r] * p[2] + mv[12 + r];
+
+        float *t = &lightData[i * LIGHT_TEXELS * 4];
+        setTexel(t, eye[0], eye[1], eye[2], ranges[i]);
+        setTexel(t + 4, l.diffuse[0], l.diffuse[1], l.diffuse[2], l.constant);
+        setTexel(t + 8, l.ambient[0], l.ambient[1], l.ambient[2], l.linear);
+        setTexel(t + 12, l.specular[0], l.specular[1], l.specular[2], l.quadratic);
+
+        if ((int)i < globalLights) continue;
+        size_t k = i - globalLights;
+        eyeX[k] = eye[0];
+        eyeY[k] = eye[1];
+        eyeZ[k] = eye[2];
+        eyeRange[k] = ranges[i];
+    }
+
+    clusters.build(proj, width, height, eyeX.data(), eyeY.data(), eyeZ.data(), eyeRange.data(),
+                   localCount, (uint32_t)globalLights);
+
+    int clusterCount = clusters.clusterCount();
+    const std::vector<uint32_t> &offsets = clusters.offsets();
+    const std::vector<uint32_t> &counts = clusters.counts();
+    const std::vector<uint32_t> &indices = clusters.indices();
+    clusterData.resize((size_t)clusterCount * 2);
+    for (int c = 0; c < clusterCount; c++) {
+        clusterData[c * 2] = (float)offsets[c];
+        clusterData[c * 2 + 1] = (float)counts[c];
+    }
+    indexData.assign((std::max<size_t>(1, (indices.size() + INDEX_TEX_WIDTH - 1) / INDEX_TEX_WIDTH)) * INDEX_TEX_WIDTH, 0.0f);
+    std::copy(indices.begin(), indices.end(), indexData.begin());
+
+    // The cluster grid follows the window size; reallocate only when it changes
+    int gridWidth = clusters.tilesX(), gridHeight = clusters.tilesY() * LightClusters::DEPTH_SLICES;
+    bindDataTexture(CLUSTER_UNIT, clusterTexture);
+    if (gridWidth != clusterWidth || gridHeight != clusterHeight) {
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_LUMINANCE_ALPHA32F_ARB, gridWidth, gridHeight, 0,
+                     GL_LUMINANCE_ALPHA, GL_FLOAT, clusterData.data());
+        clusterWidth = gridWidth;
+        clusterHeight = gridHeight;
+    }
+    else
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, gridWidth, gridHeight, GL_LUMINANCE_ALPHA, GL_FLOAT,
+                        clusterData.data());
+    uploadRows(LIGHT_UNIT, lightTexture, GL_RGBA32F_ARB, GL_RGBA, LIGHT_TEX_WIDTH,
+               (int)(lightData.size() / (LIGHT_TEX_WIDTH * 4)), lightRows, lightData.data());
+    uploadRows(INDEX_UNIT, indexTexture, GL_LUMINANCE32F_ARB, GL_LUMINANCE, INDEX_TEX_WIDTH,
+               (int)(indexData.size() / INDEX_TEX_WIDTH), indexRows, indexData.data());
+    glActiveTexture(GL_TEXTURE0);
+}
+
+float Lighting::averageLightsPerCluster() const {
+    const std::vector<uint32_t> &counts = clusters.counts();
+    size_t lit = 0, total = 0;
+    for (size_t c = 0; c < counts.size(); c++) {
+        lit += counts[c] > 0;
+        total += counts[c];
+    }
+    return lit ? (float)total / (float)lit : 0.0f;
+}
+
+// =======================================================
+// DRAWING
+// =======================================================
+void Lighting::bind() {
+    if (!active()) return;
+    glUseProgram(program);
+    bound = true;
+    glUniform1i(uGlobalLights, globalLights);
+    glUniform1f(uTileSize, (float)LightClusters::TILE_SIZE);
+    glUniform1f(uSliceNear, clusters.sliceNear());
+    glUniform1f(uDepthScale, clusters.depthScale());
+    glUniform1f(uLastSlice, (float)(LightClusters::DEPTH_SLICES - 1));
+    glUniform2f(uLightDataSize, (float)LIGHT_TEX_WIDTH, (float)lightRows);
+    glUniform2f(uClusterGridSize, (float)clusters.tilesX(),
+                (float)(clusters.tilesY() * LightClusters::DEPTH_SLICES));
+    glUniform2f(uIndexDataSize, (float)INDEX_TEX_WIDTH, (float)indexRows);
+    textured = false;
+    colorIsEmission = false;
+    glUniform1i(uTextured, 0);
+    glUniform1i(uColorIsEmission, 0);
+
+    // update() left them bound; rebinding keeps this independent of it
+    bindDataTexture(LIGHT_UNIT, lightTexture);
+    bindDataTexture(CLUSTER_UNIT, clusterTexture);
+    bindDataTexture(INDEX_UNIT, indexTexture);
+    glActiveTexture(GL_TEXTURE0);
+}
+
+void Lighting::unbind() {
+    if (!bound) return;
+    glUseProgram(0);
+    bound = false;
+}
+
+void Lighting::setMaterial(bool tex, bool emission) {
+    if (!bound) return;
+    if (tex != textured) {
+        glUniform1i(uTextured, tex ? 1 : 0);
+        textured = tex;
+    }
+    if (emission != colorIsEmission) {
+        glUniform1i(uColorIsEmission, emission ? 1 : 0);
+        colorIsEmission = emission;
+    }
+}
@@ -0,0 +1,86 @@
+#ifndef LIGHTING_H
+#define LIGHTING_H
+
+#include <vector>
+#include "GLPlatform.h"
+#include "LightClusters.h"
+
+// A positional light with fixed-function style colours and attenuation
+// 1 / (constant + linear*d + quadratic*d^2).
+struct PointLight {
+    float position[3];      // world space
+    float ambient[3];
+    float diffuse[3];
+    float specular[3];
+    float constant, linear, quadratic;
+};
+
+// Per-pixel lighting for any number of point lights (GLSL 1.20, so it
+// also runs on the legacy 2.1 contexts macOS gives GLUT).
+//
+// The frame's lights go into a float texture, 4 texels each. Every light
+// is binned on the CPU into the view-space clusters its sphere of
+// influence touches (see LightClusters); the fragment shader finds its
+// cluster from the pixel and depth and walks only that list. A light's
+// influence ends where it would add less than 1/256 to any channel, so
+// the cut-off is invisible in 8-bit output. Lights with no falloff reach
+// everywhere and are shaded for every pixel.
+//
+// The shader reproduces what the fixed-function pipeline did with these
+// lights: global ambient 0.2, infinite viewer specular, colour material
+// (ambient+diffuse or emission, see setMaterial()), GL_MODULATE texturing
+// and EXP2 fog. GL thread only.
+class Lighting {
+public:
+    Lighting();
+
+    // After the context exists. Prints why and returns false when the
+    // context lacks GLSL 1.20 or float textures; the caller keeps using
+    // fixed-function lights then.
+    bool init();
+    bool active() const { return program != 0; }
+
+    // Lights for this frame, binned against the current camera
+    // (GL_MODELVIEW and GL_PROJECTION as set by renderScene()) for a
+    // viewport of width x height.
+    void update(const std::vector<PointLight> &lights, int width, int height);
+
+    // Program and light textures on; every draw in between is lit by
+    // the shader.
+    void bind();
+    void unbind();
+    // Whether the bound texture modulates the colour, and whether the
+    // current colour is the emission (GL_EMISSION colour material)
+    // instead of ambient and diffuse. Ignored outside bind()/unbind().
+    void setMaterial(bool textured, bool colorIsEmission);
+
+    size_t lightCount() const { return lightTotal; }
+    // Mean list length over clusters with any light, for the last update().
+    float averageLightsPerCluster() const;
+
+private:
+    Lighting(const Lighting &);
+    Lighting &operator=(const Lighting &);
+
+    GLuint program;
+    GLuint lightTexture, clusterTexture, indexTexture;
+    int lightRows, indexRows;   // allocated texture heights
+    int clusterWidth, clusterHeight;
+
+    GLint uTextured, uColorIsEmission, uGlobalLights, uTileSize;
+    GLint uLightDataSize, uClusterGridSize, uIndexDataSize;
+    GLint uSliceNear, uDepthScale, uLastSlice;
+    bool bound, textured, colorIsEmission;
+
+    size_t lightTotal;
+    int globalLights;
+    std::vector<float> eyeX, eyeY, eyeZ, eyeRange;  // clustered lights
+    LightClusters clusters;
+    std::vector<float> lightData;           // RGBA texels
+    std::vector<float> clusterData;         // luminance-alpha: first index, count
+    std::vector<float> indexData;           // one light index per texel
+};
+
+extern Lighting lighting;
+
+#endif
@@ -0,0 +1,43 @@
+#include "MappedFile.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+MappedFile::MappedFile() : ptr(nullptr), length(0), fd(-1) {}
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+bool MappedFile::open(const std::string &path) {
+    close();
+
+    fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close();
+        return false;
+    }
+
+    length = (size_t)st.st_size;
+    if (length == 0) return true;
+
+    void *p = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (p == MAP_FAILED) {
+        close();
+        return false;
+    }
+    ptr = (const char *)p;
+    return true;
+}
+
+void MappedFile::close() {
+    if (ptr) munmap((void *)ptr, length);
+    if (fd >= 0) ::close(fd);
+    ptr = nullptr;
+    length = 0;
+    fd = -1;
+}
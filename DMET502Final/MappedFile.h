@@ -0,0 +1,29 @@
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <string>
+#include <cstddef>
+
+// Read-only memory mapping of a whole file.
+class MappedFile {
+public:
+    MappedFile();
+    ~MappedFile();
+
+    bool open(const std::string &path);
+    void close();
+
+    const char *data() const { return ptr; }
+    size_t size() const { return length; }
+    bool isOpen() const { return ptr != nullptr || (fd >= 0 && length == 0); }
+
+private:
+    MappedFile(const MappedFile &);
+    MappedFile &operator=(const MappedFile &);
+
+    const char *ptr;
+    size_t length;
+    int fd;
+};
+
+#endif
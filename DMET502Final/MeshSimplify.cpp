@@ -0,0 +1,337 @@
+#include "MeshSimplify.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <queue>
+#include <stdint.h>
+#include <unordered_map>
+
+namespace {
+
+// Border planes count this many times a face's own plane, per unit of
+// squared edge length.
+const double BORDER_WEIGHT = 10.0;
+
+// Symmetric 4x4 quadric, upper triangle: xx xy xz xw yy yz yw zz zw ww
+struct Quadric {
+    double m[10];
+
+    Quadric() { memset(m, 0, sizeof(m)); }
+
+    void addPlane(double a, double b, double c, double d, double w) {
+        m[0] += w * a * a; m[1] += w * a * b; m[2] += w * a * c; m[3] += w * a * d;
+        m[4] += w * b * b; m[5] += w * b * c; m[6] += w * b * d;
+        m[7] += w * c * c; m[8] += w * c * d;
+        m[9] += w * d * d;
+    }
+
+    void add(const Quadric &q) {
+        for (int i = 0; i < 10; i++) m[i] += q.m[i];
+    }
+
+    // Weighted sum of squared distances from (x, y, z) to the planes
+    double error(double x, double y, double z) const {
+        return m[0] * x * x + 2.0 * m[1] * x * y + 2.0 * m[2] * x * z + 2.0 * m[3] * x +
+               m[4] * y * y + 2.0 * m[5] * y * z + 2.0 * m[6] * y +
+               m[7] * z * z + 2.0 * m[8] * z + m[9];
+    }
+};
+
+// Moves position `from` onto position `to`. The stamps go stale as soon
+// as either end changes, and the entry is dropped when popped.
+struct Collapse {
+    double cost;
+    unsigned int from, to;
+    unsigned int fromStamp, toStamp;
+
+    bool operator<(const Collapse &o) const { return cost > o.cost; }   // cheapest on top
+};
+
+struct Vec {
+    double x, y, z;
+};
+
+Vec sub(const Vec &a, const Vec &b) { Vec v = { a.x - b.x, a.y - b.y, a.z - b.z }; return v; }
+Vec cross(const Vec &a, const Vec &b) {
+    Vec v = { a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x };
+    return v;
+}
+double dot(const Vec &a, const Vec &b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+
+struct PositionKey {
+    float x, y, z;
+    bool operator==(const PositionKey &o) const { return x == o.x && y == o.y && z == o.z; }
+};
+
+struct PositionKeyHash {
+    size_t operator()(const PositionKey &k) const {
+        uint32_t b[3];
+        memcpy(b, &k.x, sizeof(float));
+        memcpy(b + 1, &k.y, sizeof(float));
+        memcpy(b + 2, &k.z, sizeof(float));
+        return (size_t)b[0] * 73856093u ^ (size_t)b[1] * 19349663u ^ (size_t)b[2] * 83492791u;
+    }
+};
+
+class Simplifier {
+public:
+    Simplifier(const std::vector<MeshVertex> &vertices, const std::vector<unsigned int> &indices);
+    void run(const std::vector<size_t> &targetTriangles, std::vector<SimplifiedLevel> &levels);
+
+private:
+    void addBorderPlanes();
+    void pushCandidates(unsigned int a, unsigned int b);
+    bool keepsOrientation(unsigned int from, unsigned int to) const;
+    unsigned int matchVertex(unsigned int vertex, unsigned int to) const;
+    void collapse(unsigned int from, unsigned int to);
+    void emit(std::vector<SimplifiedLevel> &levels) const;
+    bool touches(size_t tri, unsigned int pos) const;
+
+    const std::vector<MeshVertex> &verts;
+
+    // Welded positions
+    std::vector<Vec> pos;
+    std::vector<unsigned int> posOf;                    // per vertex
+    std::vector<std::vector<unsigned int> > vertsAt;    // per position
+    std::vector<Quadric> quadric;
+    std::vector<double> area;
+    std::vector<std::vector<unsigned int> > trisOf;     // may hold dead triangles
+    std::vector<char> removed;
+    std::vector<unsigned int> stamp;
+
+    std::vector<unsigned int> corners;                  // 3 vertices per triangle
+    std::vector<char> alive;
+    size_t liveTriangles;
+
+    std::priority_queue<Collapse> heap;
+    double worstError;
+};
+
+Simplifier::Simplifier(const std::vector<MeshVertex> &vertices, const std::vector<unsigned int> &indices)
+    : verts(vertices), liveTriangles(0), worstError(0.0) {
+    std::unordered_map<PositionKey, unsigned int, PositionKeyHash> welded;
+    welded.reserve(vertices.size());
+    posOf.resize(vertices.size());
+    for (size_t i = 0; i < vertices.size(); i++) {
+        PositionKey key = { vertices[i].px, vertices[i].py, vertices[i].pz };
+        std::pair<std::unordered_map<PositionKey, unsigned int, PositionKeyHash>::iterator, bool> found =
+            welded.insert(std::make_pair(key, (unsigned int)pos.size()));
+        if (found.second) {
+            Vec p = { key.x, key.y, key.z };
+            pos.push_back(p);
+            vertsAt.push_back(std::vector<unsigned int>());
+        }
+        posOf[i] = found.first->second;
+        vertsAt[posOf[i]].push_back((unsigned int)i);
+    }
+
+    size_t n = pos.size();
+    quadric.resize(n);
+    area.assign(n, 0.0);
+    trisOf.resize(n);
+    removed.assign(n, 0);
+    stamp.assign(n, 0);
+
+    for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+        unsigned int a = posOf[indices[i]], b = posOf[indices[i + 1]], c = posOf[indices[i + 2]];
+        if (a == b || b == c || a == c) continue;
+
+        Vec normal = cross(sub(pos[b], pos[a]), sub(pos[c], pos[a]));
+        double len = std::sqrt(dot(normal, normal));
+        if (len > 0.0) {
+            double nx = normal.x / len, ny = normal.y / len, nz = normal.z / len;
+            double d = -(nx * pos[a].x + ny * pos[a].y + nz * pos[a].z);
+            double w = len * 0.5;
+            unsigned int p[3] = { a, b, c };
+            for (int k = 0; k < 3; k++) {
+                quadric[p[k]].addPlane(nx, ny, nz, d, w);
+                area[p[k]] += w;
+            }
+        }
+
+        unsigned int t = (unsigned int)(corners.size() / 3);
+        for (int k = 0; k < 3; k++) corners.push_back(indices[i + k]);
+        alive.push_back(1);
+        trisOf[a].push_back(t);
+        trisOf[b].push_back(t);
+        trisOf[c].push_back(t);
+        liveTriangles++;
+    }
+    addBorderPlanes();
+
+    for (size_t t = 0; t < alive.size(); t++)
+        for (int k = 0; k < 3; k++)
+            pushCandidates(posOf[corners[t * 3 + k]], posOf[corners[t * 3 + (k + 1) % 3]]);
+}
+
+// An edge with one triangle is a border; a plane through it, upright on
+// the face, keeps the outline from shrinking.
+void Simplifier::addBorderPlanes() {
+    std::unordered_map<uint64_t, int> edgeUse;
+    for (size_t t = 0; t < alive.size(); t++)
+        for (int k = 0; k < 3; k++) {
+            uint64_t a = posOf[corners[t * 3 + k]], b = posOf[corners[t * 3 + (k + 1) % 3]];
+            edgeUse[std::min(a, b) << 32 | std::max(a, b)]++;
+        }
+
+    for (size_t t = 0; t < alive.size(); t++) {
+        const unsigned int *c = &corners[t * 3];
+        Vec normal = cross(sub(pos[posOf[c[1]]], pos[posOf[c[0]]]), sub(pos[posOf[c[2]]], pos[posOf[c[0]]]));
+        for (int k = 0; k < 3; k++) {
+            uint64_t a = posOf[c[k]], b = posOf[c[(k + 1) % 3]];
+            if (edgeUse[std::min(a, b) << 32 | std::max(a, b)] != 1) continue;
+
+            Vec edge = sub(pos[b], pos[a]);
+            Vec side = cross(edge, normal);
+            double len = std::sqrt(dot(side, side));
+            if (len <= 0.0) continue;
+            double nx = side.x / len, ny = side.y / len, nz = side.z / len;
+            double d = -(nx * pos[a].x + ny * pos[a].y + nz * pos[a].z);
+            double w = BORDER_WEIGHT * dot(edge, edge);
+            quadric[a].addPlane(nx, ny, nz, d, w);
+            quadric[b].addPlane(nx, ny, nz, d, w);
+        }
+    }
+}
+
+// Both directions; the cost is the mean squared distance from the kept
+// position to the planes of both ends.
+void Simplifier::pushCandidates(unsigned int a, unsigned int b) {
+    Quadric q = quadric[a];
+    q.add(quadric[b]);
+    double weight = std::max(area[a] + area[b], 1e-12);
+    Collapse ab = { std::max(q.error(pos[b].x, pos[b].y, pos[b].z), 0.0) / weight, a, b, stamp[a], stamp[b] };
+    Collapse ba = { std::max(q.error(pos[a].x, pos[a].y, pos[a].z), 0.0) / weight, b, a, stamp[b], stamp[a] };
+    heap.push(ab);
+    heap.push(ba);
+}
+
+bool Simplifier::touches(size_t tri, unsigned int p) const {
+    const unsigned int *c = &corners[tri * 3];
+    return posOf[c[0]] == p || posOf[c[1]] == p || posOf[c[2]] == p;
+}
+
+// No surviving face around `from` may turn over or collapse to a line.
+bool Simplifier::keepsOrientation(unsigned int from, unsigned int to) const {
+    const std::vector<unsigned int> &tris = trisOf[from];
+    for (size_t i = 0; i < tris.size(); i++) {
+        unsigned int t = tris[i];
+        if (!alive[t] || touches(t, to)) continue;
+
+        Vec before[3], after[3];
+        for (int k = 0; k < 3; k++) {
+            unsigned int p = posOf[corners[t * 3 + k]];
+            before[k] = pos[p];
+            after[k] = p == from ? pos[to] : pos[p];
+        }
+        Vec n0 = cross(sub(before[1], before[0]), sub(before[2], before[0]));
+        Vec n1 = cross(sub(after[1], after[0]), sub(after[2], after[0]));
+        if (dot(n0, n1) <= 0.0 || dot(n1, n1) <= 0.0) return false;
+    }
+    return true;
+}
+
+// The vertex at `to` whose normal and UV are closest to `vertex`, so a
+// corner keeps its side of a seam.
+unsigned int Simplifier::matchVertex(unsigned int vertex, unsigned int to) const {
+    const MeshVertex &v = verts[vertex];
+    const std::vector<unsigned int> &candidates = vertsAt[to];
+    unsigned int best = candidates[0];
+    double bestScore = 1e30;
+    for (size_t i = 0; i < candidates.size(); i++) {
+        const MeshVertex &w = verts[candidates[i]];
+        double du = v.u - w.u, dv = v.v - w.v;
+        double score = (1.0 - (v.nx * w.nx + v.ny * w.ny + v.nz * w.nz)) + du * du + dv * dv;
+        if (score < bestScore) {
+            bestScore = score;
+            best = candidates[i];
+        }
+    }
+    return best;
+}
+
+void Simplifier::collapse(unsigned int from, unsigned int to) {
+    std::vector<unsigned int> &tris = trisOf[from];
+    for (size_t i = 0; i < tris.size(); i++) {
+        unsigned int t = tris[i];
+        if (!alive[t]) continue;
+        if (touches(t, to)) {
+            alive[t] = 0;
+            liveTriangles--;
+            continue;
+        }
+        for (int k = 0; k < 3; k++) {
+            unsigned int &c = corners[t * 3 + k];
+            if (posOf[c] == from) c = matchVertex(c, to);
+        }
+        trisOf[to].push_back(t);
+    }
+    std::vector<unsigned int>().swap(tris);
+
+    quadric[to].add(quadric[from]);
+    area[to] += area[from];
+    removed[from] = 1;
+    stamp[to]++;
+
+    // Drop dead faces and re-price every edge out of `to`
+    std::vector<unsigned int> &around = trisOf[to];
+    size_t kept = 0;
+    for (size_t i = 0; i < around.size(); i++)
+        if (alive[around[i]]) around[kept++] = around[i];
+    around.resize(kept);
+
+    std::vector<unsigned int> neighbours;
+    for (size_t i = 0; i < around.size(); i++)
+        for (int k = 0; k < 3; k++) {
+            unsigned int p = posOf[corners[around[i] * 3 + k]];
+            if (p != to) neighbours.push_back(p);
+        }
+    std::sort(neighbours.begin(), neighbours.end());
+    neighbours.erase(std::unique(neighbours.begin(), neighbours.end()), neighbours.end());
+    for (size_t i = 0; i < neighbours.size(); i++) pushCandidates(to, neighbours[i]);
+}
+
+void Simplifier::emit(std::vector<SimplifiedLevel> &levels) const {
+    levels.push_back(SimplifiedLevel());
+    SimplifiedLevel &level = levels.back();
+    level.indices.reserve(liveTriangles * 3);
+    for (size_t t = 0; t < alive.size(); t++)
+        if (alive[t]) level.indices.insert(level.indices.end(), &corners[t * 3], &corners[t * 3] + 3);
+    level.error = (float)std::sqrt(worstError);
+}
+
+void Simplifier::run(const std::vector<size_t> &targetTriangles, std::vector<SimplifiedLevel> &levels) {
+    size_t next = 0;
+    while (next < targetTriangles.size()) {
+        if (liveTriangles <= targetTriangles[next]) {
+            emit(levels);
+            next++;
+            continue;
+        }
+        if (heap.empty()) break;
+
+        Collapse c = heap.top();
+        heap.pop();
+        if (removed[c.from] || removed[c.to] || stamp[c.from] != c.fromStamp || stamp[c.to] != c.toStamp)
+            continue;
+        if (!keepsOrientation(c.from, c.to)) continue;
+
+        worstError = std::max(worstError, c.cost);
+        collapse(c.from, c.to);
+    }
+
+    // Out of collapses short of the target: keep what was reached
+    if (next < targetTriangles.size() && (levels.empty() || levels.back().indices.size() > liveTriangles * 3))
+        emit(levels);
+}
+
+}
+
+void simplifyMesh(const std::vector<MeshVertex> &vertices,
+                  const std::vector<unsigned int> &indices,
+                  const std::vector<size_t> &targetTriangles,
+                  std::vector<SimplifiedLevel> &levels) {
+    levels.clear();
+    Simplifier simplifier(vertices, indices);
+    simplifier.run(targetTriangles, levels);
+}
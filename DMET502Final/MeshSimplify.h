@@ -0,0 +1,31 @@
+#ifndef MESHSIMPLIFY_H
+#define MESHSIMPLIFY_H
+
+#include <vector>
+#include "GpuMesh.h"
+
+// One level of detail: triangles over the source vertices and how far
+// the surface moved to get there (RMS distance to the original planes,
+// in model units, worst collapse so far).
+struct SimplifiedLevel {
+    std::vector<unsigned int> indices;
+    float error;
+};
+
+// Quadric error metric simplification (Garland & Heckbert) by half-edge
+// collapse: a vertex only ever moves onto a neighbour, so every level
+// indexes the original vertices. Corners are welded by position first,
+// so UV and normal seams do not tear open; open borders are held in
+// place by extra planes along them. Collapses that would flip a face
+// are refused.
+//
+// Collapses run once, cheapest first, and a level is taken each time
+// the live triangle count reaches the next of `targetTriangles`
+// (descending). Stops early, with fewer levels, when nothing more can
+// be collapsed.
+void simplifyMesh(const std::vector<MeshVertex> &vertices,
+                  const std::vector<unsigned int> &indices,
+                  const std::vector<size_t> &targetTriangles,
+                  std::vector<SimplifiedLevel> &levels);
+
+#endif
@@ -1,101 +1,262 @@
 #include "ObjModel.h"
-#include <fstream>
-#include <sstream>
+#include "ObjParser.h"
+#include "MeshSimplify.h"
+#include <algorithm>
+#include <cmath>
 #include <iostream>
+#include <unordered_map>
 
-bool ObjModel::load(const std::string &path) {
+namespace {
+
+struct CornerKey {
+    int v, t, n;
+    bool operator==(const CornerKey &o) const { return v == o.v && t == o.t && n == o.n; }
+};
+
+struct CornerKeyHash {
+    size_t operator()(const CornerKey &k) const {
+        size_t h = (size_t)k.v * 73856093u;
+        h ^= (size_t)(k.t + 1) * 19349663u;
+        h ^= (size_t)(k.n + 1) * 83492791u;
+        return h;
+    }
+};
+
+// Smallest level worth simplifying down to; below this the draw call
+// costs more than the triangles.
+const size_t MIN_LOD_TRIANGLES = 64;
+
+// One level's triangles over only the vertices they use.
+void compactLevel(const MeshVertex *verts, size_t vertCount, const unsigned int *idx, size_t count,
+                  std::vector<MeshVertex> &outVerts, std::vector<unsigned int> &outIdx) {
+    std::vector<unsigned int> remap(vertCount, ~0u);
+    outVerts.clear();
+    outIdx.resize(count);
+    for (size_t i = 0; i < count; i++) {
+        unsigned int &slot = remap[idx[i]];
+        if (slot == ~0u) {
+            slot = (unsigned int)outVerts.size();
+            outVerts.push_back(verts[idx[i]]);
+        }
+        outIdx[i] = slot;
+    }
+}
+
+}
+
+void ObjModel::reset() {
     vertices.clear();
-    texcoords.clear();
-    normals.clear();
-    faces.clear();
+    indices.clear();
+    baked.close();
+    fromCache = false;
+    for (uint32_t i = 0; i < BAKED_MESH_MAX_LODS; i++) {
+        mesh[i].release();
+        lodIndices[i] = 0;
+        lodError[i] = 0.0f;
+    }
+    numLods = 1;
+    numVertices = numTriangles = 0;
+    for (int k = 0; k < 3; k++) bmin[k] = bmax[k] = 0.0f;
+}
 
-    std::ifstream file(path);
-    if (!file.is_open()) {
+bool ObjModel::load(const std::string &path) {
+    reset();
+
+    if (baked.open(path)) {
+        fromCache = true;
+        numVertices = baked.vertexCount();
+        numTriangles = baked.indexCount() / 3;
+        numLods = (int)baked.lodCount();
+        for (int i = 0; i < numLods; i++) {
+            lodIndices[i] = baked.lodIndexCount(i);
+            lodError[i] = baked.lodError(i);
+        }
+        numTriangles = lodIndices[0] / 3;
+        for (int k = 0; k < 3; k++) {
+            bmin[k] = baked.boundsMin()[k];
+            bmax[k] = baked.boundsMax()[k];
+        }
+        std::cout << "Loaded OBJ: " << path << " from cache ("
+                  << numVertices << " vertices, "
+                  << numTriangles << " triangles, "
+                  << numLods << " levels of detail)" << std::endl;
+        return true;
+    }
+
+    if (!parse(path)) return false;
+    buildLods();
+
+    if (!writeCache(path))
+        std::cout << "WARNING: Could not write mesh cache: " << bakedMeshPath(path) << std::endl;
+    return true;
+}
+
+bool ObjModel::bake(const std::string &path) {
+    reset();
+    if (!parse(path)) return false;
+    buildLods();
+
+    if (!writeCache(path)) {
+        std::cout << "ERROR: Could not write mesh cache: " << bakedMeshPath(path) << std::endl;
+        return false;
+    }
+    std::cout << "Baked " << bakedMeshPath(path) << ":";
+    for (int i = 0; i < numLods; i++)
+        std::cout << (i ? ", " : " ") << lodTriangleCount(i) << " triangles (error " << lodError[i] << ")";
+    std::cout << std::endl;
+    return true;
+}
+
+bool ObjModel::writeCache(const std::string &path) const {
+    std::vector<uint32_t> counts(lodIndices, lodIndices + numLods);
+    std::vector<float> errors(lodError, lodError + numLods);
+    return writeBakedMesh(path, vertices, indices, counts, errors);
+}
+
+// Halves the triangle count per level while each step still removes at
+// least a tenth of them.
+void ObjModel::buildLods() {
+    numLods = 1;
+    lodIndices[0] = (uint32_t)indices.size();
+    lodError[0] = 0.0f;
+
+    std::vector<size_t> targets;
+    for (size_t t = numTriangles / 2; t >= MIN_LOD_TRIANGLES && targets.size() + 1 < BAKED_MESH_MAX_LODS; t /= 2)
+        targets.push_back(t);
+    if (targets.empty()) return;
+
+    std::vector<SimplifiedLevel> levels;
+    simplifyMesh(vertices, indices, targets, levels);
+    for (size_t i = 0; i < levels.size(); i++) {
+        const std::vector<unsigned int> &level = levels[i].indices;
+        if (level.size() * 10 > (size_t)lodIndices[numLods - 1] * 9) break;
+        indices.insert(indices.end(), level.begin(), level.end());
+        lodIndices[numLods] = (uint32_t)level.size();
+        lodError[numLods] = levels[i].error;
+        numLods++;
+    }
+}
+
+bool ObjModel::parse(const std::string &path) {
+    ObjData data;
+    if (!parseObjFile(path, data)) {
         std::cout << "ERROR: Could not open OBJ file: " << path << std::endl;
         return false;
     }
 
-    std::string line;
-    while (std::getline(file, line)) {
-        std::stringstream ss(line);
-        std::string type;
-        ss >> type;
+    std::unordered_map<CornerKey, unsigned int, CornerKeyHash> unique;
+    unique.reserve(data.corners.size());
+    std::vector<bool> needsNormal;
 
-        if (type == "v") {
-            Vertex v;
-            ss >> v.x >> v.y >> v.z;
-            vertices.push_back(v);
+    std::vector<unsigned int> face;
+    for (size_t f = 0; f < data.faceCount(); f++) {
+        face.clear();
+        for (unsigned int c = data.faceStarts[f]; c < data.faceStarts[f + 1]; c++) {
+            const ObjIndex &idx = data.corners[c];
+            CornerKey key = { idx.v, idx.t, idx.n };
+
+            auto found = unique.find(key);
+            if (found != unique.end()) {
+                face.push_back(found->second);
+                continue;
+            }
+
+            MeshVertex mv;
+            const float *p = &data.positions[idx.v * 3];
+            mv.px = p[0]; mv.py = p[1]; mv.pz = p[2];
+            if (idx.n >= 0) {
+                const float *n = &data.normals[idx.n * 3];
+                mv.nx = n[0]; mv.ny = n[1]; mv.nz = n[2];
+            } else {
+                mv.nx = mv.ny = mv.nz = 0.0f;
+            }
+            if (idx.t >= 0) {
+                mv.u = data.texcoords[idx.t * 2];
+                mv.v = data.texcoords[idx.t * 2 + 1];
+            } else {
+                mv.u = mv.v = 0.0f;
+            }
+
+            unsigned int id = (unsigned int)vertices.size();
+            vertices.push_back(mv);
+            needsNormal.push_back(idx.n < 0);
+            unique[key] = id;
+            face.push_back(id);
         }
-        else if (type == "vt") {
-            TexCoord t;
-            ss >> t.u >> t.v;
-            texcoords.push_back(t);
+
+        // Fan-triangulate the polygon
+        for (size_t i = 1; i + 1 < face.size(); i++) {
+            indices.push_back(face[0]);
+            indices.push_back(face[i]);
+            indices.push_back(face[i + 1]);
         }
-        else if (type == "vn") {
-            Normal n;
-            ss >> n.nx >> n.ny >> n.nz;
-            normals.push_back(n);
+    }
+
+    // Corners without a vn get the area-weighted average of their faces
+    for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+        MeshVertex &a = vertices[indices[i]];
+        MeshVertex &b = vertices[indices[i + 1]];
+        MeshVertex &c = vertices[indices[i + 2]];
+        float ux = b.px - a.px, uy = b.py - a.py, uz = b.pz - a.pz;
+        float vx = c.px - a.px, vy = c.py - a.py, vz = c.pz - a.pz;
+        float nx = uy * vz - uz * vy, ny = uz * vx - ux * vz, nz = ux * vy - uy * vx;
+        for (int k = 0; k < 3; k++) {
+            unsigned int id = indices[i + k];
+            if (!needsNormal[id]) continue;
+            vertices[id].nx += nx; vertices[id].ny += ny; vertices[id].nz += nz;
         }
-        else if (type == "f") {
-            Face face;
-            std::string vertData;
-
-            while (ss >> vertData) {
-                int v = 0, t = 0, n = 0;
-                char c;
-
-                std::stringstream vs(vertData);
-
-                if (vertData.find("//") != std::string::npos) {
-                    // format: v//n
-                    vs >> v >> c >> c >> n;
-                } else if (vertData.find("/") != std::string::npos) {
-                    // format: v/t/n OR v/t
-                    if (vertData.find("/") != vertData.rfind("/")) {
-                        // v/t/n
-                        vs >> v >> c >> t >> c >> n;
-                    } else {
-                        // v/t
-                        vs >> v >> c >> t;
-                    }
-                } else {
-                    // format: v
-                    vs >> v;
-                }
-
-                face.vIdx.push_back(v - 1);
-                if (t > 0) face.tIdx.push_back(t - 1);
-                else face.tIdx.push_back(-1);
-                if (n > 0) face.nIdx.push_back(n - 1);
-                else face.nIdx.push_back(-1);
-            }
+    }
+    for (size_t i = 0; i < vertices.size(); i++) {
+        if (!needsNormal[i]) continue;
+        MeshVertex &v = vertices[i];
+        float len = std::sqrt(v.nx * v.nx + v.ny * v.ny + v.nz * v.nz);
+        if (len > 0) { v.nx /= len; v.ny /= len; v.nz /= len; }
+        else v.ny = 1.0f;
+    }
 
-            faces.push_back(face);
+    numVertices = vertices.size();
+    numTriangles = indices.size() / 3;
+
+    for (size_t i = 0; i < vertices.size(); i++) {
+        const float p[3] = { vertices[i].px, vertices[i].py, vertices[i].pz };
+        for (int k = 0; k < 3; k++) {
+            if (i == 0 || p[k] < bmin[k]) bmin[k] = p[k];
+            if (i == 0 || p[k] > bmax[k]) bmax[k] = p[k];
         }
     }
 
     std::cout << "Loaded OBJ: " << path << " ("
-              << vertices.size() << " vertices, "
-              << faces.size() << " faces)" << std::endl;
+              << data.vertexCount() << " vertices, "
+              << data.faceCount() << " faces -> "
+              << numVertices << " unique vertices, "
+              << numTriangles << " triangles)" << std::endl;
 
     return true;
 }
 
-void ObjModel::draw() const {
-    for (const auto &f : faces) {
-        glBegin(GL_POLYGON);
-        for (size_t i = 0; i < f.vIdx.size(); i++) {
-            if (f.nIdx[i] >= 0) {
-                auto &n = normals[f.nIdx[i]];
-                glNormal3f(n.nx, n.ny, n.nz);
-            }
-            if (f.tIdx[i] >= 0) {
-                auto &t = texcoords[f.tIdx[i]];
-                glTexCoord2f(t.u, t.v);
-            }
-            auto &v = vertices[f.vIdx[i]];
-            glVertex3f(v.x, v.y, v.z);
+void ObjModel::draw(int lod) const {
+    if (mesh[0].empty() && numTriangles > 0) {
+        const MeshVertex *v = fromCache ? baked.vertices() : vertices.data();
+        const unsigned int *idx = fromCache ? baked.indices() : indices.data();
+        mesh[0].upload(v, numVertices, idx, lodIndices[0]);
+
+        // Coarser levels use a fraction of the vertices; upload only those
+        std::vector<MeshVertex> levelVerts;
+        std::vector<unsigned int> levelIdx;
+        size_t start = lodIndices[0];
+        for (int i = 1; i < numLods; i++) {
+            compactLevel(v, numVertices, idx + start, lodIndices[i], levelVerts, levelIdx);
+            mesh[i].upload(levelVerts, levelIdx);
+            start += lodIndices[i];
+        }
+        if (fromCache) {
+            baked.close();
+            fromCache = false;
         }
-        glEnd();
+
+        // The GPU now owns the geometry
+        std::vector<MeshVertex>().swap(vertices);
+        std::vector<unsigned int>().swap(indices);
     }
+    mesh[std::max(0, std::min(lod, numLods - 1))].draw();
 }
@@ -3,28 +3,58 @@
 
 #include <vector>
 #include <string>
-#include <GLUT/glut.h>
+#include "GLPlatform.h"
+#include "GpuMesh.h"
+#include "BakedMesh.h"
 
+// OBJ asset flattened at load time into one triangulated, indexed mesh.
+// Each unique (v, vt, vn) corner becomes one vertex; the buffers are
+// uploaded on the first draw and the CPU copies released.
+//
+// load() first tries the binary cache next to the OBJ (see BakedMesh.h)
+// and maps it straight into the upload; on a miss it parses the OBJ and
+// writes a fresh cache for the next launch. Parsing also simplifies the
+// mesh into up to three coarser levels of detail (see MeshSimplify.h),
+// so they are only ever computed at bake time.
 class ObjModel {
 public:
     bool load(const std::string &path);
-    void draw() const;
+    // Parses the OBJ and (re)writes its cache unconditionally.
+    bool bake(const std::string &path);
+    // Level 0 is the full mesh; out of range levels clamp.
+    void draw(int lod = 0) const;
+
+    size_t vertexCount() const { return numVertices; }
+    size_t triangleCount() const { return numTriangles; }
+    int lodCount() const { return numLods; }
+    size_t lodTriangleCount(int lod) const { return lodIndices[lod] / 3; }
+    // How far each level strays from the full mesh, in model units.
+    const float *lodErrors() const { return lodError; }
+    const float *boundsMin() const { return bmin; }
+    const float *boundsMax() const { return bmax; }
 
 private:
-    struct Vertex { float x, y, z; };
-    struct TexCoord { float u, v; };
-    struct Normal { float nx, ny, nz; };
-
-    struct Face {
-        std::vector<int> vIdx;
-        std::vector<int> tIdx;
-        std::vector<int> nIdx;
-    };
-
-    std::vector<Vertex>  vertices;
-    std::vector<TexCoord> texcoords;
-    std::vector<Normal>  normals;
-    std::vector<Face>    faces;
+    bool parse(const std::string &path);
+    void buildLods();
+    bool writeCache(const std::string &path) const;
+    void reset();
+
+    // Upload happens lazily inside draw()
+    mutable std::vector<MeshVertex>   vertices;
+    mutable std::vector<unsigned int> indices;
+    mutable BakedMeshFile baked;
+    mutable bool fromCache = false;
+    mutable GpuMesh mesh[BAKED_MESH_MAX_LODS];
+
+    float bmin[3] = { 0, 0, 0 };
+    float bmax[3] = { 0, 0, 0 };
+
+    size_t numVertices = 0;
+    size_t numTriangles = 0;
+
+    int numLods = 1;
+    uint32_t lodIndices[BAKED_MESH_MAX_LODS] = { 0 };  // per level, back to back in indices
+    float lodError[BAKED_MESH_MAX_LODS] = { 0 };
 };
 
 #endif
@@ -0,0 +1,172 @@
+#include "ObjParser.h"
+#include "MappedFile.h"
+
+namespace {
+
+inline bool isBlank(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+inline bool isDigit(char c) { return c >= '0' && c <= '9'; }
+
+inline const char *skipBlanks(const char *p, const char *end) {
+    while (p < end && isBlank(*p)) p++;
+    return p;
+}
+
+inline const char *nextLine(const char *p, const char *end) {
+    while (p < end && *p != '\n') p++;
+    return p < end ? p + 1 : end;
+}
+
+struct Pow10Table {
+    double v[2 * 308 + 1];
+    Pow10Table() {
+        v[308] = 1.0;
+        for (int i = 1; i <= 308; i++) {
+            v[308 + i] = v[308 + i - 1] * 10.0;
+            v[308 - i] = v[308 - i + 1] / 10.0;
+        }
+    }
+};
+
+double pow10i(int e) {
+    static const Pow10Table table;
+    if (e < -308) return 0.0;
+    if (e > 308) e = 308;
+    return table.v[308 + e];
+}
+
+// Hand-written float scanner; leaves `out` at 0 when no digits follow.
+const char *scanFloat(const char *p, const char *end, float &out) {
+    p = skipBlanks(p, end);
+
+    bool neg = false;
+    if (p < end && (*p == '-' || *p == '+')) { neg = (*p == '-'); p++; }
+
+    double mantissa = 0.0;
+    int exponent = 0;
+    int digits = 0;
+
+    while (p < end && isDigit(*p)) { mantissa = mantissa * 10.0 + (*p - '0'); p++; digits++; }
+    if (p < end && *p == '.') {
+        p++;
+        while (p < end && isDigit(*p)) { mantissa = mantissa * 10.0 + (*p - '0'); exponent--; p++; digits++; }
+    }
+    if (digits > 0 && p < end && (*p == 'e' || *p == 'E')) {
+        p++;
+        bool eneg = false;
+        if (p < end && (*p == '-' || *p == '+')) { eneg = (*p == '-'); p++; }
+        int e = 0;
+        while (p < end && isDigit(*p)) { if (e < 10000) e = e * 10 + (*p - '0'); p++; }
+        exponent += eneg ? -e : e;
+    }
+
+    double v = digits > 0 ? mantissa * pow10i(exponent) : 0.0;
+    out = (float)(neg ? -v : v);
+    return p;
+}
+
+const char *scanInt(const char *p, const char *end, int &out) {
+    bool neg = false;
+    if (p < end && (*p == '-' || *p == '+')) { neg = (*p == '-'); p++; }
+    int v = 0;
+    while (p < end && isDigit(*p)) { v = v * 10 + (*p - '0'); p++; }
+    out = neg ? -v : v;
+    return p;
+}
+
+// OBJ indices are 1-based; negative values count back from the end.
+inline int resolveIndex(int idx, size_t count) {
+    if (idx > 0) return idx - 1;
+    if (idx < 0) return (int)count + idx;
+    return -1;
+}
+
+}
+
+void ObjData::clear() {
+    positions.clear();
+    texcoords.clear();
+    normals.clear();
+    corners.clear();
+    faceStarts.clear();
+}
+
+bool parseObjBuffer(const char *p, const char *end, ObjData &out) {
+    out.clear();
+    out.faceStarts.push_back(0);
+
+    while (p < end) {
+        p = skipBlanks(p, end);
+        if (p >= end) break;
+
+        if (p + 1 < end && p[0] == 'v' && isBlank(p[1])) {
+            float x, y, z;
+            p = scanFloat(p + 1, end, x);
+            p = scanFloat(p, end, y);
+            p = scanFloat(p, end, z);
+            out.positions.push_back(x);
+            out.positions.push_back(y);
+            out.positions.push_back(z);
+        }
+        else if (p + 2 < end && p[0] == 'v' && p[1] == 't' && isBlank(p[2])) {
+            float u, v;
+            p = scanFloat(p + 2, end, u);
+            p = scanFloat(p, end, v);
+            out.texcoords.push_back(u);
+            out.texcoords.push_back(v);
+        }
+        else if (p + 2 < end && p[0] == 'v' && p[1] == 'n' && isBlank(p[2])) {
+            float x, y, z;
+            p = scanFloat(p + 2, end, x);
+            p = scanFloat(p, end, y);
+            p = scanFloat(p, end, z);
+            out.normals.push_back(x);
+            out.normals.push_back(y);
+            out.normals.push_back(z);
+        }
+        else if (p + 1 < end && p[0] == 'f' && isBlank(p[1])) {
+            size_t vCount = out.positions.size() / 3;
+            size_t tCount = out.texcoords.size() / 2;
+            size_t nCount = out.normals.size() / 3;
+
+            p++;
+            while (true) {
+                p = skipBlanks(p, end);
+                if (p >= end || *p == '\n' || *p == '#') break;
+
+                int v = 0, t = 0, n = 0;
+                p = scanInt(p, end, v);
+                if (p < end && *p == '/') {
+                    p++;
+                    if (p < end && *p != '/') p = scanInt(p, end, t);
+                    if (p < end && *p == '/') p = scanInt(p + 1, end, n);
+                }
+                // Skip anything unexpected inside the token
+                while (p < end && !isBlank(*p) && *p != '\n') p++;
+
+                ObjIndex c = { resolveIndex(v, vCount), resolveIndex(t, tCount), resolveIndex(n, nCount) };
+                if (c.v >= 0 && c.v < (int)vCount) {
+                    if (c.t < 0 || c.t >= (int)tCount) c.t = -1;
+                    if (c.n < 0 || c.n >= (int)nCount) c.n = -1;
+                    out.corners.push_back(c);
+                }
+            }
+
+            unsigned int start = out.faceStarts.back();
+            unsigned int count = (unsigned int)out.corners.size() - start;
+            if (count >= 3) out.faceStarts.push_back((unsigned int)out.corners.size());
+            else out.corners.resize(start);
+        }
+
+        p = nextLine(p, end);
+    }
+    return true;
+}
+
+bool parseObjFile(const std::string &path, ObjData &out) {
+    MappedFile file;
+    if (!file.open(path)) {
+        out.clear();
+        return false;
+    }
+    return parseObjBuffer(file.data(), file.data() + file.size(), out);
+}
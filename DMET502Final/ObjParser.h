@@ -0,0 +1,29 @@
+#ifndef OBJPARSER_H
+#define OBJPARSER_H
+
+#include <vector>
+#include <string>
+
+// One face corner; indices are 0-based, -1 when the attribute is absent.
+struct ObjIndex { int v, t, n; };
+
+// Raw OBJ contents. Faces are stored back to back in `corners`;
+// face i spans [faceStarts[i], faceStarts[i+1]).
+struct ObjData {
+    std::vector<float> positions;   // x y z
+    std::vector<float> texcoords;   // u v
+    std::vector<float> normals;     // x y z
+    std::vector<ObjIndex> corners;
+    std::vector<unsigned int> faceStarts;
+
+    size_t vertexCount() const { return positions.size() / 3; }
+    size_t faceCount() const { return faceStarts.empty() ? 0 : faceStarts.size() - 1; }
+    void clear();
+};
+
+// Memory-maps the file and parses it in place (v/vt/vn, n-gon faces,
+// negative relative indices). No per-line allocations.
+bool parseObjFile(const std::string &path, ObjData &out);
+bool parseObjBuffer(const char *begin, const char *end, ObjData &out);
+
+#endif
@@ -0,0 +1,107 @@
+#include "OverlapKernels.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define OVERLAP_X86 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+size_t overlapsScalar(const float *x, const float *z, const float *r, size_t count,
+                      float px, float pz, float pr, int base, int *out) {
+    size_t n = 0;
+    for (size_t i = 0; i < count; i++) {
+        float dx = px - x[i], dz = pz - z[i], s = pr + r[i];
+        if (dx * dx + dz * dz < s * s) out[n++] = base + (int)i;
+    }
+    return n;
+}
+
+#ifdef OVERLAP_X86
+size_t overlapsSSE2(const float *x, const float *z, const float *r, size_t count,
+                    float px, float pz, float pr, int base, int *out) {
+    const __m128 PX = _mm_set1_ps(px), PZ = _mm_set1_ps(pz), PR = _mm_set1_ps(pr);
+    size_t n = 0, i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128 dx = _mm_sub_ps(PX, _mm_loadu_ps(x + i));
+        __m128 dz = _mm_sub_ps(PZ, _mm_loadu_ps(z + i));
+        __m128 s  = _mm_add_ps(PR, _mm_loadu_ps(r + i));
+        __m128 d2 = _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dz, dz));
+        int mask = _mm_movemask_ps(_mm_cmplt_ps(d2, _mm_mul_ps(s, s)));
+        while (mask) {
+            out[n++] = base + (int)i + __builtin_ctz(mask);
+            mask &= mask - 1;
+        }
+    }
+    return n + overlapsScalar(x + i, z + i, r + i, count - i, px, pz, pr, base + (int)i, out + n);
+}
+
+__attribute__((target("avx2")))
+size_t overlapsAVX2(const float *x, const float *z, const float *r, size_t count,
+                    float px, float pz, float pr, int base, int *out) {
+    const __m256 PX = _mm256_set1_ps(px), PZ = _mm256_set1_ps(pz), PR = _mm256_set1_ps(pr);
+    size_t n = 0, i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256 dx = _mm256_sub_ps(PX, _mm256_loadu_ps(x + i));
+        __m256 dz = _mm256_sub_ps(PZ, _mm256_loadu_ps(z + i));
+        __m256 s  = _mm256_add_ps(PR, _mm256_loadu_ps(r + i));
+        __m256 d2 = _mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dz, dz));
+        int mask = _mm256_movemask_ps(_mm256_cmp_ps(d2, _mm256_mul_ps(s, s), _CMP_LT_OQ));
+        while (mask) {
+            out[n++] = base + (int)i + __builtin_ctz(mask);
+            mask &= mask - 1;
+        }
+    }
+    return n + overlapsSSE2(x + i, z + i, r + i, count - i, px, pz, pr, base + (int)i, out + n);
+}
+#endif
+
+SimdLevel detectSimdLevel() {
+#ifdef OVERLAP_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return SIMD_AVX2;
+    return SIMD_SSE2;
+#else
+    return SIMD_SCALAR;
+#endif
+}
+
+SimdLevel &currentLevel() {
+    static SimdLevel level = detectSimdLevel();
+    return level;
+}
+
+}
+
+SimdLevel bestSimdLevel() {
+    static SimdLevel best = detectSimdLevel();
+    return best;
+}
+
+SimdLevel activeSimdLevel() {
+    return currentLevel();
+}
+
+void setSimdLevel(SimdLevel level) {
+    currentLevel() = level > bestSimdLevel() ? bestSimdLevel() : level;
+}
+
+const char *simdLevelName(SimdLevel level) {
+    switch (level) {
+    case SIMD_AVX2: return "AVX2";
+    case SIMD_SSE2: return "SSE2";
+    default:        return "scalar";
+    }
+}
+
+size_t findOverlaps(const float *x, const float *z, const float *r, size_t count,
+                    float px, float pz, float pr, int base, int *out) {
+#ifdef OVERLAP_X86
+    switch (currentLevel()) {
+    case SIMD_AVX2: return overlapsAVX2(x, z, r, count, px, pz, pr, base, out);
+    case SIMD_SSE2: return overlapsSSE2(x, z, r, count, px, pz, pr, base, out);
+    default: break;
+    }
+#endif
+    return overlapsScalar(x, z, r, count, px, pz, pr, base, out);
+}
@@ -0,0 +1,27 @@
+#ifndef OVERLAPKERNELS_H
+#define OVERLAPKERNELS_H
+
+#include <cstddef>
+
+// XZ circle-overlap tests over structure-of-arrays columns. Every path
+// compares squared distance against the squared radius sum, so none
+// needs a sqrt and all of them agree bit for bit.
+enum SimdLevel {
+    SIMD_SCALAR = 0,
+    SIMD_SSE2   = 1,
+    SIMD_AVX2   = 2
+};
+
+SimdLevel bestSimdLevel();
+SimdLevel activeSimdLevel();
+// Clamped to what the CPU supports; used by benchmarks to compare paths.
+void setSimdLevel(SimdLevel level);
+const char *simdLevelName(SimdLevel level);
+
+// Tests entities [0, count) against the circle (px, pz, pr) and writes
+// `base + i` for each overlap to out (room for `count` entries). Returns
+// the number written, in ascending order.
+size_t findOverlaps(const float *x, const float *z, const float *r, size_t count,
+                    float px, float pz, float pr, int base, int *out);
+
+#endif
@@ -0,0 +1,187 @@
+#include "PrimitiveMeshes.h"
+#include <cmath>
+#include <map>
+#include <memory>
+
+namespace {
+
+const float PI = 3.14159265358979f;
+
+typedef std::map<unsigned long long, std::unique_ptr<PrimitiveMesh> > PrimitiveMap;
+
+PrimitiveMap &cache() {
+    static PrimitiveMap meshes;
+    return meshes;
+}
+
+unsigned long long makeKey(PrimitiveShape shape, int slices, int stacks) {
+    return ((unsigned long long)shape << 48) |
+           ((unsigned long long)(unsigned int)slices << 24) |
+           (unsigned long long)(unsigned int)stacks;
+}
+
+MeshVertex makeVertex(float x, float y, float z, float nx, float ny, float nz, float u, float v) {
+    MeshVertex mv = { x, y, z, nx, ny, nz, u, v };
+    return mv;
+}
+
+}
+
+void tessellateSphere(int slices, int stacks, PrimitiveGeometry &out) {
+    out.verts.clear();
+    out.indices.clear();
+    if (slices < 3) slices = 3;
+    if (stacks < 2) stacks = 2;
+
+    for (int i = 0; i <= stacks; i++) {
+        float theta = PI * i / stacks;
+        float st = std::sin(theta), ct = std::cos(theta);
+        for (int j = 0; j <= slices; j++) {
+            float phi = 2.0f * PI * j / slices;
+            float x = std::sin(phi) * st;
+            float y = std::cos(phi) * st;
+            float z = ct;
+            out.verts.push_back(makeVertex(x, y, z, x, y, z,
+                                           1.0f - float(j) / slices,
+                                           1.0f - float(i) / stacks));
+        }
+    }
+
+    unsigned int row = slices + 1;
+    for (int i = 0; i < stacks; i++) {
+        for (int j = 0; j < slices; j++) {
+            unsigned int a = i * row + j;
+            unsigned int b = a + row;
+            // Skip the degenerate triangle at each pole
+            if (i != 0) {
+                out.indices.push_back(a);
+                out.indices.push_back(a + 1);
+                out.indices.push_back(b);
+            }
+            if (i != stacks - 1) {
+                out.indices.push_back(a + 1);
+                out.indices.push_back(b + 1);
+                out.indices.push_back(b);
+            }
+        }
+    }
+}
+
+void tessellateCone(int slices, int stacks, PrimitiveGeometry &out) {
+    out.verts.clear();
+    out.indices.clear();
+    if (slices < 3) slices = 3;
+    if (stacks < 1) stacks = 1;
+
+    // Side normal of a cone with base 1 and height 1
+    const float ns = 1.0f / std::sqrt(2.0f);
+
+    for (int i = 0; i <= stacks; i++) {
+        float t = float(i) / stacks;
+        float r = 1.0f - t;
+        for (int j = 0; j <= slices; j++) {
+            float phi = 2.0f * PI * j / slices;
+            float c = std::cos(phi), s = std::sin(phi);
+            out.verts.push_back(makeVertex(c * r, s * r, t, c * ns, s * ns, ns,
+                                           float(j) / slices, t));
+        }
+    }
+
+    unsigned int row = slices + 1;
+    for (int i = 0; i < stacks; i++) {
+        for (int j = 0; j < slices; j++) {
+            unsigned int a = i * row + j;
+            unsigned int b = a + row;
+            out.indices.push_back(a);
+            out.indices.push_back(a + 1);
+            out.indices.push_back(b + 1);
+            if (i != stacks - 1) {
+                out.indices.push_back(a);
+                out.indices.push_back(b + 1);
+                out.indices.push_back(b);
+            }
+        }
+    }
+
+    // Base disk facing -Z
+    unsigned int center = (unsigned int)out.verts.size();
+    out.verts.push_back(makeVertex(0, 0, 0, 0, 0, -1, 0.5f, 0.5f));
+    for (int j = 0; j <= slices; j++) {
+        float phi = 2.0f * PI * j / slices;
+        float c = std::cos(phi), s = std::sin(phi);
+        out.verts.push_back(makeVertex(c, s, 0, 0, 0, -1, 0.5f + 0.5f * c, 0.5f + 0.5f * s));
+    }
+    for (int j = 0; j < slices; j++) {
+        out.indices.push_back(center);
+        out.indices.push_back(center + 2 + j);
+        out.indices.push_back(center + 1 + j);
+    }
+}
+
+void tessellateOctahedron(PrimitiveGeometry &out) {
+    out.verts.clear();
+    out.indices.clear();
+
+    for (int f = 0; f < 8; f++) {
+        float sx = (f & 1) ? -1.0f : 1.0f;
+        float sy = (f & 2) ? -1.0f : 1.0f;
+        float sz = (f & 4) ? -1.0f : 1.0f;
+        float n = 1.0f / std::sqrt(3.0f);
+
+        MeshVertex a = makeVertex(sx, 0, 0, sx * n, sy * n, sz * n, sx, 0);
+        MeshVertex b = makeVertex(0, sy, 0, sx * n, sy * n, sz * n, 0, sy);
+        MeshVertex c = makeVertex(0, 0, sz, sx * n, sy * n, sz * n, 0, 0);
+
+        // Keep counter-clockwise winding seen from outside
+        unsigned int base = (unsigned int)out.verts.size();
+        out.verts.push_back(a);
+        if (sx * sy * sz > 0) { out.verts.push_back(b); out.verts.push_back(c); }
+        else                  { out.verts.push_back(c); out.verts.push_back(b); }
+        out.indices.push_back(base);
+        out.indices.push_back(base + 1);
+        out.indices.push_back(base + 2);
+    }
+}
+
+const PrimitiveMesh &primitiveMesh(PrimitiveShape shape, int slices, int stacks) {
+    if (shape == PRIM_OCTAHEDRON) slices = stacks = 0;
+
+    unsigned long long key = makeKey(shape, slices, stacks);
+    PrimitiveMap &meshes = cache();
+    PrimitiveMap::iterator it = meshes.find(key);
+    if (it != meshes.end()) return *it->second;
+
+    std::unique_ptr<PrimitiveMesh> mesh(new PrimitiveMesh());
+    switch (shape) {
+        case PRIM_SPHERE:     tessellateSphere(slices, stacks, mesh->cpu); break;
+        case PRIM_CONE:       tessellateCone(slices, stacks, mesh->cpu); break;
+        case PRIM_OCTAHEDRON: tessellateOctahedron(mesh->cpu); break;
+    }
+    mesh->gpu.upload(mesh->cpu.verts, mesh->cpu.indices);
+
+    PrimitiveMesh &ref = *mesh;
+    meshes[key] = std::move(mesh);
+    return ref;
+}
+
+void releasePrimitiveMeshes() {
+    cache().clear();
+}
+
+void drawSphere(float radius, int slices, int stacks) {
+    glPushMatrix();
+    glScalef(radius, radius, radius);
+    primitiveMesh(PRIM_SPHERE, slices, stacks).gpu.draw();
+    glPopMatrix();
+}
+
+void drawCone(float base, float height, int slices, int stacks) {
+    glPushMatrix();
+    glScalef(base, base, height);
+    primitiveMesh(PRIM_CONE, slices, stacks).gpu.draw();
+    glPopMatrix();
+}
+
+void drawOctahedron() {
+    primitiveMesh(PRIM_OCTAHEDRON).gpu.draw();
+}
@@ -0,0 +1,42 @@
+#ifndef PRIMITIVEMESHES_H
+#define PRIMITIVEMESHES_H
+
+#include <vector>
+#include "GpuMesh.h"
+
+// CPU-tessellated replacements for gluSphere / glutSolidSphere /
+// glutSolidCone / glutSolidOctahedron. Each (shape, slices, stacks) is
+// built once as a unit-sized mesh and shared by every caller.
+enum PrimitiveShape {
+    PRIM_SPHERE,
+    PRIM_CONE,
+    PRIM_OCTAHEDRON
+};
+
+struct PrimitiveGeometry {
+    std::vector<MeshVertex> verts;
+    std::vector<unsigned int> indices;
+};
+
+struct PrimitiveMesh {
+    PrimitiveGeometry cpu;
+    GpuMesh gpu;
+};
+
+// Unit sphere around the origin, poles on Z (gluSphere layout and UVs).
+void tessellateSphere(int slices, int stacks, PrimitiveGeometry &out);
+// Unit cone: base disk of radius 1 at z=0, apex at z=1 (glutSolidCone layout).
+void tessellateCone(int slices, int stacks, PrimitiveGeometry &out);
+// Flat-shaded octahedron with vertices on the unit axes.
+void tessellateOctahedron(PrimitiveGeometry &out);
+
+// Returns the cached mesh, tessellating and uploading it on first use.
+const PrimitiveMesh &primitiveMesh(PrimitiveShape shape, int slices = 0, int stacks = 0);
+void releasePrimitiveMeshes();
+
+// Drop-in draw helpers (scale the unit mesh; GL_NORMALIZE keeps lighting right).
+void drawSphere(float radius, int slices, int stacks);
+void drawCone(float base, float height, int slices, int stacks);
+void drawOctahedron();
+
+#endif
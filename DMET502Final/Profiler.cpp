@@ -0,0 +1,357 @@
+#include "Profiler.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <fstream>
+
+Profiler profiler;
+
+// macOS legacy contexts only expose the EXT timer query
+#ifdef __APPLE__
+#define GL_TIME_ELAPSED GL_TIME_ELAPSED_EXT
+#define glGetQueryObjectui64v glGetQueryObjectui64vEXT
+typedef GLuint64EXT GpuNanoseconds;
+#else
+typedef GLuint64 GpuNanoseconds;
+#endif
+
+namespace {
+
+thread_local int profilerThread = -1;
+
+const int GPU_THREAD = -1;
+
+void drawText(float x, float y, const std::string &text) {
+    glRasterPos2f(x, y);
+    for (char c : text) glutBitmapCharacter(GLUT_BITMAP_HELVETICA_12, c);
+}
+
+std::string formatMs(double seconds) {
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%6.2f", seconds * 1000.0);
+    return buf;
+}
+
+void writeJsonString(std::ostream &out, const std::string &s) {
+    out << '"';
+    for (char c : s) {
+        if (c == '"' || c == '\\') out << '\\';
+        out << c;
+    }
+    out << '"';
+}
+
+}
+
+// =======================================================
+// RECORDING
+// =======================================================
+Profiler::Profiler()
+    : enabled(false), frameCount(0), frameStart(0), frameOpen(false),
+      gpuSupport(-1), gpuSlot(0), gpuActive(false) {
+    for (int i = 0; i < HISTORY; i++) frameHistory[i] = 0;
+}
+
+double Profiler::secondsNow() {
+    using namespace std::chrono;
+    return duration<double>(steady_clock::now().time_since_epoch()).count();
+}
+
+// Caller holds `lock`.
+int Profiler::threadId() {
+    if (profilerThread < 0) {
+        profilerThread = (int)threadNames.size();
+        threadNames.push_back("thread " + std::to_string(profilerThread));
+    }
+    return profilerThread;
+}
+
+// Caller holds `lock`. Few zones, so a linear scan on the literal's address.
+Profiler::Zone &Profiler::zone(const char *name) {
+    for (size_t i = 0; i < zones.size(); i++)
+        if (zones[i].name == name) return zones[i];
+    zones.push_back(Zone());
+    Zone &z = zones.back();
+    z.name = name;
+    z.cpuFrame = z.gpuFrame = 0;
+    for (int i = 0; i < HISTORY; i++) z.cpuHistory[i] = z.gpuHistory[i] = 0;
+    return z;
+}
+
+void Profiler::nameThread(const char *name) {
+    std::lock_guard<std::mutex> guard(lock);
+    threadNames[threadId()] = name;
+}
+
+void Profiler::record(const char *name, double start, double end) {
+    if (!isEnabled()) return;
+    std::lock_guard<std::mutex> guard(lock);
+    Event e = { name, start, end - start, threadId() };
+    events.push_back(e);
+    if (events.size() > MAX_EVENTS) events.pop_front();
+    zone(name).cpuFrame += end - start;
+}
+
+void Profiler::beginFrame() {
+    if (!isEnabled()) {
+        // Pending results would land in the zones as stale GPU time once
+        // recording resumes
+        discardGpu();
+        frameOpen = false;
+        return;
+    }
+
+    // The slot about to be reused was filled GPU_LATENCY frames ago
+    gpuSlot = (gpuSlot + 1) % GPU_LATENCY;
+    collectGpu(gpuSlots[gpuSlot]);
+
+    double now = secondsNow();
+    std::lock_guard<std::mutex> guard(lock);
+    if (frameOpen) {
+        int h = frameCount % HISTORY;
+        frameHistory[h] = now - frameStart;
+        for (size_t i = 0; i < zones.size(); i++) {
+            zones[i].cpuHistory[h] = zones[i].cpuFrame;
+            zones[i].gpuHistory[h] = zones[i].gpuFrame;
+        }
+        frameCount++;
+    }
+    for (size_t i = 0; i < zones.size(); i++) zones[i].cpuFrame = zones[i].gpuFrame = 0;
+    frameStart = now;
+    frameOpen = true;
+}
+
+// =======================================================
+// GPU TIMER QUERIES
+// =======================================================
+bool Profiler::gpuTimersSupported() {
+    if (gpuSupport >= 0) return gpuSupport == 1;
+
+    // Timer queries are core since GL 3.3.
+    const char *version = (const char *)glGetString(GL_VERSION);
+    int major = 0, minor = 0;
+    if (version) sscanf(version, "%d.%d", &major, &minor);
+
+    bool ok = major > 3 || (major == 3 && minor >= 3);
+    if (!ok) {
+        const char *ext = (const char *)glGetString(GL_EXTENSIONS);
+        ok = ext && (strstr(ext, "GL_ARB_timer_query") || strstr(ext, "GL_EXT_timer_query"));
+    }
+    gpuSupport = ok ? 1 : 0;
+    if (!ok) std::cout << "Profiler: no GL timer queries, GPU zones disabled\n";
+    return ok;
+}
+
+bool Profiler::beginGpu(const char *name) {
+    if (!isEnabled() || gpuActive || !gpuTimersSupported()) return false;
+
+    GLuint query;
+    if (!freeQueries.empty()) {
+        query = freeQueries.back();
+        freeQueries.pop_back();
+    } else {
+        glGenQueries(1, &query);
+    }
+    GpuQuery q = { name, query, secondsNow() };
+    gpuSlots[gpuSlot].push_back(q);
+    glBeginQuery(GL_TIME_ELAPSED, query);
+    gpuActive = true;
+    return true;
+}
+
+void Profiler::endGpu() {
+    if (!gpuActive) return;
+    glEndQuery(GL_TIME_ELAPSED);
+    gpuActive = false;
+}
+
+void Profiler::collectGpu(std::vector<GpuQuery> &slot) {
+    if (slot.empty()) return;
+    std::vector<double> seconds(slot.size());
+    for (size_t i = 0; i < slot.size(); i++) {
+        // Several frames old, so this does not wait on the GPU
+        GpuNanoseconds ns = 0;
+        glGetQueryObjectui64v(slot[i].query, GL_QUERY_RESULT, &ns);
+        seconds[i] = ns * 1e-9;
+        freeQueries.push_back(slot[i].query);
+    }
+
+    std::lock_guard<std::mutex> guard(lock);
+    for (size_t i = 0; i < slot.size(); i++) {
+        // Placed at the CPU submit time; close enough to line up in a trace
+        Event e = { slot[i].name, slot[i].cpuStart, seconds[i], GPU_THREAD };
+        events.push_back(e);
+        if (events.size() > MAX_EVENTS) events.pop_front();
+        zone(slot[i].name).gpuFrame += seconds[i];
+    }
+    slot.clear();
+}
+
+// Returns every pending query to the pool unread. A query still open
+// (recording stopped inside a GPU zone) waits for the next frame.
+void Profiler::discardGpu() {
+    if (gpuActive) return;
+    for (int i = 0; i < GPU_LATENCY; i++) {
+        for (size_t k = 0; k < gpuSlots[i].size(); k++) freeQueries.push_back(gpuSlots[i][k].query);
+        gpuSlots[i].clear();
+    }
+}
+
+// =======================================================
+// OVERLAY
+// Frame-time graph (one bar per frame, lines at 60 and 30 fps),
+// frame-time percentiles and per-zone CPU / GPU averages.
+// =======================================================
+void Profiler::drawOverlay(int screenW, int screenH) {
+    const float graphH = 90.0f, scale = graphH / 0.0333f;   // 33 ms = full height
+    const float width = HISTORY + 220.0f;
+
+    std::vector<double> frames;
+    std::vector<std::string> lines;
+    std::vector<float> bars;
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        int n = std::min(frameCount, (int)HISTORY);
+        for (int i = 0; i < n; i++) frames.push_back(frameHistory[(frameCount - n + i) % HISTORY]);
+        bars.assign(frames.begin(), frames.end());
+
+        for (size_t z = 0; z < zones.size(); z++) {
+            double cpu = 0, gpu = 0;
+            for (int i = 0; i < n; i++) {
+                int h = (frameCount - n + i) % HISTORY;
+                cpu += zones[z].cpuHistory[h];
+                gpu += zones[z].gpuHistory[h];
+            }
+            std::string line = zones[z].name;
+            line += "  cpu " + formatMs(n ? cpu / n : 0) + " ms";
+            if (gpu > 0) line += "  gpu " + formatMs(gpu / n) + " ms";
+            lines.push_back(line);
+        }
+    }
+
+    double avg = 0;
+    for (double f : frames) avg += f;
+    if (!frames.empty()) avg /= frames.size();
+    std::vector<double> sorted(frames);
+    std::sort(sorted.begin(), sorted.end());
+    std::string summary = "frame " + formatMs(avg) + " ms";
+    if (!sorted.empty()) {
+        size_t last = sorted.size() - 1;
+        summary += "  p50 " + formatMs(sorted[last / 2]) +
+                   "  p95 " + formatMs(sorted[last * 95 / 100]) +
+                   "  p99 " + formatMs(sorted[last * 99 / 100]);
+    }
+
+    float x0 = screenW - width - 10.0f;
+    float top = screenH - 10.0f;
+    float height = graphH + 30.0f + 14.0f * (lines.size() + 1);
+    float y0 = top - height;
+
+    glPushAttrib(GL_ENABLE_BIT | GL_CURRENT_BIT);
+    glDisable(GL_LIGHTING);
+    glDisable(GL_TEXTURE_2D);
+    glDisable(GL_DEPTH_TEST);
+    glDisable(GL_FOG);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    glColor4f(0.0f, 0.0f, 0.0f, 0.6f);
+    glBegin(GL_QUADS);
+    glVertex2f(x0, y0); glVertex2f(x0 + width, y0);
+    glVertex2f(x0 + width, top); glVertex2f(x0, top);
+    glEnd();
+
+    // Graph, newest frame on the right
+    float gx = x0 + 10.0f, gy = top - 10.0f - graphH;
+    glBegin(GL_LINES);
+    for (size_t i = 0; i < bars.size(); i++) {
+        float ms = bars[i] * 1000.0f;
+        if (ms < 17.0f) glColor3f(0.3f, 0.9f, 0.3f);
+        else if (ms < 34.0f) glColor3f(0.95f, 0.8f, 0.2f);
+        else glColor3f(0.95f, 0.3f, 0.2f);
+        float x = gx + (HISTORY - bars.size()) + i;
+        glVertex2f(x, gy);
+        glVertex2f(x, gy + std::min(graphH, bars[i] * scale));
+    }
+    glColor4f(1.0f, 1.0f, 1.0f, 0.5f);
+    glVertex2f(gx, gy + 0.01667f * scale); glVertex2f(gx + HISTORY, gy + 0.01667f * scale);
+    glVertex2f(gx, gy + 0.0333f * scale);  glVertex2f(gx + HISTORY, gy + 0.0333f * scale);
+    glEnd();
+
+    glColor3f(1, 1, 1);
+    drawText(gx + HISTORY + 8.0f, gy + graphH - 12.0f, "33 ms");
+    drawText(gx + HISTORY + 8.0f, gy + graphH * 0.5f - 4.0f, "17 ms");
+
+    float ty = gy - 18.0f;
+    drawText(gx, ty, summary);
+    for (size_t i = 0; i < lines.size(); i++) {
+        ty -= 14.0f;
+        drawText(gx, ty, lines[i]);
+    }
+
+    glPopAttrib();
+}
+
+// =======================================================
+// CHROME TRACE EXPORT
+// Complete ("X") events in microseconds; GPU zones get their own track.
+// =======================================================
+bool Profiler::writeChromeTrace(const std::string &path) {
+    std::vector<Event> copy;
+    std::vector<std::string> names;
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        copy.assign(events.begin(), events.end());
+        names = threadNames;
+    }
+
+    std::ofstream out(path.c_str());
+    if (!out) {
+        std::cout << "ERROR: Cannot write trace file: " << path << "\n";
+        return false;
+    }
+
+    double origin = copy.empty() ? 0.0 : copy.front().start;
+    for (const Event &e : copy) origin = std::min(origin, e.start);
+
+    // Thread-name metadata first (the GPU track last), then the zones
+    const int gpuTrack = (int)names.size();
+    out << "{\"traceEvents\":[\n";
+    for (size_t t = 0; t <= names.size(); t++) {
+        out << (t ? ",\n" : "") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << t
+            << ",\"args\":{\"name\":";
+        writeJsonString(out, t < names.size() ? names[t] : std::string("GPU"));
+        out << "}}";
+    }
+    char buf[64];
+    for (const Event &e : copy) {
+        out << ",\n{\"name\":";
+        writeJsonString(out, e.name);
+        snprintf(buf, sizeof(buf), ",\"ts\":%.3f,\"dur\":%.3f", (e.start - origin) * 1e6, e.duration * 1e6);
+        out << ",\"cat\":\"" << (e.thread == GPU_THREAD ? "gpu" : "cpu") << "\",\"ph\":\"X\"" << buf
+            << ",\"pid\":1,\"tid\":" << (e.thread == GPU_THREAD ? gpuTrack : e.thread) << "}";
+    }
+    out << "\n]}\n";
+
+    std::cout << "Wrote " << copy.size() << " profiler events to " << path << "\n";
+    return true;
+}
+
+// =======================================================
+// PROFILE SCOPE
+// =======================================================
+ProfileScope::ProfileScope(const char *zoneName, bool gpu)
+    : name(zoneName), start(0), active(profiler.isEnabled()), gpuActive(false) {
+    if (!active) return;
+    if (gpu) gpuActive = profiler.beginGpu(name);
+    start = Profiler::secondsNow();
+}
+
+ProfileScope::~ProfileScope() {
+    if (!active) return;
+    double end = Profiler::secondsNow();
+    if (gpuActive) profiler.endGpu();
+    profiler.record(name, start, end);
+}
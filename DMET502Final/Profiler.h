@@ -0,0 +1,114 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <vector>
+#include <deque>
+#include <string>
+#include <mutex>
+#include <atomic>
+#include "GLPlatform.h"
+
+// Frame profiler. CPU zones are recorded from any thread (GL, simulation,
+// job workers); GPU zones use GL timer queries on the GL thread where the
+// driver supports them, read back a few frames later so they never stall.
+// Per-zone averages, a frame-time graph and percentiles are drawn as an
+// overlay; the raw events export to Chrome's trace format
+// (chrome://tracing or ui.perfetto.dev).
+//
+// Zone names must be string literals (or otherwise outlive the profiler).
+// Recording is off until setEnabled(true); a disabled scope costs one
+// atomic load.
+class Profiler {
+public:
+    Profiler();
+
+    void setEnabled(bool on) { enabled = on; }
+    bool isEnabled() const { return enabled.load(std::memory_order_relaxed); }
+
+    // Names the calling thread in traces; unnamed threads get "thread N".
+    void nameThread(const char *name);
+
+    // Any thread. Times are seconds from secondsNow().
+    void record(const char *name, double start, double end);
+
+    // GL thread. Starts a new frame and collects finished GPU timings.
+    void beginFrame();
+
+    // GL thread. GPU zones may not nest: beginGpu() returns false (and
+    // the zone is not timed) while another is open.
+    bool beginGpu(const char *name);
+    void endGpu();
+
+    // GL thread; expects a pixel-space ortho projection.
+    void drawOverlay(int screenW, int screenH);
+
+    bool writeChromeTrace(const std::string &path);
+
+    static double secondsNow();
+
+private:
+    enum { HISTORY = 240, GPU_LATENCY = 4, MAX_EVENTS = 1 << 20 };
+
+    struct Event {
+        const char *name;
+        double start, duration;
+        int thread;             // -1 = GPU
+    };
+
+    struct Zone {
+        const char *name;
+        double cpuFrame, gpuFrame;          // this frame so far
+        double cpuHistory[HISTORY];
+        double gpuHistory[HISTORY];
+    };
+
+    struct GpuQuery {
+        const char *name;
+        GLuint query;
+        double cpuStart;
+    };
+
+    Profiler(const Profiler &);
+    Profiler &operator=(const Profiler &);
+
+    int threadId();
+    Zone &zone(const char *name);
+    void collectGpu(std::vector<GpuQuery> &slot);
+    void discardGpu();
+    bool gpuTimersSupported();
+
+    std::atomic<bool> enabled;
+
+    std::mutex lock;                    // guards everything below except GPU state
+    std::deque<Event> events;
+    std::vector<Zone> zones;
+    std::vector<std::string> threadNames;
+    double frameHistory[HISTORY];
+    int frameCount;                     // frames recorded into the histories
+    double frameStart;
+    bool frameOpen;                     // beginFrame() ran while enabled
+
+    // GL thread only
+    int gpuSupport;                     // -1 unknown, 0 no, 1 yes
+    std::vector<GpuQuery> gpuSlots[GPU_LATENCY];
+    int gpuSlot;
+    std::vector<GLuint> freeQueries;
+    bool gpuActive;
+};
+
+extern Profiler profiler;
+
+// Times the enclosing block as a CPU zone, and as a GPU zone too when
+// `gpu` is set (GL thread only).
+class ProfileScope {
+public:
+    explicit ProfileScope(const char *zoneName, bool gpu = false);
+    ~ProfileScope();
+
+private:
+    const char *name;
+    double start;
+    bool active, gpuActive;
+};
+
+#endif
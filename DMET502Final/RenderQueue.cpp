@@ -0,0 +1,198 @@
+#include "RenderQueue.h"
+#include "GLStateCache.h"
+#include "Lighting.h"
+#include "Profiler.h"
+#include <cstring>
+
+RenderQueue renderQueue;
+
+namespace {
+
+const int MATERIAL_BITS = 14, TEXTURE_BITS = 16;
+
+bool sameValues(const GLfloat *a, const GLfloat *b, int n) {
+    return memcmp(a, b, n * sizeof(GLfloat)) == 0;
+}
+
+// Field by field: padding makes memcmp of the whole struct unreliable.
+bool sameMaterial(const RenderMaterial &a, const RenderMaterial &b) {
+    return a.blend == b.blend && a.textured == b.textured &&
+           a.colorFace == b.colorFace && a.colorMode == b.colorMode &&
+           sameValues(a.diffuse, b.diffuse, 4) && sameValues(a.specular, b.specular, 4) &&
+           a.shininess == b.shininess && sameValues(a.emission, b.emission, 4) &&
+           sameValues(a.color, b.color, 4);
+}
+
+uint64_t depthBits(float depth) {
+    if (!(depth > 0.0f)) return 0;     // also catches NaN
+    uint32_t bits;
+    memcpy(&bits, &depth, sizeof(bits));
+    return bits;
+}
+
+void setValues(GLfloat *dst, float a, float b, float c, float d) {
+    dst[0] = a;
+    dst[1] = b;
+    dst[2] = c;
+    dst[3] = d;
+}
+
+}
+
+RenderMaterial defaultMaterial() {
+    RenderMaterial m;
+    m.blend = RenderMaterial::BLEND_OPAQUE;
+    m.textured = false;
+    m.colorFace = GL_FRONT_AND_BACK;
+    m.colorMode = GL_AMBIENT_AND_DIFFUSE;
+    setValues(m.diffuse, 0.8f, 0.8f, 0.8f, 1.0f);
+    setValues(m.specular, 0.0f, 0.0f, 0.0f, 1.0f);
+    m.shininess = 0.0f;
+    setValues(m.emission, 0.0f, 0.0f, 0.0f, 1.0f);
+    setValues(m.color, 1.0f, 1.0f, 1.0f, 1.0f);
+    return m;
+}
+
+// =======================================================
+// SUBMISSION
+// =======================================================
+void RenderQueue::clear() {
+    materials.clear();
+    items.clear();
+}
+
+int RenderQueue::addMaterial(const RenderMaterial &m) {
+    // A handful per frame; a linear search beats hashing here
+    for (size_t i = 0; i < materials.size(); i++)
+        if (sameMaterial(materials[i], m)) return (int)i;
+    materials.push_back(m);
+    return (int)materials.size() - 1;
+}
+
+void RenderQueue::submit(int material, TextureHandle texture, float depth, RenderFn draw,
+                         void *object, const float *param) {
+    const RenderMaterial &m = materials[material];
+    if (!m.textured) texture = 0;
+
+    uint64_t pass = m.blend == RenderMaterial::BLEND_OPAQUE ? PASS_OPAQUE : PASS_TRANSPARENT;
+    uint64_t mat = (uint64_t)material & ((1u << MATERIAL_BITS) - 1);
+    uint64_t tex = (uint64_t)texture & ((1u << TEXTURE_BITS) - 1);
+    uint64_t d = depthBits(depth);
+
+    RenderItem item;
+    if (pass == PASS_OPAQUE)
+        item.key = pass << 62 | mat << 48 | tex << 32 | d;
+    else
+        item.key = pass << 62 | (~d & 0xffffffffu) << 30 | mat << 16 | tex;
+    item.material = material;
+    item.texture = texture;
+    item.draw = draw;
+    item.object = object;
+    item.zone = zone;
+    if (param) memcpy(item.param, param, sizeof(item.param));
+    else memset(item.param, 0, sizeof(item.param));
+    items.push_back(item);
+}
+
+// =======================================================
+// SORT
+// LSD radix sort on the key a byte at a time. Stable, so draws with
+// equal keys keep their submission order. A byte every key shares is
+// skipped, which is most of them: the pass and material bytes rarely
+// differ within a frame.
+// =======================================================
+void RenderQueue::sortItems() {
+    size_t n = items.size();
+    if (n < 2) return;
+    scratch.resize(n);
+
+    for (int shift = 0; shift < 64; shift += 8) {
+        size_t counts[256] = {};
+        for (size_t i = 0; i < n; i++) counts[(items[i].key >> shift) & 0xff]++;
+        if (counts[(items[0].key >> shift) & 0xff] == n) continue;
+
+        size_t offset = 0;
+        for (int b = 0; b < 256; b++) {
+            size_t c = counts[b];
+            counts[b] = offset;
+            offset += c;
+        }
+        for (size_t i = 0; i < n; i++)
+            scratch[counts[(items[i].key >> shift) & 0xff]++] = items[i];
+        items.swap(scratch);
+    }
+}
+
+// =======================================================
+// EXECUTE
+// =======================================================
+void RenderQueue::applyPass(Pass pass) {
+    if (pass == PASS_OPAQUE) {
+        glState.disable(GL_BLEND);
+        glDepthMask(GL_TRUE);
+    }
+    else {
+        // Transparent surfaces test against the opaque depth but do not
+        // hide what is drawn after them
+        glState.enable(GL_BLEND);
+        glDepthMask(GL_FALSE);
+    }
+}
+
+void RenderQueue::applyMaterial(const RenderMaterial &m) {
+    if (m.blend == RenderMaterial::BLEND_ADDITIVE) glState.blendFunc(GL_SRC_ALPHA, GL_ONE);
+
+    glState.set(GL_TEXTURE_2D, m.textured);
+
+    // Colour material first: it decides which slots glMaterial still owns
+    glState.colorMaterial(m.colorFace, m.colorMode);
+    if (m.colorMode != GL_AMBIENT_AND_DIFFUSE)
+        glState.material(GL_FRONT, GL_AMBIENT_AND_DIFFUSE, m.diffuse);
+    glState.material(GL_FRONT, GL_SPECULAR, m.specular);
+    glState.material(GL_FRONT, GL_SHININESS, &m.shininess);
+    if (m.colorMode != GL_EMISSION)
+        glState.material(GL_FRONT, GL_EMISSION, m.emission);
+    glState.color(m.color[0], m.color[1], m.color[2], m.color[3]);
+    lighting.setMaterial(m.textured, m.colorMode == GL_EMISSION);
+}
+
+void RenderQueue::execute() {
+    sortItems();
+
+    lastMaterialChanges = lastTextureChanges = 0;
+    int pass = -1, material = -1;
+    bool haveTexture = false;
+    TextureHandle texture = 0;
+    for (size_t i = 0; i < items.size();) {
+        size_t runEnd = i + 1;
+        while (runEnd < items.size() && items[runEnd].zone == items[i].zone) runEnd++;
+        ProfileScope scope(items[i].zone, true);
+
+        for (; i < runEnd; i++) {
+            const RenderItem &item = items[i];
+            const RenderMaterial &m = materials[item.material];
+            int itemPass = (int)(item.key >> 62);
+            if (itemPass != pass) {
+                applyPass((Pass)itemPass);
+                pass = itemPass;
+            }
+            // Applied for every draw, since a draw may set colours of its own;
+            // glState drops whatever did not change
+            applyMaterial(m);
+            if (item.material != material) {
+                material = item.material;
+                lastMaterialChanges++;
+            }
+            if (m.textured && (!haveTexture || item.texture != texture)) {
+                bindTexture(item.texture);
+                haveTexture = true;
+                texture = item.texture;
+                lastTextureChanges++;
+            }
+            item.draw(item);
+        }
+    }
+
+    if (pass == PASS_TRANSPARENT) applyPass(PASS_OPAQUE);
+    glState.disable(GL_TEXTURE_2D);
+}
@@ -0,0 +1,96 @@
+#ifndef RENDERQUEUE_H
+#define RENDERQUEUE_H
+
+#include <stdint.h>
+#include <vector>
+#include "GLPlatform.h"
+#include "TextureManager.h"
+
+// Fixed-function state a draw needs, applied through glState before the
+// draw runs. Every field is set for every draw, so the result no longer
+// depends on what the previous draw left behind.
+struct RenderMaterial {
+    enum Blend { BLEND_OPAQUE, BLEND_ADDITIVE };
+
+    Blend blend;
+    bool textured;
+    // Colour material; `diffuse` is only applied when the colour does not
+    // already track ambient and diffuse, `emission` only when it does not
+    // track emission.
+    GLenum colorFace, colorMode;
+    GLfloat diffuse[4];
+    GLfloat specular[4];
+    GLfloat shininess;
+    GLfloat emission[4];
+    GLfloat color[4];       // ignored by draws with a colour array
+};
+
+// Lit, untextured, white, no emission, no specular.
+RenderMaterial defaultMaterial();
+
+struct RenderItem;
+typedef void (*RenderFn)(const RenderItem &item);
+
+struct RenderItem {
+    uint64_t key;
+    int material;
+    TextureHandle texture;
+    RenderFn draw;
+    void *object;           // whatever `draw` needs (a mesh, a batch, ...)
+    float param[4];
+    const char *zone;       // profiler zone the GL work is timed under
+};
+
+// Draws for one frame, submitted in any order and executed sorted by a
+// 64-bit key, most significant bits first:
+//   opaque       pass(2) | material(14) | texture(16) | depth(32)  near to far
+//   transparent  pass(2) | depth(32) far to near | material(14) | texture(16)
+// Opaque draws sharing a material and texture end up next to each other,
+// so glState only sees the changes between groups. Depth is the float's
+// bit pattern, which orders like the value for depths >= 0.
+class RenderQueue {
+public:
+    enum Pass { PASS_OPAQUE, PASS_TRANSPARENT };
+
+    // Drops last frame's draws and materials.
+    void clear();
+
+    // Returns the id of an identical material if there is one.
+    int addMaterial(const RenderMaterial &m);
+
+    // Profiler zone for the draws submitted from here on (a string
+    // literal). execute() times each run of draws sharing a zone, CPU and
+    // GPU, so every subsystem keeps its own entry although the sort
+    // interleaves them.
+    void setZone(const char *name) { zone = name; }
+
+    // `texture` is only bound when the material is textured. `depth` is the
+    // distance from the eye, or 0 when ordering does not matter.
+    void submit(int material, TextureHandle texture, float depth, RenderFn draw,
+                void *object = nullptr, const float *param = nullptr);
+
+    // Sorts and draws everything, then leaves blending off and depth
+    // writes on.
+    void execute();
+
+    size_t size() const { return items.size(); }
+    // Material and texture groups in the last execute().
+    int materialChanges() const { return lastMaterialChanges; }
+    int textureChanges() const { return lastTextureChanges; }
+
+private:
+    void sortItems();
+    void applyPass(Pass pass);
+    void applyMaterial(const RenderMaterial &m);
+
+    std::vector<RenderMaterial> materials;
+    std::vector<RenderItem> items;
+    std::vector<RenderItem> scratch;
+    int lastMaterialChanges = 0;
+    int lastTextureChanges = 0;
+    const char *zone = "renderQueue";
+};
+
+extern RenderQueue renderQueue;
+
+#endif
@@ -0,0 +1,45 @@
+#ifndef SNAPSHOTBUFFER_H
+#define SNAPSHOTBUFFER_H
+
+#include <atomic>
+
+// Lock-free single-writer / single-reader exchange of whole snapshots.
+// Four slots: one being written, one handed over, and the reader's
+// current and previous (kept so it can interpolate between the two).
+// publish() and acquire() only swap slot indices; slots are reused, so
+// vectors inside T keep their capacity.
+template <typename T>
+class SnapshotBuffer {
+public:
+    SnapshotBuffer() : middle(1), writeSlot(0), currentSlot(2), previousSlot(3) {}
+
+    // Writer thread.
+    T &writeBuffer() { return slots[writeSlot]; }
+    void publish() { writeSlot = middle.exchange(writeSlot | FRESH) & INDEX; }
+
+    // Reader thread. Returns false when nothing new was published;
+    // snapshots published in between are skipped, not queued.
+    bool acquire() {
+        if (!(middle.load() & FRESH)) return false;
+        int got = middle.exchange(previousSlot) & INDEX;
+        previousSlot = currentSlot;
+        currentSlot = got;
+        return true;
+    }
+    const T &current() const { return slots[currentSlot]; }
+    const T &previous() const { return slots[previousSlot]; }
+
+private:
+    enum { INDEX = 3, FRESH = 4 };
+
+    SnapshotBuffer(const SnapshotBuffer &);
+    SnapshotBuffer &operator=(const SnapshotBuffer &);
+
+    T slots[4];
+    std::atomic<int> middle;
+    int writeSlot;
+    int currentSlot;
+    int previousSlot;
+};
+
+#endif
@@ -0,0 +1,52 @@
+#include "SpatialGrid.h"
+#include <algorithm>
+#include <cmath>
+
+SpatialGrid::SpatialGrid() : half(0.0f), invCell(1.0f), dim(0) {}
+
+void SpatialGrid::reset(float halfExtent, float cellSize) {
+    half = halfExtent;
+    dim = std::max(1, (int)std::ceil(2.0f * halfExtent / cellSize));
+    invCell = dim / (2.0f * halfExtent);
+    cells.assign((size_t)dim * dim, std::vector<int>());
+}
+
+void SpatialGrid::clear() {
+    for (size_t i = 0; i < cells.size(); i++) cells[i].clear();
+}
+
+int SpatialGrid::cellCoord(float v) const {
+    int c = (int)std::floor((v + half) * invCell);
+    return std::min(dim - 1, std::max(0, c));
+}
+
+int SpatialGrid::cellIndex(float x, float z) const {
+    return cellCoord(z) * dim + cellCoord(x);
+}
+
+void SpatialGrid::insert(int id, float x, float z) {
+    cells[cellIndex(x, z)].push_back(id);
+}
+
+void SpatialGrid::remove(int id, float x, float z) {
+    std::vector<int> &cell = cells[cellIndex(x, z)];
+    std::vector<int>::iterator it = std::find(cell.begin(), cell.end(), id);
+    if (it == cell.end()) return;
+    *it = cell.back();
+    cell.pop_back();
+}
+
+void SpatialGrid::query(float x, float z, float radius, std::vector<int> &out) const {
+    size_t first = out.size();
+    int x0 = cellCoord(x - radius), x1 = cellCoord(x + radius);
+    int z0 = cellCoord(z - radius), z1 = cellCoord(z + radius);
+
+    for (int cz = z0; cz <= z1; cz++) {
+        for (int cx = x0; cx <= x1; cx++) {
+            const std::vector<int> &cell = cells[cz * dim + cx];
+            out.insert(out.end(), cell.begin(), cell.end());
+        }
+    }
+    // Callers resolve overlaps in array order, like the full scans did
+    std::sort(out.begin() + first, out.end());
+}
@@ -0,0 +1,36 @@
+#ifndef SPATIALGRID_H
+#define SPATIALGRID_H
+
+#include <vector>
+
+// Uniform grid over the square arena [-half, half]^2 in XZ. Entities are
+// identified by their index in the caller's array; positions outside the
+// arena clamp into the border cells. With cells at least as large as the
+// biggest query radius, a query only touches the 3x3 cells around it.
+class SpatialGrid {
+public:
+    SpatialGrid();
+
+    void reset(float halfExtent, float cellSize);
+    void clear();
+
+    void insert(int id, float x, float z);
+    void remove(int id, float x, float z);
+
+    // Appends the ids stored in every cell overlapping the square
+    // [x-radius, x+radius] x [z-radius, z+radius], in ascending order.
+    void query(float x, float z, float radius, std::vector<int> &out) const;
+
+    int cellIndex(float x, float z) const;
+    int dimension() const { return dim; }
+
+private:
+    int cellCoord(float v) const;
+
+    float half;
+    float invCell;
+    int dim;
+    std::vector<std::vector<int> > cells;
+};
+
+#endif
@@ -0,0 +1,302 @@
+#include "TextureImage.h"
+#include "BakedTexture.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+namespace {
+
+unsigned int readU32(const unsigned char *p) {
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((unsigned int)p[3] << 24);
+}
+
+void downsample(const DecodedImage::Level &src, DecodedImage::Level &dst) {
+    dst.width = src.width > 1 ? src.width / 2 : 1;
+    dst.height = src.height > 1 ? src.height / 2 : 1;
+    dst.pixels.resize((size_t)dst.width * dst.height * 3);
+
+    for (int y = 0; y < dst.height; y++) {
+        int y0 = std::min(y * 2, src.height - 1);
+        int y1 = std::min(y * 2 + 1, src.height - 1);
+        const unsigned char *r0 = &src.pixels[(size_t)y0 * src.width * 3];
+        const unsigned char *r1 = &src.pixels[(size_t)y1 * src.width * 3];
+        unsigned char *out = &dst.pixels[(size_t)y * dst.width * 3];
+
+        for (int x = 0; x < dst.width; x++) {
+            int x0 = std::min(x * 2, src.width - 1) * 3;
+            int x1 = std::min(x * 2 + 1, src.width - 1) * 3;
+            for (int c = 0; c < 3; c++)
+                out[x * 3 + c] = (unsigned char)((r0[x0 + c] + r0[x1 + c] + r1[x0 + c] + r1[x1 + c] + 2) / 4);
+        }
+    }
+}
+
+// -------- BC1 --------
+
+unsigned short packRGB565(const float c[3]) {
+    int r = std::min(31, std::max(0, int(c[0] * 31.0f / 255.0f + 0.5f)));
+    int g = std::min(63, std::max(0, int(c[1] * 63.0f / 255.0f + 0.5f)));
+    int b = std::min(31, std::max(0, int(c[2] * 31.0f / 255.0f + 0.5f)));
+    return (unsigned short)((r << 11) | (g << 5) | b);
+}
+
+void unpackRGB565(unsigned short c, int rgb[3]) {
+    int r = (c >> 11) & 31, g = (c >> 5) & 63, b = c & 31;
+    rgb[0] = (r << 3) | (r >> 2);
+    rgb[1] = (g << 2) | (g >> 4);
+    rgb[2] = (b << 3) | (b >> 2);
+}
+
+void bc1Palette(unsigned short c0, unsigned short c1, int palette[4][3]) {
+    unpackRGB565(c0, palette[0]);
+    unpackRGB565(c1, palette[1]);
+    for (int k = 0; k < 3; k++) {
+        if (c0 > c1) {
+            palette[2][k] = (2 * palette[0][k] + palette[1][k]) / 3;
+            palette[3][k] = (palette[0][k] + 2 * palette[1][k]) / 3;
+        } else {
+            palette[2][k] = (palette[0][k] + palette[1][k]) / 2;
+            palette[3][k] = 0;
+        }
+    }
+}
+
+// texels: 16 RGB triples, row-major from the block's first row
+void encodeBlock(const unsigned char texels[16][3], unsigned char out[8]) {
+    float mean[3] = { 0, 0, 0 };
+    for (int i = 0; i < 16; i++)
+        for (int k = 0; k < 3; k++) mean[k] += texels[i][k] / 16.0f;
+
+    float cov[6] = { 0, 0, 0, 0, 0, 0 };
+    for (int i = 0; i < 16; i++) {
+        float d[3] = { texels[i][0] - mean[0], texels[i][1] - mean[1], texels[i][2] - mean[2] };
+        cov[0] += d[0] * d[0]; cov[1] += d[0] * d[1]; cov[2] += d[0] * d[2];
+        cov[3] += d[1] * d[1]; cov[4] += d[1] * d[2]; cov[5] += d[2] * d[2];
+    }
+
+    // Principal axis by power iteration
+    float axis[3] = { 1.0f, 1.0f, 1.0f };
+    for (int it = 0; it < 8; it++) {
+        float n[3] = {
+            cov[0] * axis[0] + cov[1] * axis[1] + cov[2] * axis[2],
+            cov[1] * axis[0] + cov[3] * axis[1] + cov[4] * axis[2],
+            cov[2] * axis[0] + cov[4] * axis[1] + cov[5] * axis[2]
+        };
+        float len = std::max(std::max(std::fabs(n[0]), std::fabs(n[1])), std::fabs(n[2]));
+        if (len < 1e-6f) break;
+        for (int k = 0; k < 3; k++) axis[k] = n[k] / len;
+    }
+
+    float lo = 0.0f, hi = 0.0f;
+    for (int i = 0; i < 16; i++) {
+        float t = (texels[i][0] - mean[0]) * axis[0] + (texels[i][1] - mean[1]) * axis[1] +
+                  (texels[i][2] - mean[2]) * axis[2];
+        if (i == 0 || t < lo) lo = t;
+        if (i == 0 || t > hi) hi = t;
+    }
+    float len2 = axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2];
+    float cmax[3], cmin[3];
+    for (int k = 0; k < 3; k++) {
+        cmax[k] = mean[k] + axis[k] * hi / len2;
+        cmin[k] = mean[k] + axis[k] * lo / len2;
+    }
+
+    unsigned short c0 = packRGB565(cmax), c1 = packRGB565(cmin);
+    if (c0 < c1) std::swap(c0, c1);
+
+    unsigned int bits = 0;
+    if (c0 != c1) {
+        int palette[4][3];
+        bc1Palette(c0, c1, palette);
+        for (int i = 0; i < 16; i++) {
+            int best = 0, bestDist = 1 << 30;
+            for (int p = 0; p < 4; p++) {
+                int dr = texels[i][0] - palette[p][0];
+                int dg = texels[i][1] - palette[p][1];
+                int db = texels[i][2] - palette[p][2];
+                int dist = dr * dr + dg * dg + db * db;
+                if (dist < bestDist) { bestDist = dist; best = p; }
+            }
+            bits |= (unsigned int)best << (i * 2);
+        }
+    }
+
+    out[0] = (unsigned char)(c0 & 0xFF); out[1] = (unsigned char)(c0 >> 8);
+    out[2] = (unsigned char)(c1 & 0xFF); out[3] = (unsigned char)(c1 >> 8);
+    for (int k = 0; k < 4; k++) out[4 + k] = (unsigned char)(bits >> (k * 8));
+}
+
+}
+
+size_t DecodedImage::bytes() const {
+    size_t total = 0;
+    for (size_t i = 0; i < levels.size(); i++) total += levels[i].pixels.size();
+    return total;
+}
+
+bool decodeBMP(const std::string &path, DecodedImage &out) {
+    out.levels.clear();
+    out.format = TEXTURE_BGR8;
+
+    FILE *file = fopen(path.c_str(), "rb");
+    if (!file) {
+        std::cout << "ERROR: Cannot open BMP file: " << path << "\n";
+        return false;
+    }
+
+    unsigned char header[54];
+    if (fread(header, 1, 54, file) != 54 || header[0] != 'B' || header[1] != 'M') {
+        std::cout << "ERROR: Not a valid BMP file: " << path << "\n";
+        fclose(file);
+        return false;
+    }
+
+    unsigned int dataPos = readU32(&header[0x0A]);
+    int width  = (int)readU32(&header[0x12]);
+    int height = (int)readU32(&header[0x16]);
+    int bpp    = header[0x1C] | (header[0x1D] << 8);
+    unsigned int compression = readU32(&header[0x1E]);
+    if (dataPos == 0) dataPos = 54;
+
+    bool topDown = height < 0;
+    if (topDown) height = -height;
+
+    if ((bpp != 24 && bpp != 32) || (compression != 0 && compression != 3) ||
+        width <= 0 || height <= 0) {
+        std::cout << "ERROR: Only uncompressed 24/32-bit BMP files are supported: " << path << "\n";
+        fclose(file);
+        return false;
+    }
+
+    // 32-bit files may carry channel masks (BI_BITFIELDS) right after the info header
+    unsigned int masks[3] = { 0x00FF0000u, 0x0000FF00u, 0x000000FFu };
+    if (bpp == 32 && compression == 3) {
+        unsigned char m[12];
+        if (fread(m, 1, 12, file) == 12) {
+            for (int c = 0; c < 3; c++) masks[c] = readU32(&m[c * 4]);
+        }
+    }
+    int shifts[3];
+    for (int c = 0; c < 3; c++) {
+        shifts[c] = 0;
+        while (shifts[c] < 32 && masks[c] && !((masks[c] >> shifts[c]) & 1)) shifts[c]++;
+    }
+
+    // Rows are padded to 4 bytes on disk; store them as tightly packed BGR.
+    int srcBytes = bpp / 8;
+    size_t rowBytes = (size_t)width * 3;
+    size_t stride = ((size_t)width * srcBytes + 3) & ~(size_t)3;
+    std::vector<unsigned char> row(stride);
+
+    out.levels.resize(1);
+    DecodedImage::Level &base = out.levels[0];
+    base.width = width;
+    base.height = height;
+    base.pixels.resize(rowBytes * height);
+
+    fseek(file, dataPos, SEEK_SET);
+    for (int y = 0; y < height; y++) {
+        if (fread(&row[0], 1, stride, file) != stride && y < height - 1) {
+            std::cout << "ERROR: Truncated BMP file: " << path << "\n";
+            fclose(file);
+            out.levels.clear();
+            return false;
+        }
+        unsigned char *dst = &base.pixels[(topDown ? height - 1 - y : y) * rowBytes];
+        if (bpp == 24) {
+            memcpy(dst, &row[0], rowBytes);
+            continue;
+        }
+        for (int x = 0; x < width; x++) {
+            unsigned int px = readU32(&row[x * 4]);
+            dst[x * 3 + 0] = (unsigned char)((px & masks[2]) >> shifts[2]);
+            dst[x * 3 + 1] = (unsigned char)((px & masks[1]) >> shifts[1]);
+            dst[x * 3 + 2] = (unsigned char)((px & masks[0]) >> shifts[0]);
+        }
+    }
+    fclose(file);
+    return true;
+}
+
+
+void buildMipChain(DecodedImage &image) {
+    if (image.format != TEXTURE_BGR8 || image.levels.empty()) return;
+    image.levels.resize(1);
+    while (image.levels.back().width > 1 || image.levels.back().height > 1) {
+        image.levels.push_back(DecodedImage::Level());
+        downsample(image.levels[image.levels.size() - 2], image.levels.back());
+    }
+}
+
+size_t bc1LevelSize(int width, int height) {
+    return (size_t)((width + 3) / 4) * ((height + 3) / 4) * 8;
+}
+
+void compressBC1(DecodedImage &image) {
+    if (image.format != TEXTURE_BGR8) return;
+
+    for (size_t l = 0; l < image.levels.size(); l++) {
+        DecodedImage::Level &lvl = image.levels[l];
+        int bw = (lvl.width + 3) / 4, bh = (lvl.height + 3) / 4;
+        std::vector<unsigned char> blocks(bc1LevelSize(lvl.width, lvl.height));
+
+        for (int by = 0; by < bh; by++) {
+            for (int bx = 0; bx < bw; bx++) {
+                // Edge blocks repeat the last row/column
+                unsigned char texels[16][3];
+                for (int i = 0; i < 16; i++) {
+                    int x = std::min(bx * 4 + (i & 3), lvl.width - 1);
+                    int y = std::min(by * 4 + (i >> 2), lvl.height - 1);
+                    const unsigned char *p = &lvl.pixels[((size_t)y * lvl.width + x) * 3];
+                    texels[i][0] = p[2]; texels[i][1] = p[1]; texels[i][2] = p[0];
+                }
+                encodeBlock(texels, &blocks[((size_t)by * bw + bx) * 8]);
+            }
+        }
+        lvl.pixels.swap(blocks);
+    }
+    image.format = TEXTURE_BC1;
+}
+
+void decompressBC1(DecodedImage &image) {
+    if (image.format != TEXTURE_BC1) return;
+
+    for (size_t l = 0; l < image.levels.size(); l++) {
+        DecodedImage::Level &lvl = image.levels[l];
+        int bw = (lvl.width + 3) / 4, bh = (lvl.height + 3) / 4;
+        std::vector<unsigned char> pixels((size_t)lvl.width * lvl.height * 3);
+
+        for (int by = 0; by < bh; by++) {
+            for (int bx = 0; bx < bw; bx++) {
+                const unsigned char *b = &lvl.pixels[((size_t)by * bw + bx) * 8];
+                unsigned short c0 = (unsigned short)(b[0] | (b[1] << 8));
+                unsigned short c1 = (unsigned short)(b[2] | (b[3] << 8));
+                unsigned int bits = readU32(b + 4);
+                int palette[4][3];
+                bc1Palette(c0, c1, palette);
+
+                for (int i = 0; i < 16; i++) {
+                    int x = bx * 4 + (i & 3), y = by * 4 + (i >> 2);
+                    if (x >= lvl.width || y >= lvl.height) continue;
+                    const int *c = palette[(bits >> (i * 2)) & 3];
+                    unsigned char *p = &pixels[((size_t)y * lvl.width + x) * 3];
+                    p[0] = (unsigned char)c[2]; p[1] = (unsigned char)c[1]; p[2] = (unsigned char)c[0];
+                }
+            }
+        }
+        lvl.pixels.swap(pixels);
+    }
+    image.format = TEXTURE_BGR8;
+}
+
+bool loadTextureImage(const std::string &path, DecodedImage &out) {
+    if (readBakedTexture(path, out)) return true;
+
+    if (isBakedTextureFile(path)) return readBakedTextureFile(path, out);
+
+    if (!decodeBMP(path, out)) return false;
+    buildMipChain(out);
+    return true;
+}
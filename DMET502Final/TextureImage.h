@@ -0,0 +1,45 @@
+#ifndef TEXTUREIMAGE_H
+#define TEXTUREIMAGE_H
+
+#include <string>
+#include <vector>
+
+// Pixel layout of every level in a DecodedImage.
+enum TextureFormat {
+    TEXTURE_BGR8 = 0,   // tightly packed 24-bit rows
+    TEXTURE_BC1  = 1    // S3TC/DXT1: 8-byte blocks of 4x4 texels, rows of blocks
+};
+
+// CPU-side image with its mip chain. Rows run bottom-up, matching GL's
+// origin.
+struct DecodedImage {
+    struct Level {
+        int width, height;
+        std::vector<unsigned char> pixels;
+    };
+    int format;
+    std::vector<Level> levels;
+
+    DecodedImage() : format(TEXTURE_BGR8) {}
+    size_t bytes() const;
+};
+
+// Reads a 24/32-bit BMP into a single BGR8 level.
+bool decodeBMP(const std::string &path, DecodedImage &out);
+
+// Appends 2x2 box-filtered levels down to 1x1 (BGR8 images only).
+void buildMipChain(DecodedImage &image);
+
+// Software S3TC codec for every level. compressBC1 fits each block's
+// endpoints to its principal colour axis.
+void compressBC1(DecodedImage &image);
+void decompressBC1(DecodedImage &image);
+
+size_t bc1LevelSize(int width, int height);
+
+// Full load path used by the texture streamer: a baked container next to
+// the source (or the path itself being a container) is used as-is,
+// otherwise the BMP is decoded and mipmapped.
+bool loadTextureImage(const std::string &path, DecodedImage &out);
+
+#endif
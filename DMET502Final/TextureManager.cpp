@@ -0,0 +1,328 @@
+#include "TextureManager.h"
+#include "GLStateCache.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <climits>
+#include <cstdlib>
+
+TextureManager textures;
+
+namespace {
+
+double nowMs() {
+    using namespace std::chrono;
+    return duration<double, std::milli>(steady_clock::now().time_since_epoch()).count();
+}
+
+// Resolves "./a.bmp", "a.bmp" and absolute spellings to one key; files
+// that do not exist keep their literal path (and fail to decode later).
+std::string canonicalPath(const std::string &path) {
+    char resolved[PATH_MAX];
+    if (realpath(path.c_str(), resolved)) return resolved;
+    return path;
+}
+
+}
+
+// =======================================================
+// TEXTURE MANAGER
+// =======================================================
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#endif
+
+TextureManager::TextureManager()
+    : compressedSupported(false), placeholder(0), uploading(0), stopping(false) {}
+
+TextureManager::~TextureManager() {
+    shutdown();
+}
+
+void TextureManager::start(int count) {
+    if (!workers.empty()) return;
+    if (count <= 0) {
+        int hw = (int)std::thread::hardware_concurrency();
+        count = hw > 1 ? hw - 1 : 1;
+    }
+    stopping = false;
+    for (int i = 0; i < count; i++)
+        workers.push_back(std::thread(&TextureManager::workerLoop, this));
+}
+
+void TextureManager::shutdown() {
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (size_t i = 0; i < workers.size(); i++) workers[i].join();
+    workers.clear();
+}
+
+void TextureManager::workerLoop() {
+    while (true) {
+        Entry *e = nullptr;
+        TextureHandle h = 0;
+        {
+            std::unique_lock<std::mutex> guard(lock);
+            wake.wait(guard, [this] { return stopping || !decodeQueue.empty(); });
+            if (stopping) return;
+            h = decodeQueue.front();
+            decodeQueue.pop_front();
+            e = entries[h - 1].get();
+            e->state = DECODING;
+        }
+
+        std::unique_ptr<DecodedImage> image(new DecodedImage());
+        bool ok = loadTextureImage(e->path, *image);
+        if (ok && image->format == TEXTURE_BC1 && !compressedSupported)
+            decompressBC1(*image);
+
+        std::lock_guard<std::mutex> guard(lock);
+        if (e->refs == 0) {
+            // Released while decoding
+            e->state = UNLOADED;
+        } else if (ok) {
+            e->image = std::move(image);
+            e->state = DECODED;
+            decodedQueue.push_back(h);
+        } else {
+            e->state = FAILED;
+        }
+    }
+}
+
+void TextureManager::createPlaceholder() {
+    const char *ext = (const char *)glGetString(GL_EXTENSIONS);
+    compressedSupported = ext && (strstr(ext, "GL_EXT_texture_compression_s3tc") ||
+                                  strstr(ext, "GL_EXT_texture_compression_dxt1"));
+
+    static const unsigned char grey[2 * 2 * 3] = {
+        200, 200, 200,  200, 200, 200,
+        200, 200, 200,  200, 200, 200
+    };
+    glGenTextures(1, &placeholder);
+    glBindTexture(GL_TEXTURE_2D, placeholder);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, 2, 2, 0, GL_RGB, GL_UNSIGNED_BYTE, grey);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+}
+
+void TextureManager::enqueue(TextureHandle h) {
+    Entry &e = *entries[h - 1];
+    e.texture = 0;
+    e.residentSize = 0;
+    e.uploadLevel = 0;
+    e.uploadRow = 0;
+    e.requestTime = nowMs();
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        e.state = QUEUED;
+        decodeQueue.push_back(h);
+    }
+    wake.notify_one();
+}
+
+TextureHandle TextureManager::acquire(const std::string &path) {
+    if (!placeholder) createPlaceholder();
+
+    std::string key = canonicalPath(path);
+    std::map<std::string, TextureHandle>::iterator it = byPath.find(key);
+    if (it != byPath.end()) {
+        TextureHandle h = it->second;
+        bool reload;
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            reload = entries[h - 1]->refs++ == 0 && entries[h - 1]->state == UNLOADED;
+        }
+        if (reload) enqueue(h);
+        return h;
+    }
+
+    std::unique_ptr<Entry> e(new Entry());
+    e->path = path;
+    e->refs = 1;
+
+    TextureHandle h;
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        entries.push_back(std::move(e));
+        h = (TextureHandle)entries.size();
+    }
+    byPath[key] = h;
+    enqueue(h);
+    return h;
+}
+
+void TextureManager::release(TextureHandle h) {
+    if (h == 0 || h > entries.size()) return;
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        Entry &e = *entries[h - 1];
+        if (e.refs == 0 || --e.refs > 0) return;
+    }
+    unload(h);
+}
+
+// Drops whatever stage the texture has reached. A decode already running
+// on a worker is discarded when it finishes.
+void TextureManager::unload(TextureHandle h) {
+    Entry &e = *entries[h - 1];
+    bool wasResident = false;
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        switch (e.state) {
+        case QUEUED:
+            decodeQueue.erase(std::find(decodeQueue.begin(), decodeQueue.end(), h));
+            e.state = UNLOADED;
+            break;
+        case DECODED:
+            decodedQueue.erase(std::find(decodedQueue.begin(), decodedQueue.end(), h));
+            e.state = UNLOADED;
+            break;
+        case UPLOADING:
+        case READY:
+            wasResident = e.state == READY;
+            e.state = UNLOADED;
+            break;
+        default:
+            break;
+        }
+    }
+
+    if (uploading == h) uploading = 0;
+    e.image.reset();
+    if (e.texture) {
+        glDeleteTextures(1, &e.texture);
+        e.texture = 0;
+    }
+    e.residentSize = 0;
+    if (wasResident) std::cout << "  - " << e.path << " unloaded\n";
+}
+
+// Uploads up to ~1 MB of rows of the current level; returns true when
+// the whole chain is resident. Compressed levels go up in whole block rows.
+bool TextureManager::uploadStep(Entry &e) {
+    const DecodedImage &img = *e.image;
+    bool bc1 = img.format == TEXTURE_BC1;
+
+    if (e.texture == 0) {
+        glGenTextures(1, &e.texture);
+        glBindTexture(GL_TEXTURE_2D, e.texture);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (GLint)img.levels.size() - 1);
+        for (size_t i = 0; i < img.levels.size(); i++) {
+            const DecodedImage::Level &lvl = img.levels[i];
+            if (bc1)
+                glCompressedTexImage2D(GL_TEXTURE_2D, (GLint)i, GL_COMPRESSED_RGB_S3TC_DXT1_EXT,
+                                       lvl.width, lvl.height, 0, (GLsizei)lvl.pixels.size(), nullptr);
+            else
+                glTexImage2D(GL_TEXTURE_2D, (GLint)i, GL_RGB, lvl.width, lvl.height,
+                             0, GL_BGR, GL_UNSIGNED_BYTE, nullptr);
+        }
+    }
+
+    const DecodedImage::Level &lvl = img.levels[e.uploadLevel];
+    glBindTexture(GL_TEXTURE_2D, e.texture);
+
+    if (bc1) {
+        size_t blockRow = bc1LevelSize(lvl.width, 4);
+        int rows = std::max(1, (int)((1 << 20) / blockRow)) * 4;
+        rows = std::min(rows, lvl.height - e.uploadRow);
+        size_t offset = (size_t)(e.uploadRow / 4) * blockRow;
+        glCompressedTexSubImage2D(GL_TEXTURE_2D, e.uploadLevel, 0, e.uploadRow, lvl.width, rows,
+                                  GL_COMPRESSED_RGB_S3TC_DXT1_EXT,
+                                  (GLsizei)bc1LevelSize(lvl.width, rows), &lvl.pixels[offset]);
+        e.uploadRow += rows;
+    } else {
+        int rows = std::max(1, (1 << 20) / (lvl.width * 3));
+        rows = std::min(rows, lvl.height - e.uploadRow);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexSubImage2D(GL_TEXTURE_2D, e.uploadLevel, 0, e.uploadRow, lvl.width, rows,
+                        GL_BGR, GL_UNSIGNED_BYTE, &lvl.pixels[(size_t)e.uploadRow * lvl.width * 3]);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        e.uploadRow += rows;
+    }
+
+    if (e.uploadRow >= lvl.height) {
+        e.uploadRow = 0;
+        e.uploadLevel++;
+    }
+    return e.uploadLevel >= (int)img.levels.size();
+}
+
+void TextureManager::pump(double budgetMs) {
+    double start = nowMs();
+
+    while (nowMs() - start < budgetMs) {
+        if (!uploading) {
+            std::lock_guard<std::mutex> guard(lock);
+            if (decodedQueue.empty()) break;
+            uploading = decodedQueue.front();
+            decodedQueue.pop_front();
+            entries[uploading - 1]->state = UPLOADING;
+        }
+
+        Entry &e = *entries[uploading - 1];
+        if (!uploadStep(e)) continue;
+
+        e.residentSize = e.image->bytes();
+        e.image.reset();
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            e.state = READY;
+        }
+        uploading = 0;
+        std::cout << "  \xE2\x9C\x93 " << e.path << " ready ("
+                  << int(nowMs() - e.requestTime) << " ms, "
+                  << residentBytes() / (1024 * 1024) << " MB resident)\n";
+    }
+}
+
+GLuint TextureManager::glName(TextureHandle h) const {
+    if (h == 0 || h > entries.size()) return 0;
+    const Entry &e = *entries[h - 1];
+    return isReady(h) ? e.texture : placeholder;
+}
+
+bool TextureManager::isReady(TextureHandle h) const {
+    std::lock_guard<std::mutex> guard(lock);
+    return h != 0 && h <= entries.size() && entries[h - 1]->state == READY;
+}
+
+size_t TextureManager::pendingCount() const {
+    std::lock_guard<std::mutex> guard(lock);
+    size_t n = 0;
+    for (size_t i = 0; i < entries.size(); i++)
+        if (entries[i]->state == QUEUED || entries[i]->state == DECODING ||
+            entries[i]->state == DECODED || entries[i]->state == UPLOADING) n++;
+    return n;
+}
+
+size_t TextureManager::residentBytes() const {
+    std::lock_guard<std::mutex> guard(lock);
+    size_t total = 0;
+    for (size_t i = 0; i < entries.size(); i++)
+        if (entries[i]->state == READY) total += entries[i]->residentSize;
+    return total;
+}
+
+size_t TextureManager::residentCount() const {
+    std::lock_guard<std::mutex> guard(lock);
+    size_t n = 0;
+    for (size_t i = 0; i < entries.size(); i++)
+        if (entries[i]->state == READY) n++;
+    return n;
+}
+
+void bindTexture(TextureHandle h) {
+    glState.bindTexture2D(textures.glName(h));
+}
@@ -0,0 +1,95 @@
+#ifndef TEXTUREMANAGER_H
+#define TEXTUREMANAGER_H
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <memory>
+#include <map>
+#include "GLPlatform.h"
+#include "TextureImage.h"
+
+// Handle returned by TextureManager::acquire(); 0 means "no texture".
+typedef unsigned int TextureHandle;
+
+// Streams textures in the background: worker threads read and decode
+// files (and build mip chains), the GL thread uploads finished images in
+// row stripes within a per-frame time budget. Until a texture is ready,
+// its handle resolves to a shared 2x2 placeholder.
+//
+// Textures are registered once per canonical path and reference counted:
+// acquiring the same file twice returns the same handle, and releasing
+// the last reference frees the GL texture. Handles stay valid after an
+// unload (they resolve to the placeholder) and reload on the next acquire.
+class TextureManager {
+public:
+    TextureManager();
+    ~TextureManager();
+
+    // Starts the worker pool; 0 workers = one per hardware thread minus the GL thread.
+    void start(int workers = 0);
+    void shutdown();
+
+    // GL thread only.
+    TextureHandle acquire(const std::string &path);
+    void release(TextureHandle h);
+
+    // GL thread only. Uploads decoded data for at most `budgetMs`.
+    void pump(double budgetMs);
+
+    GLuint glName(TextureHandle h) const;
+    bool isReady(TextureHandle h) const;
+    size_t pendingCount() const;
+
+    // Texel bytes of every fully uploaded texture (all mip levels).
+    size_t residentBytes() const;
+    size_t residentCount() const;
+
+private:
+    enum State { QUEUED, DECODING, DECODED, UPLOADING, READY, FAILED, UNLOADED };
+
+    struct Entry {
+        std::string path;
+        State state;
+        int refs;
+        GLuint texture;
+        std::unique_ptr<DecodedImage> image;
+        size_t residentSize;
+        int uploadLevel;
+        int uploadRow;
+        double requestTime;
+    };
+
+    TextureManager(const TextureManager &);
+    TextureManager &operator=(const TextureManager &);
+
+    void workerLoop();
+    void createPlaceholder();
+    void enqueue(TextureHandle h);
+    void unload(TextureHandle h);
+    bool uploadStep(Entry &e);
+
+    bool compressedSupported;
+
+    std::vector<std::unique_ptr<Entry> > entries;
+    std::map<std::string, TextureHandle> byPath;
+    GLuint placeholder;
+    TextureHandle uploading;
+
+    mutable std::mutex lock;
+    std::condition_variable wake;
+    std::deque<TextureHandle> decodeQueue;
+    std::deque<TextureHandle> decodedQueue;
+    std::vector<std::thread> workers;
+    bool stopping;
+};
+
+extern TextureManager textures;
+
+// glBindTexture(GL_TEXTURE_2D, ...) through the manager's current GL name.
+void bindTexture(TextureHandle h);
+
+#endif
@@ -0,0 +1,149 @@
+#include "GLPlatform.h"
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <cstring>
+#include <cstdlib>
+#include <iostream>
+
+#ifndef EGL_PLATFORM_SURFACELESS_MESA
+#define EGL_PLATFORM_SURFACELESS_MESA 0x31DD
+#endif
+
+namespace {
+
+int windowW = 300, windowH = 300;
+
+EGLDisplay display = EGL_NO_DISPLAY;
+EGLContext context = EGL_NO_CONTEXT;
+EGLSurface surface = EGL_NO_SURFACE;
+GLuint framebuffer = 0, colorBuffer = 0, depthBuffer = 0;
+
+bool hasExtension(const char *list, const char *name) {
+    if (!list) return false;
+    size_t n = strlen(name);
+    for (const char *p = strstr(list, name); p; p = strstr(p + n, name))
+        if ((p == list || p[-1] == ' ') && (p[n] == ' ' || p[n] == '\0')) return true;
+    return false;
+}
+
+EGLDisplay openDisplay() {
+    // Surfaceless needs no X server or GPU; otherwise take what EGL offers
+    const char *clientExt = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+    PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay =
+        (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+    if (getPlatformDisplay && hasExtension(clientExt, "EGL_MESA_platform_surfaceless")) {
+        EGLDisplay d = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+        if (d != EGL_NO_DISPLAY && eglInitialize(d, nullptr, nullptr)) return d;
+    }
+    EGLDisplay d = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    if (d != EGL_NO_DISPLAY && eglInitialize(d, nullptr, nullptr)) return d;
+    return EGL_NO_DISPLAY;
+}
+
+void fail(const char *what) {
+    std::cout << "ERROR: Offscreen context: " << what << "\n";
+    exit(1);
+}
+
+}
+
+// =======================================================
+// CONTEXT + FRAMEBUFFER
+// =======================================================
+void glutInit(int *, char **) {}
+void glutInitDisplayMode(unsigned int) {}
+
+void glutInitWindowSize(int width, int height) {
+    windowW = width;
+    windowH = height;
+}
+
+int glutCreateWindow(const char *) {
+    display = openDisplay();
+    if (display == EGL_NO_DISPLAY) fail("no EGL display");
+
+    static const EGLint configAttribs[] = {
+        EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_RED_SIZE, 8, EGL_GREEN_SIZE, 8, EGL_BLUE_SIZE, 8,
+        EGL_NONE
+    };
+    EGLConfig config;
+    EGLint count = 0;
+    if (!eglChooseConfig(display, configAttribs, &config, 1, &count) || count == 0)
+        fail("no OpenGL config");
+    if (!eglBindAPI(EGL_OPENGL_API)) fail("desktop OpenGL unavailable");
+
+    // Default attributes give a compatibility context, which the
+    // fixed-function renderer needs
+    context = eglCreateContext(display, config, EGL_NO_CONTEXT, nullptr);
+    if (context == EGL_NO_CONTEXT) fail("cannot create context");
+
+    if (!hasExtension(eglQueryString(display, EGL_EXTENSIONS), "EGL_KHR_surfaceless_context")) {
+        static const EGLint pbufferAttribs[] = { EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE };
+        surface = eglCreatePbufferSurface(display, config, pbufferAttribs);
+        if (surface == EGL_NO_SURFACE) fail("cannot create pbuffer");
+    }
+    if (!eglMakeCurrent(display, surface, surface, context)) fail("cannot make context current");
+
+    // Everything is drawn into this FBO; the benchmark reads frames back from it
+    glGenRenderbuffers(1, &colorBuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, colorBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, windowW, windowH);
+    glGenRenderbuffers(1, &depthBuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, depthBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, windowW, windowH);
+
+    glGenFramebuffers(1, &framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorBuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depthBuffer);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) fail("incomplete framebuffer");
+    glViewport(0, 0, windowW, windowH);
+
+    std::cout << "Offscreen " << windowW << "x" << windowH << " on "
+              << (const char *)glGetString(GL_RENDERER) << "\n";
+    return 1;
+}
+
+// =======================================================
+// EVENT LOOP (none offscreen)
+// =======================================================
+void glutDisplayFunc(void (*)()) {}
+void glutReshapeFunc(void (*)(int, int)) {}
+void glutKeyboardFunc(void (*)(unsigned char, int, int)) {}
+void glutKeyboardUpFunc(void (*)(unsigned char, int, int)) {}
+void glutPassiveMotionFunc(void (*)(int, int)) {}
+void glutMotionFunc(void (*)(int, int)) {}
+void glutIdleFunc(void (*)()) {}
+void glutMainLoop() {}
+void glutPostRedisplay() {}
+
+void glutSwapBuffers() {
+    glFlush();
+}
+
+// =======================================================
+// DRAWING HELPERS
+// =======================================================
+void glutBitmapCharacter(void *, int) {}
+
+void glutSolidCube(double size) {
+    static const float normals[6][3] = {
+        { 1, 0, 0 }, { -1, 0, 0 }, { 0, 1, 0 }, { 0, -1, 0 }, { 0, 0, 1 }, { 0, 0, -1 }
+    };
+    // Corner bits: 1 = +x, 2 = +y, 4 = +z; counter-clockwise seen from outside
+    static const int faces[6][4] = {
+        { 1, 3, 7, 5 }, { 0, 4, 6, 2 }, { 2, 6, 7, 3 }, { 0, 1, 5, 4 }, { 4, 5, 7, 6 }, { 0, 2, 3, 1 }
+    };
+    float h = (float)size * 0.5f;
+    glBegin(GL_QUADS);
+    for (int f = 0; f < 6; f++) {
+        glNormal3fv(normals[f]);
+        for (int v = 0; v < 4; v++) {
+            int c = faces[f][v];
+            glVertex3f(c & 1 ? h : -h, c & 2 ? h : -h, c & 4 ? h : -h);
+        }
+    }
+    glEnd();
+}
@@ -0,0 +1,44 @@
+#ifndef OFFSCREENGLUT_H
+#define OFFSCREENGLUT_H
+
+// Stand-in for the part of GLUT the game uses, for the renderbench
+// target (OFFSCREEN_GLUT). glutCreateWindow() makes an EGL context with
+// no window system (Mesa's surfaceless platform, falling back to the
+// default display) and binds a framebuffer object of the window size, so
+// renderScene() runs unchanged on a GPU-less box under software Mesa.
+// There is no event loop: callbacks are accepted and never called.
+#include <stdlib.h>     // GL/glut.h includes it; the game relies on that
+#include <GL/gl.h>
+#include <GL/glext.h>
+#include <GL/glu.h>
+
+#define GLUT_RGBA   0x0000
+#define GLUT_DOUBLE 0x0002
+#define GLUT_DEPTH  0x0010
+
+// Bitmap text is not drawn offscreen; frame dumps have no HUD text.
+#define GLUT_BITMAP_HELVETICA_12 ((void *)0)
+#define GLUT_BITMAP_HELVETICA_18 ((void *)1)
+
+void glutInit(int *argc, char **argv);
+void glutInitDisplayMode(unsigned int mode);
+void glutInitWindowSize(int width, int height);
+int glutCreateWindow(const char *title);
+
+void glutDisplayFunc(void (*fn)());
+void glutReshapeFunc(void (*fn)(int, int));
+void glutKeyboardFunc(void (*fn)(unsigned char, int, int));
+void glutKeyboardUpFunc(void (*fn)(unsigned char, int, int));
+void glutPassiveMotionFunc(void (*fn)(int, int));
+void glutMotionFunc(void (*fn)(int, int));
+void glutIdleFunc(void (*fn)());
+void glutMainLoop();
+void glutPostRedisplay();
+
+// Finishes the frame in the framebuffer object (no display to swap to).
+void glutSwapBuffers();
+
+void glutBitmapCharacter(void *font, int character);
+void glutSolidCube(double size);
+
+#endif
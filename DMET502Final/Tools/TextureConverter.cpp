@@ -0,0 +1,50 @@
+// texconv: offline converter from BMP to the pre-mipmapped .btex container
+// the game streams directly (see BakedTexture.h).
+//
+//   texconv [--bc1] image.bmp ...
+//
+// Each input gets "<image>.bmp.btex" written next to it. --bc1 stores
+// S3TC/DXT1 blocks (6:1 against 24-bit texels); without it the levels
+// stay uncompressed BGR.
+#include "BakedTexture.h"
+#include "TextureImage.h"
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+int main(int argc, char **argv) {
+    bool bc1 = false;
+    int converted = 0, failed = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--bc1") == 0) { bc1 = true; continue; }
+
+        auto start = std::chrono::steady_clock::now();
+        DecodedImage image;
+        if (!decodeBMP(argv[i], image)) { failed++; continue; }
+        size_t sourceBytes = image.bytes();
+
+        buildMipChain(image);
+        if (bc1) compressBC1(image);
+
+        if (!writeBakedTexture(argv[i], image)) {
+            std::cout << "ERROR: Cannot write " << bakedTexturePath(argv[i]) << "\n";
+            failed++;
+            continue;
+        }
+
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "  \xE2\x9C\x93 " << bakedTexturePath(argv[i]) << ": "
+                  << image.levels[0].width << "x" << image.levels[0].height << ", "
+                  << image.levels.size() << " levels, " << (bc1 ? "BC1" : "BGR8") << ", "
+                  << image.bytes() / 1024 << " KB (base level was " << sourceBytes / 1024 << " KB), "
+                  << int(ms) << " ms\n";
+        converted++;
+    }
+
+    if (converted + failed == 0) {
+        std::cout << "usage: texconv [--bc1] image.bmp ...\n";
+        return 1;
+    }
+    return failed ? 1 : 0;
+}
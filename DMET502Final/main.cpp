@@ -9,7 +9,25 @@
 //   6) Enhanced visual quality
 // =============================================================
 
-#include <GLUT/glut.h>
+#include "GLPlatform.h"
+#include "GpuMesh.h"
+#include "PrimitiveMeshes.h"
+#include "InstanceBatch.h"
+#include "ObjModel.h"
+#include "Benchmarks.h"
+#include "TextureManager.h"
+#include "SpatialGrid.h"
+#include "GameWorld.h"
+#include "OverlapKernels.h"
+#include "JobSystem.h"
+#include "SnapshotBuffer.h"
+#include "FramePacing.h"
+#include "Profiler.h"
+#include "GLStateCache.h"
+#include "RenderQueue.h"
+#include "Lighting.h"
+#include "Frustum.h"
+#include "LevelOfDetail.h"
 #include <cmath>
 #include <vector>
 #include <string>
@@ -17,61 +35,16 @@
 #include <sstream>
 #include <iostream>
 #include <cstdlib>
+#include <cctype>
 #include <ctime>
 #include <algorithm>
-
-// =======================================================
-// IMPROVED BMP TEXTURE LOADER
-// =======================================================
-GLuint loadBMP(const char *imagepath) {
-    unsigned char header[54];
-    unsigned int dataPos, width, height, imageSize;
-
-    FILE *file = fopen(imagepath, "rb");
-    if (!file) {
-        std::cout << "ERROR: Cannot open BMP file: " << imagepath << "\n";
-        return 0;
-    }
-
-    if (fread(header, 1, 54, file) != 54) {
-        std::cout << "ERROR: Not a valid BMP file\n";
-        fclose(file);
-        return 0;
-    }
-
-    if (header[0] != 'B' || header[1] != 'M') {
-        std::cout << "ERROR: Not a valid BMP file\n";
-        fclose(file);
-        return 0;
-    }
-
-    dataPos   = *(int*)&(header[0x0A]);
-    imageSize = *(int*)&(header[0x22]);
-    width     = *(int*)&(header[0x12]);
-    height    = *(int*)&(header[0x16]);
-
-    if (imageSize == 0) imageSize = width * height * 3;
-    if (dataPos == 0)   dataPos = 54;
-
-    unsigned char *data = new unsigned char[imageSize];
-    fread(data, 1, imageSize, file);
-    fclose(file);
-
-    GLuint texID;
-    glGenTextures(1, &texID);
-    glBindTexture(GL_TEXTURE_2D, texID);
-
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-    gluBuild2DMipmaps(GL_TEXTURE_2D, GL_RGB, width, height,
-                      GL_BGR, GL_UNSIGNED_BYTE, data);
-
-    delete[] data;
-    return texID;
-}
+#include <chrono>
+#include <random>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <cstring>
+#include <sys/stat.h>
 
 // =======================================================
 // BASIC MATH
@@ -98,6 +71,10 @@ inline float lerp(float a, float b, float t){
     return a + (b - a) * t;
 }
 
+inline Vec3 lerp(const Vec3& a, const Vec3& b, float t){
+    return Vec3(lerp(a.x, b.x, t), lerp(a.y, b.y, t), lerp(a.z, b.z, t));
+}
+
 // =======================================================
 // GLOBALS
 // =======================================================
@@ -107,7 +84,6 @@ const float WALL_HEIGHT = 7.0f;
 Vec3 playerPos(0,1.0f,0), lastSafePos(0,1.0f,0);
 float playerYaw=0, cameraYaw=0, playerPitch=0, cameraPitch=0;
 
-float lastTime=0;
 float playerRadius=0.6f, playerSpeed=8.0f;
 
 bool keys[512]={false};
@@ -122,136 +98,133 @@ int score = 0;
 // Animation time tracker
 float animTime = 0.0f;
 
+// What the GL thread draws: the simulation's latest two snapshots
+// blended (see SIMULATION SNAPSHOTS). Render code reads only this and the
+// snapshot instance lists, never the simulation globals above.
+struct FrameView {
+    float alpha;
+    int level, score;
+    float animTime;
+    Vec3 playerPos, fireSpirit, portal;
+    float playerYaw, cameraYaw, cameraPitch;
+} frame = {};
+
 // =======================================================
 // TEXTURES
 // =======================================================
-GLuint desertWallTex = 0;
-GLuint snowWallTex   = 0;
-GLuint desertFloorTex = 0;
-GLuint snowFloorTex   = 0;
-GLuint desertStoneTex = 0;
-GLuint desertGoldTex = 0;
-GLuint roofTex = 0;
-GLuint fireSpiritTex = 0;
-GLuint portalTex = 0;
+bool glContextReady = false;
+
+TextureHandle desertWallTex = 0;
+TextureHandle snowWallTex   = 0;
+TextureHandle desertFloorTex = 0;
+TextureHandle snowFloorTex   = 0;
+TextureHandle desertStoneTex = 0;
+TextureHandle desertGoldTex = 0;
+TextureHandle roofTex = 0;
+TextureHandle fireSpiritTex = 0;
+TextureHandle portalTex = 0;
+
+// Per-frame time the GL thread may spend uploading streamed textures
+double textureUploadBudgetMs = 4.0;
+
+// Which level needs each texture (0 = both). Files shared by several
+// slots resolve to one registry entry.
+struct LevelTexture { TextureHandle *slot; const char *file; int level; };
+
+const LevelTexture levelTextures[] = {
+    { &desertWallTex,  "rock_boulder_cracked_diff_4k.bmp",          1 },
+    { &desertFloorTex, "Ground095A_4K-JPG_Color.bmp",               1 },
+    { &desertStoneTex, "large_sandstone_blocks_01_diff_4k.bmp",     1 },
+    { &desertGoldTex,  "Metal042B.bmp",                             1 },
+    { &snowWallTex,    "jersey_melange_diff_4k.bmp",                2 },
+    { &snowFloorTex,   "Snow008A_4K-JPG_Color.bmp",                 2 },
+    { &roofTex,        "large_sandstone_blocks_01_diff_4k.bmp",     0 },
+    { &fireSpiritTex,  "ChristmasTreeOrnament014_4K-JPG_Color.bmp", 0 },
+    { &portalTex,      "large_sandstone_blocks_01_diff_4k.bmp",     0 },
+};
 
-// =======================================================
-// FIRE SPIRIT ORB - Follows beside player
-// =======================================================
-struct FireSpirit {
-    Vec3 pos;
-    float offsetDistance;
-    float height;
-    
-    FireSpirit() : offsetDistance(2.5f), height(2.0f) {
-        updatePosition();
-    }
-    
-    void updatePosition() {
-        // Position fire spirit to the right side of player
-        float sy = std::sin(playerYaw);
-        float cy = std::cos(playerYaw);
-        
-        // Right vector relative to player direction
-        Vec3 right(cy, 0, sy);
-        
-        pos.x = playerPos.x + right.x * offsetDistance;
-        pos.z = playerPos.z + right.z * offsetDistance;
-        pos.y = playerPos.y + height + std::sin(animTime * 3.0f) * 0.2f;
-    }
-    
-    void update(float dt) {
-        updatePosition();
-    }
-} fireSpirit;
+std::vector<TextureHandle> heldTextures;
 
-// =======================================================
-// CRYSTAL LIGHTS (for snow level)
-// =======================================================
-struct Crystal {
-    Vec3 pos;
-    float glowPhase;
-};
-std::vector<Crystal> crystals;
+// Acquires the new level's textures before releasing the old set, so
+// shared files stay resident across the switch.
+void useLevelTextures(int level){
+    if(!glContextReady) return;
+
+    std::vector<TextureHandle> held;
+    for(const LevelTexture& t : levelTextures){
+        if(t.level != 0 && t.level != level) continue;
+        *t.slot = textures.acquire(t.file);
+        held.push_back(*t.slot);
+    }
+    for(TextureHandle h : heldTextures) textures.release(h);
+    heldTextures.swap(held);
+}
 
 // =======================================================
 // FOG
+// Past the distance where EXP2 fog leaves less than half an 8-bit step
+// of a surface, every pixel is the fog colour. The far plane sits there
+// (so frustum culling drops whatever lies beyond) and the screen clears
+// to the fog colour.
 // =======================================================
+const float FOG_CUTOFF = 1.0f / 512.0f;
+const float MAX_VIEW_DISTANCE = 300.0f;
+
+float levelFogDensity(int level) {
+    return level == 1 ? 0.018f : 0.045f;
+}
+
+// Eye depth where exp(-(density * z)^2) falls to FOG_CUTOFF.
+float fogViewDistance(int level) {
+    return std::min(MAX_VIEW_DISTANCE, std::sqrt(-std::log(FOG_CUTOFF)) / levelFogDensity(level));
+}
+
 void setupFog() {
-    glEnable(GL_FOG);
+    glState.enable(GL_FOG);
 
     GLfloat fogColor[4];
 
-    if (currentLevel == 1) {
+    if (frame.level == 1) {
         // Day cycle affects fog color
-        float dayTime = std::sin(animTime * 0.15f) * 0.5f + 0.5f;
+        float dayTime = std::sin(frame.animTime * 0.15f) * 0.5f + 0.5f;
         fogColor[0] = lerp(0.94f, 0.98f, dayTime);
         fogColor[1] = lerp(0.86f, 0.92f, dayTime);
         fogColor[2] = lerp(0.72f, 0.85f, dayTime);
         fogColor[3] = 1.0f;
-        glFogf(GL_FOG_DENSITY, 0.018f);
     }
     else {
         fogColor[0] = 0.92f;
         fogColor[1] = 0.95f;
         fogColor[2] = 0.98f;
         fogColor[3] = 1.0f;
-        glFogf(GL_FOG_DENSITY, 0.045f);
     }
 
-    glFogfv(GL_FOG_COLOR, fogColor);
-    glFogi(GL_FOG_MODE, GL_EXP2);
+    glState.fogDensity(levelFogDensity(frame.level));
+    glState.fogColor(fogColor);
+    glClearColor(fogColor[0], fogColor[1], fogColor[2], fogColor[3]);
+    glState.fogMode(GL_EXP2);
 }
 
 // =======================================================
-// OBJ LOADER
+// PLAYER MODEL (player.obj, cached as player.obj.bake)
 // =======================================================
-struct Vec3s { float x,y,z; };
-struct Mesh {
-    std::vector<Vec3s> verts;
-    bool empty()const{return verts.empty();}
-};
-Mesh playerMesh;
-
-Mesh loadOBJ(const std::string& path){
-    Mesh mesh;
-    std::ifstream in(path);
-    if(!in.is_open()) return mesh;
-
-    std::vector<Vec3s> vlist;
-    std::string line;
-
-    while(std::getline(in,line)){
-        if(line.rfind("v ",0)==0){
-            std::istringstream iss(line.substr(2));
-            float x,y,z; iss>>x>>y>>z;
-            vlist.push_back({x,y,z});
-        }
-        else if(line.rfind("f ",0)==0){
-            std::istringstream iss(line.substr(2));
-            std::string a,b,c;
-            iss>>a>>b>>c;
-
-            auto idx=[&](std::string s){ return stoi(s.substr(0,s.find('/'))) - 1; };
-
-            mesh.verts.push_back(vlist[idx(a)]);
-            mesh.verts.push_back(vlist[idx(b)]);
-            mesh.verts.push_back(vlist[idx(c)]);
-        }
-    }
-    return mesh;
-}
+ObjModel playerModel;
 
 // =======================================================
 // ENTITIES
 // =======================================================
-struct Collectible { Vec3 pos; float radius; bool collected; };
-struct Obstacle { Vec3 pos, vel; float radius, mass; std::string type; bool grounded; };
-struct Portal { Vec3 pos; float radius; };
-
-std::vector<Collectible> collectibles;
-std::vector<Obstacle> obstacles;
-Portal portal;
+// Everything but the player lives in the ECS world (see GameWorld.h).
+// Obstacles and collectibles are only flagged during a level, never
+// destroyed, so their archetype rows stay valid as grid ids.
+World world;
+Entity portalEntity;
+Entity fireSpiritEntity;
+
+Vec3 entityPosition(Entity e){
+    return Vec3(*world.f(e, COMP_POSITION, POS_X),
+                *world.f(e, COMP_POSITION, POS_Y),
+                *world.f(e, COMP_POSITION, POS_Z));
+}
 
 // =======================================================
 // RANDOM POS
@@ -264,16 +237,257 @@ Vec3 randomUniformPosition(float minDist){
     }
 }
 
+// =======================================================
+// STATIC WORLD GEOMETRY CACHE
+// Floor, walls, roof and portal only change with the level, so they
+// are built once per level into retained meshes (one per texture).
+// =======================================================
+
+struct StaticWorld {
+    GpuMesh floor;
+    GpuMesh walls;
+    GpuMesh roof;
+    GpuMesh portal;
+} staticWorld;
+
+void buildStaticWorld(int level, const Vec3& portalPos){
+    if(!glContextReady) return;
+
+    float half = WORLD_HALF;
+    float h    = WALL_HEIGHT;
+    std::vector<MeshVertex> v;
+    std::vector<unsigned int> idx;
+
+    // ========== FLOOR ==========
+    float floorRepeat = (level == 1 ? 8.0f : 30.0f);
+    appendQuad(v, idx,
+        { -half,0,-half, 0,1,0, 0,0 },
+        {  half,0,-half, 0,1,0, floorRepeat,0 },
+        {  half,0, half, 0,1,0, floorRepeat,floorRepeat },
+        { -half,0, half, 0,1,0, 0,floorRepeat });
+    staticWorld.floor.upload(v, idx);
+
+    // ========== WALLS ==========
+    v.clear(); idx.clear();
+    float repeat = 10.0f;
+
+    // +Z wall
+    appendQuad(v, idx,
+        { -half,0, half, 0,0,-1, 0,0 },
+        {  half,0, half, 0,0,-1, repeat,0 },
+        {  half,h, half, 0,0,-1, repeat,repeat },
+        { -half,h, half, 0,0,-1, 0,repeat });
+    // -Z wall
+    appendQuad(v, idx,
+        { -half,0,-half, 0,0,1, 0,0 },
+        { -half,h,-half, 0,0,1, 0,repeat },
+        {  half,h,-half, 0,0,1, repeat,repeat },
+        {  half,0,-half, 0,0,1, repeat,0 });
+    // -X wall
+    appendQuad(v, idx,
+        { -half,0,-half, 1,0,0, 0,0 },
+        { -half,0, half, 1,0,0, repeat,0 },
+        { -half,h, half, 1,0,0, repeat,repeat },
+        { -half,h,-half, 1,0,0, 0,repeat });
+    // +X wall
+    appendQuad(v, idx,
+        { half,0,-half, -1,0,0, 0,0 },
+        { half,h,-half, -1,0,0, 0,repeat },
+        { half,h, half, -1,0,0, repeat,repeat },
+        { half,0, half, -1,0,0, repeat,0 });
+    staticWorld.walls.upload(v, idx);
+
+    // ========== ROOF ==========
+    v.clear(); idx.clear();
+    float roofRepeat = 6.0f;
+    appendQuad(v, idx,
+        { -half,h,-half, 0,-1,0, 0,0 },
+        {  half,h,-half, 0,-1,0, roofRepeat,0 },
+        {  half,h, half, 0,-1,0, roofRepeat,roofRepeat },
+        { -half,h, half, 0,-1,0, 0,roofRepeat });
+    staticWorld.roof.upload(v, idx);
+
+    // ========== PORTAL (baked at its level position) ==========
+    v.clear(); idx.clear();
+    float px = portalPos.x, py = portalPos.y + 3.5f, pz = portalPos.z;
+    float w = 4.5f, ph = 6.0f, d = 0.4f;
+
+    // Front face
+    appendQuad(v, idx,
+        { px-w,py-ph,pz+d, 0,0,1, 0,0 },
+        { px+w,py-ph,pz+d, 0,0,1, 2,0 },
+        { px+w,py+ph,pz+d, 0,0,1, 2,3 },
+        { px-w,py+ph,pz+d, 0,0,1, 0,3 });
+    // Back face
+    appendQuad(v, idx,
+        { px-w,py-ph,pz-d, 0,0,-1, 0,0 },
+        { px-w,py+ph,pz-d, 0,0,-1, 0,3 },
+        { px+w,py+ph,pz-d, 0,0,-1, 2,3 },
+        { px+w,py-ph,pz-d, 0,0,-1, 2,0 });
+    // Left side
+    appendQuad(v, idx,
+        { px-w,py-ph,pz-d, -1,0,0, 0,0 },
+        { px-w,py-ph,pz+d, -1,0,0, 1,0 },
+        { px-w,py+ph,pz+d, -1,0,0, 1,3 },
+        { px-w,py+ph,pz-d, -1,0,0, 0,3 });
+    // Right side
+    appendQuad(v, idx,
+        { px+w,py-ph,pz-d, 1,0,0, 0,0 },
+        { px+w,py+ph,pz-d, 1,0,0, 0,3 },
+        { px+w,py+ph,pz+d, 1,0,0, 1,3 },
+        { px+w,py-ph,pz+d, 1,0,0, 1,0 });
+    // Top
+    appendQuad(v, idx,
+        { px-w,py+ph,pz-d, 0,1,0, 0,0 },
+        { px-w,py+ph,pz+d, 0,1,0, 0,1 },
+        { px+w,py+ph,pz+d, 0,1,0, 2,1 },
+        { px+w,py+ph,pz-d, 0,1,0, 2,0 });
+    // Bottom
+    appendQuad(v, idx,
+        { px-w,py-ph,pz-d, 0,-1,0, 0,0 },
+        { px+w,py-ph,pz-d, 0,-1,0, 2,0 },
+        { px+w,py-ph,pz+d, 0,-1,0, 2,1 },
+        { px-w,py-ph,pz+d, 0,-1,0, 0,1 });
+    staticWorld.portal.upload(v, idx);
+}
+
 // =======================================================
 // LEVEL SETUP
 // =======================================================
+// Entity counts per level; 0 keeps the level's default.
+// Set from --collectibles / --obstacles / --crystals for stress runs.
+struct LevelCounts { int collectibles, obstacles, crystals; };
+LevelCounts countOverride = { 0, 0, 0 };
+
+int levelCount(int overrideCount, int defaultCount){
+    return overrideCount > 0 ? overrideCount : defaultCount;
+}
+
+// =======================================================
+// SPATIAL GRIDS
+// Obstacles and collectibles are bucketed by XZ cell so the per-tick
+// collision and pickup checks only visit the cells around the player.
+// =======================================================
+const float GRID_CELL = 2.5f;
+
+SpatialGrid obstacleGrid;
+SpatialGrid collectibleGrid;
+float maxObstacleRadius = 0.0f;
+float maxCollectibleRadius = 0.0f;
+int collectiblesRemaining = 0;
+std::vector<int> gridHits;
+std::vector<int> overlapHits;
+
+struct SpawnPoint { float x, y, z; };
+
+// Spawn order sorted by grid cell, so each row of cells is one
+// contiguous run of archetype rows for the overlap kernels.
+std::vector<SpawnPoint> cellOrder(const SpatialGrid& grid, std::vector<SpawnPoint> points){
+    std::stable_sort(points.begin(), points.end(), [&](const SpawnPoint& a, const SpawnPoint& b){
+        return grid.cellIndex(a.x, a.z) < grid.cellIndex(b.x, b.z);
+    });
+    return points;
+}
+
+void resetSpatialGrids(){
+    obstacleGrid.reset(WORLD_HALF, GRID_CELL);
+    collectibleGrid.reset(WORLD_HALF, GRID_CELL);
+    maxObstacleRadius = maxCollectibleRadius = 0.0f;
+}
+
+void spawnObstacles(const std::vector<SpawnPoint>& points, float radius, ObstacleKind kind, bool grounded){
+    std::vector<SpawnPoint> sorted = cellOrder(obstacleGrid, points);
+    for(const SpawnPoint& p : sorted) spawnObstacle(world, p.x, p.y, p.z, radius, kind, grounded);
+    maxObstacleRadius = std::max(maxObstacleRadius, radius);
+}
+
+// The bob phase keeps the spawn index so neighbours stay out of step.
+void spawnCollectibles(const std::vector<SpawnPoint>& points, float radius){
+    std::vector<int> order(points.size());
+    for(size_t i=0;i<order.size();i++) order[i] = (int)i;
+    std::stable_sort(order.begin(), order.end(), [&](int a, int b){
+        return collectibleGrid.cellIndex(points[a].x, points[a].z) <
+               collectibleGrid.cellIndex(points[b].x, points[b].z);
+    });
+    for(int i : order) spawnCollectible(world, points[i].x, points[i].y, points[i].z, radius, (float)i);
+    maxCollectibleRadius = std::max(maxCollectibleRadius, radius);
+}
+
+// Grid ids are archetype rows, valid until the next world.clear().
+void buildSpatialGrids(){
+    world.each(OBSTACLE_ARCHETYPE, [&](ChunkView& v){
+        const float* x = v.f(COMP_POSITION, POS_X);
+        const float* z = v.f(COMP_POSITION, POS_Z);
+        for(size_t i=0;i<v.count;i++) obstacleGrid.insert((int)(v.firstRow + i), x[i], z[i]);
+    });
+    world.each(COLLECTIBLE_ARCHETYPE, [&](ChunkView& v){
+        const float* x = v.f(COMP_POSITION, POS_X);
+        const float* z = v.f(COMP_POSITION, POS_Z);
+        for(size_t i=0;i<v.count;i++) collectibleGrid.insert((int)(v.firstRow + i), x[i], z[i]);
+    });
+    collectiblesRemaining = (int)world.count(COLLECTIBLE_ARCHETYPE);
+}
+
+// =======================================================
+// PARALLEL CHUNKS
+// Per-entity work is split over the job system a few ECS chunks (or
+// candidate rows) per job. Slices write disjoint data and are merged in
+// slice order, so results do not depend on the thread count.
+// =======================================================
+const size_t CHUNKS_PER_JOB = 8;
+const size_t ROWS_PER_JOB = 4096;
+
+std::vector<ChunkView> obstacleChunks, collectibleChunks, crystalChunks;
+
+// Calls fn(view) for every chunk matching `required`.
+template <typename Fn>
+void parallelChunks(ComponentMask required, std::vector<ChunkView>& scratch, Fn fn){
+    world.chunks(required, scratch);
+    jobs.parallelFor(scratch.size(), CHUNKS_PER_JOB, [&](size_t begin, size_t end){
+        for(size_t c=begin;c<end;c++) fn(scratch[c]);
+    });
+}
+
+std::vector<size_t> sliceHits;
+
+// findOverlappingRows over slices of `rows`; out keeps ascending order.
+size_t parallelOverlaps(const Archetype& archetype, const std::vector<int>& rows,
+                        float px, float pz, float pr, std::vector<int>& out){
+    size_t slices = (rows.size() + ROWS_PER_JOB - 1) / ROWS_PER_JOB;
+    out.resize(rows.size());
+    sliceHits.assign(slices, 0);
+    jobs.parallelFor(rows.size(), ROWS_PER_JOB, [&](size_t begin, size_t end){
+        sliceHits[begin / ROWS_PER_JOB] =
+            findOverlappingRows(archetype, &rows[begin], end - begin, px, pz, pr, &out[begin]);
+    });
+
+    size_t n = 0;
+    for(size_t s=0;s<slices;s++){
+        size_t begin = s * ROWS_PER_JOB;
+        std::copy(out.begin() + begin, out.begin() + begin + sliceHits[s], out.begin() + n);
+        n += sliceHits[s];
+    }
+    out.resize(n);
+    return n;
+}
+
+// Bumped on every level (re)build so the GL thread knows to rebuild
+// the static geometry and swap texture sets.
+unsigned levelSerial = 0;
+
 void clearLevel(){
-    collectibles.clear();
-    obstacles.clear();
-    crystals.clear();
+    levelSerial++;
+    world.clear();
+    resetSpatialGrids();
     score = 0;
 }
 
+void spawnLevelSingletons(){
+    portalEntity = spawnPortal(world, 0, 0, -(WORLD_HALF - 4.0f), 4.5f);
+    fireSpiritEntity = spawnFireSpirit(world, 2.5f, 2.0f);
+    followSystem(world, playerPos.x, playerPos.y, playerPos.z, playerYaw, animTime);
+}
+
 void setupDesert(){
     clearLevel();
     currentLevel = 1;
@@ -283,30 +497,25 @@ void setupDesert(){
     playerYaw = cameraYaw = 0.0f;
     cameraPitch = 0.0f;
 
-    int COLLECT_COUNT = 10;
-    int OBST_COUNT    = 8;
+    int COLLECT_COUNT = levelCount(countOverride.collectibles, 10);
+    int OBST_COUNT    = levelCount(countOverride.obstacles, 8);
 
+    std::vector<SpawnPoint> gold, stones;
     for(int i=0;i<COLLECT_COUNT;i++){
         Vec3 p = randomUniformPosition(4.5f);
-        collectibles.push_back({ Vec3(p.x,1.4f,p.z), 0.6f, false });
+        gold.push_back({ p.x, 1.4f, p.z });
     }
 
     for(int i=0;i<OBST_COUNT;i++){
         Vec3 p = randomUniformPosition(6.5f);
-        obstacles.push_back({
-            Vec3(p.x,1.0f,p.z),
-            Vec3(0,0,0),
-            1.1f,
-            9999.0f,
-            "stone",
-            true
-        });
-    }
-
-    portal.pos = Vec3(0,0,-(WORLD_HALF - 4.0f));
-    portal.radius = 4.5f;
-    
-    fireSpirit = FireSpirit();
+        stones.push_back({ p.x, 1.0f, p.z });
+    }
+
+    spawnCollectibles(gold, 0.6f);
+    spawnObstacles(stones, 1.1f, OBSTACLE_STONE, true);
+    spawnLevelSingletons();
+
+    buildSpatialGrids();
 }
 
 void setupSnow(){
@@ -319,355 +528,614 @@ void setupSnow(){
     playerYaw = cameraYaw = 0.0f;
     cameraPitch = 0.0f;
 
-    int COLLECT_COUNT = 10;
-    int OBST_COUNT    = 9;
+    int COLLECT_COUNT = levelCount(countOverride.collectibles, 10);
+    int OBST_COUNT    = levelCount(countOverride.obstacles, 9);
+    int CRYSTAL_COUNT = levelCount(countOverride.crystals, 6);
 
+    std::vector<SpawnPoint> ice, icicles;
     for(int i=0;i<COLLECT_COUNT;i++){
         Vec3 p = randomUniformPosition(4.5f);
-        collectibles.push_back({ Vec3(p.x,1.8f,p.z), 0.6f, false });
+        ice.push_back({ p.x, 1.8f, p.z });
     }
 
     for(int i=0;i<OBST_COUNT;i++){
         Vec3 p = randomUniformPosition(6.5f);
-        obstacles.push_back({
-            Vec3(p.x, 14.0f + frand(-1.5f,1.5f), p.z),
-            Vec3(0,0,0),
-            0.5f,
-            0.8f,
-            "icicle",
-            false
-        });
+        icicles.push_back({ p.x, 14.0f + frand(-1.5f,1.5f), p.z });
     }
 
     // Add glowing crystals
-    for(int i=0; i<6; i++){
+    for(int i=0; i<CRYSTAL_COUNT; i++){
         Vec3 p = randomUniformPosition(8.0f);
-        crystals.push_back({ Vec3(p.x, 0.8f, p.z), frand(0, 6.28f) });
+        spawnCrystal(world, p.x, 0.8f, p.z, frand(0, 6.28f));
     }
 
-    portal.pos = Vec3(0,0,-(WORLD_HALF - 4.0f));
-    portal.radius = 4.5f;
-    
-    fireSpirit = FireSpirit();
+    spawnCollectibles(ice, 0.6f);
+    spawnObstacles(icicles, 0.5f, OBSTACLE_ICICLE, false);
+    spawnLevelSingletons();
+
+    buildSpatialGrids();
 }
 
 // =======================================================
-// DRAW FLOOR + WALLS + TEXTURED ROOF
+// VIEW FRUSTUM CULLING
+// Entities whose bounding sphere misses the camera are dropped before
+// they are queued, so they cost no GL work at all.
 // =======================================================
-void drawGroundAndEnvironment(){
-    setupFog();
+Frustum viewFrustum;    // set by renderScene() before anything is queued
+float viewPixelScale;   // pixels per unit at distance 1, likewise
 
-    float half = WORLD_HALF;
-    float h    = WALL_HEIGHT;
+struct CullStats { unsigned long visible, culled; };
+CullStats cullStats;    // this frame's entities
 
-    // Dynamic background color based on day cycle
-    if(currentLevel == 1){
-        float dayTime = std::sin(animTime * 0.15f) * 0.5f + 0.5f;
-        glClearColor(
-            lerp(0.96f, 0.98f, dayTime),
-            lerp(0.90f, 0.94f, dayTime),
-            lerp(0.75f, 0.88f, dayTime),
-            1.0f
-        );
+struct CullScratch { std::vector<float> x, y, z, r; std::vector<int> keep; };
+CullScratch cullScratch;
+
+bool entityVisible(const Vec3& center, float radius){
+    bool visible = viewFrustum.sphereVisible(center.x, center.y, center.z, radius);
+    if(visible) cullStats.visible++;
+    else cullStats.culled++;
+    return visible;
+}
+
+// Keeps the batch's visible instances, in order. The mesh's bound is a
+// sphere of `radius` around (0, centerY, 0); both scale with the instance.
+void cullInstances(InstanceBatch& batch, float centerY, float radius){
+    size_t count = batch.size();
+    InstanceData* inst = batch.data();
+    CullScratch& c = cullScratch;
+    c.x.resize(count);
+    c.y.resize(count);
+    c.z.resize(count);
+    c.r.resize(count);
+    c.keep.resize(count);
+    for(size_t i=0;i<count;i++){
+        c.x[i] = inst[i].x;
+        c.y[i] = inst[i].y + centerY * inst[i].scale;
+        c.z[i] = inst[i].z;
+        c.r[i] = radius * inst[i].scale;
     }
-    else
-        glClearColor(0.88f, 0.94f, 0.98f, 1.0f);
 
-    glEnable(GL_TEXTURE_2D);
+    size_t kept = cullSpheres(viewFrustum, c.x.data(), c.y.data(), c.z.data(), c.r.data(),
+                              count, c.keep.data());
+    for(size_t i=0;i<kept;i++) inst[i] = inst[c.keep[i]];
+    batch.resize(kept);
+    cullStats.visible += kept;
+    cullStats.culled += count - kept;
+}
 
-    // ========== FLOOR TEXTURE ==========
-    if(currentLevel == 1){
-        glBindTexture(GL_TEXTURE_2D, desertFloorTex);
-        float floorRepeat = 8.0f;
+// =======================================================
+// RENDER QUEUE ITEMS
+// Each draw is submitted to renderQueue with the state it needs and
+// runs, sorted, in renderQueue.execute() (see RenderQueue.h).
+// =======================================================
+Vec3 viewEye;   // set by renderScene() before anything is queued
 
-        glColor3f(1.0f, 1.0f, 1.0f);
+float viewDepth(const Vec3& p){
+    float dx = p.x-viewEye.x, dy = p.y-viewEye.y, dz = p.z-viewEye.z;
+    return std::sqrt(dx*dx + dy*dy + dz*dz);
+}
 
-        glBegin(GL_QUADS);
-            glNormal3f(0,1,0);
-            glTexCoord2f(0,0);             glVertex3f(-half,0,-half);
-            glTexCoord2f(floorRepeat,0);   glVertex3f( half,0,-half);
-            glTexCoord2f(floorRepeat,floorRepeat); glVertex3f( half,0, half);
-            glTexCoord2f(0,floorRepeat);   glVertex3f(-half,0, half);
-        glEnd();
+// Surfaces without a sheen of their own share the level's.
+RenderMaterial levelMaterial(){
+    RenderMaterial m = defaultMaterial();
+    if(frame.level == 1){
+        GLfloat spec[] = {0.9f, 0.8f, 0.4f, 1.0f};
+        std::copy(spec, spec+4, m.specular);
+        m.shininess = 70.0f;
     }
     else {
-        glBindTexture(GL_TEXTURE_2D, snowFloorTex);
-        float floorRepeat = 30.0f;
+        GLfloat spec[] = {0.8f, 0.6f, 0.4f, 1.0f};
+        std::copy(spec, spec+4, m.specular);
+        m.shininess = 60.0f;
+    }
+    return m;
+}
+
+void drawMeshItem(const RenderItem& item){
+    static_cast<const GpuMesh*>(item.object)->draw();
+}
+
+// Pixels one world unit covers at p, for level-of-detail choices.
+float pixelsPerUnit(const Vec3& p){
+    return viewPixelScale / std::max(viewDepth(p), 0.1f);
+}
 
-        glColor3f(1.0f, 1.0f, 1.0f);
+// =======================================================
+// DRAW FLOOR + WALLS + TEXTURED ROOF
+// =======================================================
+void queueGroundAndEnvironment(){
+    RenderMaterial m = levelMaterial();
+    m.textured = true;
+    int material = renderQueue.addMaterial(m);
+
+    renderQueue.submit(material, frame.level == 1 ? desertFloorTex : snowFloorTex, 0.0f,
+                       drawMeshItem, &staticWorld.floor);
+    renderQueue.submit(material, frame.level == 1 ? desertWallTex : snowWallTex, 0.0f,
+                       drawMeshItem, &staticWorld.walls);
+    renderQueue.submit(material, roofTex, 0.0f, drawMeshItem, &staticWorld.roof);
+}
 
-        glBegin(GL_QUADS);
-            glNormal3f(0,1,0);
-            glTexCoord2f(0,0); glVertex3f(-half,0,-half);
-            glTexCoord2f(floorRepeat,0); glVertex3f( half,0,-half);
-            glTexCoord2f(floorRepeat,floorRepeat); glVertex3f( half,0, half);
-            glTexCoord2f(0,floorRepeat); glVertex3f(-half,0, half);
-        glEnd();
+// =======================================================
+// PORTAL - Large Textured Rectangle Gateway
+// =======================================================
+void queuePortal(){
+    // Portal shifting light effect
+    float portalShift = std::sin(frame.animTime * 1.5f) * 0.5f + 0.5f;
+    
+    // Pre-translated box: 9 x 12 x 0.8 around a centre 3.5 above the entity
+    if(!entityVisible(Vec3(frame.portal.x, frame.portal.y + 3.5f, frame.portal.z), 7.6f)) return;
+
+    RenderMaterial m = levelMaterial();
+    m.textured = true;
+
+    if(frame.level == 1){
+        m.emission[0] = 0.3f;
+        m.emission[1] = 0.25f;
+        m.emission[2] = 0.1f;
+    } else {
+        m.emission[0] = lerp(0.15f, 0.3f, portalShift);
+        m.emission[1] = lerp(0.2f, 0.1f, portalShift);
+        m.emission[2] = lerp(0.3f, 0.4f, portalShift);
     }
+    
+    // Geometry is pre-translated in buildStaticWorld()
+    renderQueue.submit(renderQueue.addMaterial(m), portalTex, viewDepth(frame.portal),
+                       drawMeshItem, &staticWorld.portal);
+}
 
-    // ========== WALLS ==========
-    if(currentLevel == 1)
-        glBindTexture(GL_TEXTURE_2D, desertWallTex);
-    else
-        glBindTexture(GL_TEXTURE_2D, snowWallTex);
+// =======================================================
+// INSTANCED ENTITY BATCHES
+// Each entity class is packed into one instance buffer per frame and
+// drawn with a single call (see InstanceBatch).
+// =======================================================
+InstanceBatch stoneBatch, icicleBatch, collectibleBatch, crystalBatch;
+
+// Stones and icicles are drawn at several tessellations, one batch per
+// level; stoneBatch and icicleBatch only gather the instances.
+struct LodBatch {
+    float error[MAX_LOD_LEVELS];            // of the unit mesh, before instance scale
+    InstanceBatch levels[MAX_LOD_LEVELS];
+    std::vector<signed char> lastLevel;     // per snapshot instance, -1 = none yet
+};
+LodBatch stoneLod, icicleLod;
+
+// (slices, stacks) per level; level 0 is what the GLUT calls used.
+const int SPHERE_LODS[MAX_LOD_LEVELS][2] = { {32,32}, {16,8}, {10,5}, {6,3} };
+const int ICICLE_LODS[MAX_LOD_LEVELS][2] = { {18,6}, {12,3}, {8,2}, {5,1} };
+float sphereLodError[MAX_LOD_LEVELS];
+
+// Deals the gathered instances out to their levels by projected size.
+void splitLod(InstanceBatch& all, LodBatch& lod){
+    size_t count = all.size();
+    const InstanceData* inst = all.data();
+    // Snapshot order only changes with the entity set; start over then
+    if(lod.lastLevel.size() != count) lod.lastLevel.assign(count, -1);
+    for(InstanceBatch& level : lod.levels) level.clear();
+    for(size_t i=0;i<count;i++){
+        float ppu = pixelsPerUnit(Vec3(inst[i].x, inst[i].y, inst[i].z)) * inst[i].scale;
+        int level = selectLod(lod.error, MAX_LOD_LEVELS, ppu, lod.lastLevel[i]);
+        lod.lastLevel[i] = (signed char)level;
+        lod.levels[level].add(inst[i]);
+    }
+}
 
-    glColor3f(1.0f, 1.0f, 1.0f);
-    float repeat = 10.0f;
+// Instances gathered by one render-list job (up to two batches' worth).
+struct RenderSlice { std::vector<InstanceData> first, second; };
+std::vector<RenderSlice> renderSlices;
 
-    // +Z wall
-    glBegin(GL_QUADS);
-        glNormal3f(0,0,-1);
-        glTexCoord2f(0,0); glVertex3f(-half,0, half);
-        glTexCoord2f(repeat,0); glVertex3f( half,0, half);
-        glTexCoord2f(repeat,repeat); glVertex3f( half,h, half);
-        glTexCoord2f(0,repeat); glVertex3f(-half,h, half);
-    glEnd();
+void resetRenderSlices(size_t chunkCount){
+    renderSlices.resize((chunkCount + CHUNKS_PER_JOB - 1) / CHUNKS_PER_JOB);
+    for(RenderSlice& slice : renderSlices){
+        slice.first.clear();
+        slice.second.clear();
+    }
+}
 
-    // -Z wall
-    glBegin(GL_QUADS);
-        glNormal3f(0,0,1);
-        glTexCoord2f(0,0); glVertex3f(-half,0,-half);
-        glTexCoord2f(0,repeat); glVertex3f(-half,h,-half);
-        glTexCoord2f(repeat,repeat); glVertex3f( half,h,-half);
-        glTexCoord2f(repeat,0); glVertex3f( half,0,-half);
-    glEnd();
+// item.param is the batch colour.
+void drawBatchItem(const RenderItem& item){
+    static_cast<InstanceBatch*>(item.object)->draw(item.param);
+}
 
-    // -X wall
-    glBegin(GL_QUADS);
-        glNormal3f(1,0,0);
-        glTexCoord2f(0,0); glVertex3f(-half,0,-half);
-        glTexCoord2f(repeat,0); glVertex3f(-half,0, half);
-        glTexCoord2f(repeat,repeat); glVertex3f(-half,h, half);
-        glTexCoord2f(0,repeat); glVertex3f(-half,h,-half);
-    glEnd();
+void setupInstanceBatches(){
+    static const float identity[9] = { 1,0,0, 0,1,0, 0,0,1 };
 
-    // +X wall
-    glBegin(GL_QUADS);
-        glNormal3f(-1,0,0);
-        glTexCoord2f(0,0); glVertex3f(half,0,-half);
-        glTexCoord2f(0,repeat); glVertex3f(half,h,-half);
-        glTexCoord2f(repeat,repeat); glVertex3f(half,h, half);
-        glTexCoord2f(repeat,0); glVertex3f(half,0, half);
-    glEnd();
-
-    // ========== TEXTURED ROOF ==========
-    glBindTexture(GL_TEXTURE_2D, roofTex);
-    glColor3f(1.0f, 1.0f, 1.0f);
-    
-    float roofRepeat = 6.0f;
+    // glRotatef(-90,1,0,0) then glutSolidCone(0.45, 1.8)
+    static const float icicleBase[9] = {
+        0.45f, 0.0f,   0.0f,
+        0.0f,  0.0f,   1.8f,
+        0.0f, -0.45f,  0.0f
+    };
+    for(int k=0;k<MAX_LOD_LEVELS;k++){
+        sphereLodError[k] = circleError(SPHERE_LODS[k][0]);
+        stoneLod.error[k] = sphereLodError[k];
+        stoneLod.levels[k].setMesh(&primitiveMesh(PRIM_SPHERE, SPHERE_LODS[k][0], SPHERE_LODS[k][1]).cpu);
+        stoneLod.levels[k].setBaseTransform(identity);
+
+        icicleLod.error[k] = 0.45f * circleError(ICICLE_LODS[k][0]);
+        icicleLod.levels[k].setMesh(&primitiveMesh(PRIM_CONE, ICICLE_LODS[k][0], ICICLE_LODS[k][1]).cpu);
+        icicleLod.levels[k].setBaseTransform(icicleBase);
+    }
 
-    glBegin(GL_QUADS);
-        glNormal3f(0,-1,0);
-        glTexCoord2f(0,0); glVertex3f(-half,h,-half);
-        glTexCoord2f(roofRepeat,0); glVertex3f( half,h,-half);
-        glTexCoord2f(roofRepeat,roofRepeat); glVertex3f( half,h, half);
-        glTexCoord2f(0,roofRepeat); glVertex3f(-half,h, half);
-    glEnd();
-    
-    glDisable(GL_TEXTURE_2D);
+    collectibleBatch.setMesh(&primitiveMesh(PRIM_OCTAHEDRON).cpu);
+    collectibleBatch.setBaseTransform(identity);
+
+    static const float crystalBase[9] = { 0.3f,0,0, 0,0.6f,0, 0,0,0.3f };
+    crystalBatch.setMesh(&primitiveMesh(PRIM_OCTAHEDRON).cpu);
+    crystalBatch.setBaseTransform(crystalBase);
 }
 
 // =======================================================
-// PORTAL - Large Textured Rectangle Gateway
+// SIMULATION SNAPSHOTS
+// The simulation thread publishes everything the GL thread draws as an
+// immutable snapshot after each batch of ticks. The GL thread keeps the
+// latest two and draws one tick behind, blending between them.
 // =======================================================
-void drawPortal(){
-    glPushMatrix();
-    glTranslatef(portal.pos.x, portal.pos.y + 3.5f, portal.pos.z);
+float simStep = 1.0f / 60.0f;   // --tick-hz
+int maxSimSteps = 5;            // --max-steps: ticks run per wake-up at most
+
+struct LightSample { Vec3 pos; float wave; };
+
+struct GameSnapshot {
+    double time;                // steady-clock seconds the last tick stands for
+    unsigned levelSerial;       // 0 until the first publish
+    int level, score;
+    float animTime;
+    Vec3 playerPos, fireSpirit, portal;
+    float playerYaw, cameraYaw, cameraPitch;
+    std::vector<InstanceData> stones, icicles, collectibles, crystals;
+    std::vector<LightSample> crystalLights;     // one per crystal
+
+    GameSnapshot() : time(0), levelSerial(0), level(1), score(0), animTime(0),
+                     playerYaw(0), cameraYaw(0), cameraPitch(0) {}
+};
 
-    // Portal shifting light effect
-    float portalShift = std::sin(animTime * 1.5f) * 0.5f + 0.5f;
-    
-    GLfloat mat_emission[4];
-    
-    if(currentLevel == 1){
-        mat_emission[0] = 0.3f;
-        mat_emission[1] = 0.25f;
-        mat_emission[2] = 0.1f;
-        mat_emission[3] = 1.0f;
-    } else {
-        mat_emission[0] = lerp(0.15f, 0.3f, portalShift);
-        mat_emission[1] = lerp(0.2f, 0.1f, portalShift);
-        mat_emission[2] = lerp(0.3f, 0.4f, portalShift);
-        mat_emission[3] = 1.0f;
+SnapshotBuffer<GameSnapshot> snapshots;
+
+double secondsNow(){
+    using namespace std::chrono;
+    return duration<double>(steady_clock::now().time_since_epoch()).count();
+}
+
+// Simulation thread, after update().
+void publishSnapshot(double tickTime){
+    ProfileScope zone("publishSnapshot");
+    GameSnapshot& s = snapshots.writeBuffer();
+    s.time = tickTime;
+    s.levelSerial = levelSerial;
+    s.level = currentLevel;
+    s.score = score;
+    s.animTime = animTime;
+    s.playerPos = playerPos;
+    s.playerYaw = playerYaw;
+    s.cameraYaw = cameraYaw;
+    s.cameraPitch = cameraPitch;
+    s.fireSpirit = entityPosition(fireSpiritEntity);
+    s.portal = entityPosition(portalEntity);
+
+    parallelChunks(COLLECTIBLE_ARCHETYPE, collectibleChunks,
+                   [](const ChunkView& v){ collectibleBobChunk(v, animTime); });
+    parallelChunks(CRYSTAL_ARCHETYPE, crystalChunks,
+                   [](const ChunkView& v){ crystalPulseChunk(v, animTime); });
+
+    world.chunks(OBSTACLE_ARCHETYPE, obstacleChunks);
+    resetRenderSlices(obstacleChunks.size());
+    jobs.parallelFor(obstacleChunks.size(), CHUNKS_PER_JOB, [&](size_t begin, size_t end){
+        RenderSlice& out = renderSlices[begin / CHUNKS_PER_JOB];
+        for(size_t c=begin;c<end;c++){
+            const ChunkView& v = obstacleChunks[c];
+            const float* x = v.f(COMP_POSITION, POS_X);
+            const float* y = v.f(COMP_POSITION, POS_Y);
+            const float* z = v.f(COMP_POSITION, POS_Z);
+            const float* radius = v.f(COMP_RADIUS);
+            const uint32_t* kind = v.u(COMP_OBSTACLE, OBSTACLE_KIND);
+            for(size_t i=0;i<v.count;i++){
+                if(kind[i] == OBSTACLE_STONE)
+                    out.first.push_back({ x[i], y[i], z[i], 0.0f, radius[i], 1.0f });
+                else
+                    out.second.push_back({ x[i], y[i], z[i], 0.0f, 1.0f, 1.0f });
+            }
+        }
+    });
+    s.stones.clear();
+    s.icicles.clear();
+    for(const RenderSlice& slice : renderSlices){
+        s.stones.insert(s.stones.end(), slice.first.begin(), slice.first.end());
+        s.icicles.insert(s.icicles.end(), slice.second.begin(), slice.second.end());
     }
-    
-    glMaterialfv(GL_FRONT, GL_EMISSION, mat_emission);
-    
-    // Enable texture
-    glEnable(GL_TEXTURE_2D);
-    glBindTexture(GL_TEXTURE_2D, portalTex);
-    glColor3f(1.0f, 1.0f, 1.0f);
-    
-    float width = 4.5f;
-    float height = 6.0f;
-    float depth = 0.4f;
-    
-    // Front face
-    glBegin(GL_QUADS);
-        glNormal3f(0, 0, 1);
-        glTexCoord2f(0, 0); glVertex3f(-width, -height, depth);
-        glTexCoord2f(2, 0); glVertex3f(width, -height, depth);
-        glTexCoord2f(2, 3); glVertex3f(width, height, depth);
-        glTexCoord2f(0, 3); glVertex3f(-width, height, depth);
-    glEnd();
-    
-    // Back face
-    glBegin(GL_QUADS);
-        glNormal3f(0, 0, -1);
-        glTexCoord2f(0, 0); glVertex3f(-width, -height, -depth);
-        glTexCoord2f(0, 3); glVertex3f(-width, height, -depth);
-        glTexCoord2f(2, 3); glVertex3f(width, height, -depth);
-        glTexCoord2f(2, 0); glVertex3f(width, -height, -depth);
-    glEnd();
-    
-    // Left side
-    glBegin(GL_QUADS);
-        glNormal3f(-1, 0, 0);
-        glTexCoord2f(0, 0); glVertex3f(-width, -height, -depth);
-        glTexCoord2f(1, 0); glVertex3f(-width, -height, depth);
-        glTexCoord2f(1, 3); glVertex3f(-width, height, depth);
-        glTexCoord2f(0, 3); glVertex3f(-width, height, -depth);
-    glEnd();
-    
-    // Right side
-    glBegin(GL_QUADS);
-        glNormal3f(1, 0, 0);
-        glTexCoord2f(0, 0); glVertex3f(width, -height, -depth);
-        glTexCoord2f(0, 3); glVertex3f(width, height, -depth);
-        glTexCoord2f(1, 3); glVertex3f(width, height, depth);
-        glTexCoord2f(1, 0); glVertex3f(width, -height, depth);
-    glEnd();
-    
-    // Top
-    glBegin(GL_QUADS);
-        glNormal3f(0, 1, 0);
-        glTexCoord2f(0, 0); glVertex3f(-width, height, -depth);
-        glTexCoord2f(0, 1); glVertex3f(-width, height, depth);
-        glTexCoord2f(2, 1); glVertex3f(width, height, depth);
-        glTexCoord2f(2, 0); glVertex3f(width, height, -depth);
-    glEnd();
-    
-    // Bottom
-    glBegin(GL_QUADS);
-        glNormal3f(0, -1, 0);
-        glTexCoord2f(0, 0); glVertex3f(-width, -height, -depth);
-        glTexCoord2f(2, 0); glVertex3f(width, -height, -depth);
-        glTexCoord2f(2, 1); glVertex3f(width, -height, depth);
-        glTexCoord2f(0, 1); glVertex3f(-width, -height, depth);
-    glEnd();
-    
-    glDisable(GL_TEXTURE_2D);
-    
-    GLfloat no_emission[] = {0.0f, 0.0f, 0.0f, 1.0f};
-    glMaterialfv(GL_FRONT, GL_EMISSION, no_emission);
 
-    glPopMatrix();
+    resetRenderSlices(collectibleChunks.size());
+    jobs.parallelFor(collectibleChunks.size(), CHUNKS_PER_JOB, [&](size_t begin, size_t end){
+        RenderSlice& out = renderSlices[begin / CHUNKS_PER_JOB];
+        for(size_t c=begin;c<end;c++){
+            const ChunkView& v = collectibleChunks[c];
+            const float* x = v.f(COMP_POSITION, POS_X);
+            const float* y = v.f(COMP_POSITION, POS_Y);
+            const float* z = v.f(COMP_POSITION, POS_Z);
+            const uint32_t* flags = v.u(COMP_COLLECTIBLE);
+            const float* bob = v.f(COMP_BOB, BOB_OFFSET);
+            const float* spin = v.f(COMP_BOB, BOB_SPIN);
+            for(size_t i=0;i<v.count;i++){
+                if(flags[i] & ENTITY_COLLECTED) continue;
+                out.first.push_back({ x[i], y[i] + bob[i], z[i], spin[i], 0.5f, 1.0f });
+            }
+        }
+    });
+    s.collectibles.clear();
+    for(const RenderSlice& slice : renderSlices)
+        s.collectibles.insert(s.collectibles.end(), slice.first.begin(), slice.first.end());
+
+    s.crystals.clear();
+    s.crystalLights.clear();
+    for(const ChunkView& v : crystalChunks){
+        const float* x = v.f(COMP_POSITION, POS_X);
+        const float* y = v.f(COMP_POSITION, POS_Y);
+        const float* z = v.f(COMP_POSITION, POS_Z);
+        const float* wave = v.f(COMP_PULSE, PULSE_WAVE);
+        for(size_t i=0;i<v.count;i++){
+            // Pulsing glow effect
+            s.crystals.push_back({ x[i], y[i], z[i], 0.0f, 1.0f, wave[i] * 0.3f + 0.7f });
+            s.crystalLights.push_back({ Vec3(x[i], y[i], z[i]), wave[i] });
+        }
+    }
+
+    snapshots.publish();
+}
+
+// Blends two snapshots' instance lists into a batch. Lists of different
+// length (a pickup, a level switch) are drawn as the newer one.
+void lerpInstances(const std::vector<InstanceData>& from, const std::vector<InstanceData>& to,
+                   float t, InstanceBatch& batch){
+    batch.resize(to.size());
+    InstanceData* out = batch.data();
+    if(from.size() != to.size() || t >= 1.0f){
+        std::copy(to.begin(), to.end(), out);
+        return;
+    }
+    jobs.parallelFor(to.size(), ROWS_PER_JOB, [&](size_t begin, size_t end){
+        for(size_t i=begin;i<end;i++){
+            const InstanceData& a = from[i];
+            const InstanceData& b = to[i];
+            out[i].x = lerp(a.x, b.x, t);
+            out[i].y = lerp(a.y, b.y, t);
+            out[i].z = lerp(a.z, b.z, t);
+            out[i].yawDegrees = lerp(a.yawDegrees, b.yawDegrees, t);
+            out[i].scale = lerp(a.scale, b.scale, t);
+            out[i].pulse = lerp(a.pulse, b.pulse, t);
+        }
+    });
+}
+
+unsigned builtLevelSerial = 0;
+
+// GL thread, start of each frame. Returns false until the first snapshot.
+bool prepareFrame(){
+    snapshots.acquire();
+    const GameSnapshot& prev = snapshots.previous();
+    const GameSnapshot& cur = snapshots.current();
+    if(cur.levelSerial == 0) return false;
+
+    if(cur.levelSerial != builtLevelSerial){
+        buildStaticWorld(cur.level, cur.portal);
+        useLevelTextures(cur.level);
+        builtLevelSerial = cur.levelSerial;
+    }
+
+    // Drawn one tick behind the simulation so there is a pair to blend
+    float t = 1.0f;
+    if(prev.levelSerial == cur.levelSerial && cur.time > prev.time)
+        t = clampf(float((secondsNow() - simStep - prev.time) / (cur.time - prev.time)), 0.0f, 1.0f);
+
+    // Across a level switch prev belongs to the old level; t == 1 drops it
+    frame.alpha = t;
+    frame.level = cur.level;
+    frame.score = cur.score;
+    frame.animTime = lerp(prev.animTime, cur.animTime, t);
+    frame.playerPos = lerp(prev.playerPos, cur.playerPos, t);
+    frame.fireSpirit = lerp(prev.fireSpirit, cur.fireSpirit, t);
+    frame.portal = cur.portal;
+    frame.playerYaw = lerp(prev.playerYaw, cur.playerYaw, t);
+    frame.cameraYaw = lerp(prev.cameraYaw, cur.cameraYaw, t);
+    frame.cameraPitch = lerp(prev.cameraPitch, cur.cameraPitch, t);
+    return true;
 }
 
 // =======================================================
 // DRAW CRYSTALS WITH PULSING GLOW
 // =======================================================
-void drawCrystals(){
-    if(currentLevel != 2) return;
+void queueCrystals(){
+    if(frame.level != 2) return;
     
-    glDisable(GL_TEXTURE_2D);
-    
-    for(auto& crystal : crystals){
-        glPushMatrix();
-        glTranslatef(crystal.pos.x, crystal.pos.y, crystal.pos.z);
-        
-        // Pulsing glow effect
-        float pulse = std::sin(animTime * 2.0f + crystal.glowPhase) * 0.3f + 0.7f;
-        
-        GLfloat mat_emission[] = {
-            0.3f * pulse,
-            0.5f * pulse,
-            0.7f * pulse,
-            1.0f
-        };
-        glMaterialfv(GL_FRONT, GL_EMISSION, mat_emission);
-        
-        glColor3f(0.6f * pulse, 0.8f * pulse, 1.0f * pulse);
-        
-        glScalef(0.3f, 0.6f, 0.3f);
-        glutSolidOctahedron();
-        
-        GLfloat no_emission[] = {0.0f, 0.0f, 0.0f, 1.0f};
-        glMaterialfv(GL_FRONT, GL_EMISSION, no_emission);
-        
-        glPopMatrix();
-    }
+    lerpInstances(snapshots.previous().crystals, snapshots.current().crystals, frame.alpha, crystalBatch);
+    cullInstances(crystalBatch, 0.0f, 0.6f);
+    if(crystalBatch.size() == 0) return;
+
+    // Per-instance colour drives the pulsing emission; the diffuse colour
+    // uses the mean pulse since fixed-function has only one colour-material slot.
+    RenderMaterial m = levelMaterial();
+    m.colorFace = GL_FRONT;
+    m.colorMode = GL_EMISSION;
+    GLfloat mat_diffuse[] = {0.6f * 0.7f, 0.8f * 0.7f, 1.0f * 0.7f, 1.0f};
+    std::copy(mat_diffuse, mat_diffuse+4, m.diffuse);
+
+    float emission[] = {0.3f, 0.5f, 0.7f, 1.0f};
+    renderQueue.submit(renderQueue.addMaterial(m), 0, 0.0f, drawBatchItem, &crystalBatch, emission);
 }
 
 // =======================================================
 // DRAW FIRE SPIRIT ORB - Fixed Texture Rendering
+// item.object is the unit sphere's mesh, item.param the position and
+// radius.
 // =======================================================
-void drawFireSpirit(){
+int fireSpiritLod = -1;     // last frame's levels, for hysteresis
+int fireGlowLod = -1;
+
+void drawSphereItem(const RenderItem& item){
     glPushMatrix();
-    glTranslatef(fireSpirit.pos.x, fireSpirit.pos.y, fireSpirit.pos.z);
+    glTranslatef(item.param[0], item.param[1], item.param[2]);
+    glScalef(item.param[3], item.param[3], item.param[3]);
+    static_cast<const GpuMesh*>(item.object)->draw();
+    glPopMatrix();
+}
+
+GpuMesh* sphereLodMesh(int level){
+    const PrimitiveMesh& mesh = primitiveMesh(PRIM_SPHERE, SPHERE_LODS[level][0], SPHERE_LODS[level][1]);
+    return const_cast<GpuMesh*>(&mesh.gpu);
+}
+
+void queueFireSpirit(){
+    Vec3 pos = frame.fireSpirit;
     
     // Pulsing fire effect
-    float pulse = std::sin(animTime * 4.0f) * 0.2f + 0.8f;
+    float pulse = std::sin(frame.animTime * 4.0f) * 0.2f + 0.8f;
+    if(!entityVisible(pos, std::max(0.5f, 0.7f * pulse))) return;
     
+    // Enhanced material properties for textured orb
+    RenderMaterial m = defaultMaterial();
     GLfloat mat_emission[] = {
         0.6f * pulse,
         0.3f * pulse,
         0.1f * pulse,
         1.0f
     };
-    glMaterialfv(GL_FRONT, GL_EMISSION, mat_emission);
-    
-    // Enhanced material properties for textured orb
     GLfloat mat_specular[] = {0.8f, 0.6f, 0.4f, 1.0f};
-    GLfloat mat_shininess[] = {60.0f};
-    glMaterialfv(GL_FRONT, GL_SPECULAR, mat_specular);
-    glMaterialfv(GL_FRONT, GL_SHININESS, mat_shininess);
-    
-    // Enable texture for fire spirit
-    glEnable(GL_TEXTURE_2D);
-    glBindTexture(GL_TEXTURE_2D, fireSpiritTex);
-    
-    // IMPORTANT: White color to show texture properly
-    glColor3f(1.0f, 1.0f, 1.0f);
-    
-    // Draw textured sphere with proper mapping
-    GLUquadric* quad = gluNewQuadric();
-    gluQuadricTexture(quad, GL_TRUE);
-    gluQuadricNormals(quad, GLU_SMOOTH);
-    gluSphere(quad, 0.5f, 32, 32);
-    gluDeleteQuadric(quad);
-    
-    glDisable(GL_TEXTURE_2D);
-    
-    // Outer glow (no texture) - warm fire color
-    glColor4f(1.0f * pulse, 0.5f * pulse, 0.1f * pulse, 0.25f);
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE);
-    glutSolidSphere(0.7f * pulse, 16, 16);
-    glDisable(GL_BLEND);
-    
-    GLfloat no_emission[] = {0.0f, 0.0f, 0.0f, 1.0f};
-    glMaterialfv(GL_FRONT, GL_EMISSION, no_emission);
-    
-    glPopMatrix();
+    std::copy(mat_emission, mat_emission+4, m.emission);
+    std::copy(mat_specular, mat_specular+4, m.specular);
+    m.shininess = 60.0f;
+
+    // White color to show texture properly
+    RenderMaterial orb = m;
+    orb.textured = true;
+
+    // Outer glow (no texture) - warm fire color, added over everything
+    // opaque in the transparent pass
+    RenderMaterial glow = m;
+    glow.blend = RenderMaterial::BLEND_ADDITIVE;
+    glow.color[0] = 1.0f * pulse;
+    glow.color[1] = 0.5f * pulse;
+    glow.color[2] = 0.1f * pulse;
+    glow.color[3] = 0.25f;
+
+    // Orb and glow each pick a level for their own projected radius
+    float ppu = pixelsPerUnit(pos);
+    fireSpiritLod = selectLod(sphereLodError, MAX_LOD_LEVELS, ppu * 0.5f, fireSpiritLod);
+    fireGlowLod = selectLod(sphereLodError, MAX_LOD_LEVELS, ppu * 0.7f * pulse, fireGlowLod);
+
+    float depth = viewDepth(pos);
+    float orbParam[] = {pos.x, pos.y, pos.z, 0.5f};
+    float glowParam[] = {pos.x, pos.y, pos.z, 0.7f * pulse};
+    renderQueue.submit(renderQueue.addMaterial(orb), fireSpiritTex, depth, drawSphereItem,
+                       sphereLodMesh(fireSpiritLod), orbParam);
+    renderQueue.submit(renderQueue.addMaterial(glow), 0, depth, drawSphereItem,
+                       sphereLodMesh(fireGlowLod), glowParam);
 }
 
 // =======================================================
-// OBSTACLE PHYSICS
+// DRAW OBSTACLES
 // =======================================================
-void integrateObstacles(float dt){
-    for(auto& o : obstacles){
-        if(o.type == "icicle" && !o.grounded){
-            o.vel.y += -4.2f * dt;
-            o.pos.y += o.vel.y * dt;
+void queueObstacles(){
+    lerpInstances(snapshots.previous().stones, snapshots.current().stones, frame.alpha, stoneBatch);
+    lerpInstances(snapshots.previous().icicles, snapshots.current().icicles, frame.alpha, icicleBatch);
+    splitLod(stoneBatch, stoneLod);
+    splitLod(icicleBatch, icicleLod);
+
+    int stoneMaterial;
+    TextureHandle stoneTexture = 0;
+    float stoneColor[] = {1.0f, 1.0f, 1.0f, 1.0f};
+    if(frame.level == 1){
+        RenderMaterial m = levelMaterial();
+        m.textured = true;
+        GLfloat mat_specular[] = {0.3f, 0.3f, 0.3f, 1.0f};
+        std::copy(mat_specular, mat_specular+4, m.specular);
+        m.shininess = 25.0f;
+        stoneMaterial = renderQueue.addMaterial(m);
+        stoneTexture = desertStoneTex;
+    }
+    else {
+        float stone[] = {0.42f, 0.36f, 0.31f, 1.0f};
+        std::copy(stone, stone+4, stoneColor);
+        stoneMaterial = renderQueue.addMaterial(levelMaterial());
+    }
+    float ice[] = {0.92f, 0.97f, 1.0f, 1.0f};
+    int iceMaterial = renderQueue.addMaterial(levelMaterial());
+
+    for(int k=0;k<MAX_LOD_LEVELS;k++){
+        cullInstances(stoneLod.levels[k], 0.0f, 1.0f);
+        if(stoneLod.levels[k].size() > 0)
+            renderQueue.submit(stoneMaterial, stoneTexture, 0.0f, drawBatchItem, &stoneLod.levels[k], stoneColor);
+
+        // Cone 0.45 wide at the base, 1.8 tall
+        cullInstances(icicleLod.levels[k], 0.9f, 1.01f);
+        if(icicleLod.levels[k].size() > 0)
+            renderQueue.submit(iceMaterial, 0, 0.0f, drawBatchItem, &icicleLod.levels[k], ice);
+    }
+}
+
+// =======================================================
+// DRAW COLLECTIBLES - Golden / icy octahedrons
+// =======================================================
+void queueCollectibles(){
+    lerpInstances(snapshots.previous().collectibles, snapshots.current().collectibles,
+                  frame.alpha, collectibleBatch);
+    cullInstances(collectibleBatch, 0.0f, 1.0f);
+    if(collectibleBatch.size() == 0) return;
+
+    if(frame.level == 1){
+        // Golden textured octahedrons; UVs follow the object-linear mapping
+        RenderMaterial m = levelMaterial();
+        m.textured = true;
+        GLfloat mat_specular[] = {0.9f, 0.8f, 0.4f, 1.0f};
+        GLfloat mat_emission[] = {0.15f, 0.12f, 0.02f, 1.0f};
+        std::copy(mat_specular, mat_specular+4, m.specular);
+        std::copy(mat_emission, mat_emission+4, m.emission);
+        m.shininess = 70.0f;
+
+        collectibleBatch.setObjectLinearUV(true);
+        float white[] = {1.0f, 1.0f, 1.0f, 1.0f};
+        renderQueue.submit(renderQueue.addMaterial(m), desertGoldTex, 0.0f,
+                           drawBatchItem, &collectibleBatch, white);
+    }
+    else {
+        // Snow level - blue octahedrons (no texture)
+        collectibleBatch.setObjectLinearUV(false);
+        float blue[] = {0.55f, 0.85f, 1.0f, 1.0f};
+        renderQueue.submit(renderQueue.addMaterial(levelMaterial()), 0, 0.0f,
+                           drawBatchItem, &collectibleBatch, blue);
+    }
+}
+
+// =======================================================
+// DRAW PLAYER
+// =======================================================
+int playerLod = 0;      // chosen by queuePlayer()
+
+void drawPlayer(){
+    glPushMatrix();
+    glTranslatef(frame.playerPos.x, frame.playerPos.y, frame.playerPos.z);
+    glRotatef(frame.playerYaw * 57.2958f, 0,1,0);
+
+    if(playerModel.triangleCount() > 0){
+        glState.color(0.9f,0.6f,0.4f);
+        playerModel.draw(playerLod);
+    }
+    else {
+        glState.color(0.9f,0.6f,0.4f);
+        drawSphere(0.28f,16,12);
+
+        glState.color(0.7f,0.3f,0.2f);
+        glTranslatef(0,-0.55f,0);
+        glScalef(0.6f,0.9f,0.35f);
+        glutSolidCube(1.0f);
+    }
+
+    glPopMatrix();
+}
 
-            if(o.pos.y <= 0.35f){
-                o.pos.y = 0.35f;
-                o.vel.y = 0.0f;
-                o.grounded = true;
-            }
-        }
-    }
+void queuePlayer(){
+    if(playerModel.lodCount() > 1)
+        playerLod = selectLod(playerModel.lodErrors(), playerModel.lodCount(),
+                              pixelsPerUnit(frame.playerPos), playerLod);
+    renderQueue.submit(renderQueue.addMaterial(levelMaterial()), 0, viewDepth(frame.playerPos),
+                       [](const RenderItem&){ drawPlayer(); });
 }
 
 // =======================================================
@@ -679,38 +1147,74 @@ float distXZ(const Vec3& a,const Vec3& b){
     return std::sqrt(dx*dx + dz*dz);
 }
 
+// Every overlap costs a point and puts the player back where the tick
+// started, so overlaps are all tested against the same position.
 void handlePlayerCollisions(){
-    bool pushedBack = false;
+    gridHits.clear();
+    obstacleGrid.query(playerPos.x, playerPos.z, playerRadius + maxObstacleRadius, gridHits);
+
+    size_t hits = parallelOverlaps(*world.archetype(OBSTACLE_ARCHETYPE), gridHits,
+                                   playerPos.x, playerPos.z, playerRadius, overlapHits);
+    if(hits > 0){
+        score = std::max(0, score - (int)hits);
+        playerPos = lastSafePos;
+    }
+}
+
+// =======================================================
+// SIMULATION PHASE TIMING (used by the headless benchmark)
+// =======================================================
+enum SimPhase {
+    PHASE_MOVEMENT,
+    PHASE_OBSTACLES,
+    PHASE_COLLISIONS,
+    PHASE_FIRE_SPIRIT,
+    PHASE_COLLECTIBLES,
+    PHASE_PORTAL,
+    PHASE_COUNT
+};
 
-    for(auto& o : obstacles){
-        float d = distXZ(playerPos, o.pos);
-        float minD = playerRadius + o.radius;
+const char* simPhaseNames[PHASE_COUNT] = {
+    "player movement",
+    "icicle fall",
+    "handlePlayerCollisions",
+    "fire spirit",
+    "collectibles",
+    "portal check"
+};
 
-        if(d < minD){
-            float dx = playerPos.x - o.pos.x;
-            float dz = playerPos.z - o.pos.z;
-            float L = std::sqrt(dx*dx + dz*dz);
-            if(L < 0.0001f) L = 0.0001f;
+bool phaseTimingEnabled = false;
+double phaseSeconds[PHASE_COUNT] = {0};
 
-            float overlap = minD - L;
-            playerPos.x += (dx/L) * overlap;
-            playerPos.z += (dz/L) * overlap;
+struct PhaseTimer {
+    SimPhase phase;
+    std::chrono::steady_clock::time_point start;
 
-            score = std::max(0, score - 1);
-            pushedBack = true;
-        }
+    PhaseTimer(SimPhase p) : phase(p) {
+        if(phaseTimingEnabled) start = std::chrono::steady_clock::now();
     }
-
-    if(pushedBack)
-        playerPos = lastSafePos;
-}
+    ~PhaseTimer(){
+        if(!phaseTimingEnabled) return;
+        std::chrono::duration<double> d = std::chrono::steady_clock::now() - start;
+        phaseSeconds[phase] += d.count();
+    }
+};
 
 // =======================================================
 // UPDATE LOOP
 // =======================================================
-void update(float dt){
-    animTime += dt;
-    
+JobGraph tickGraph;
+
+JobId addPhase(SimPhase phase, std::function<void()> fn,
+               std::initializer_list<JobId> deps = std::initializer_list<JobId>()){
+    return tickGraph.add(simPhaseNames[phase], [phase, fn]{
+        PhaseTimer t(phase);
+        ProfileScope zone(simPhaseNames[phase]);
+        fn();
+    }, deps);
+}
+
+void movePlayer(float dt){
     lastSafePos = playerPos;
 
     Vec3 input(0,0,0);
@@ -734,29 +1238,57 @@ void update(float dt){
     }
 
     playerPos.y = 1.0f;
+}
 
-    integrateObstacles(dt);
-    handlePlayerCollisions();
-    
-    // Update fire spirit
-    fireSpirit.update(dt);
-
-    // Collectibles
-    for(auto& c : collectibles){
-        if(!c.collected && distXZ(playerPos, c.pos) < c.radius + playerRadius + 0.2f){
-            c.collected = true;
-            score += 10;
-        }
+void updateCollectibles(){
+    const float reach = playerRadius + 0.2f;
+    gridHits.clear();
+    collectibleGrid.query(playerPos.x, playerPos.z, maxCollectibleRadius + reach, gridHits);
+
+    Archetype& archetype = *world.archetype(COLLECTIBLE_ARCHETYPE);
+    parallelOverlaps(archetype, gridHits, playerPos.x, playerPos.z, reach, overlapHits);
+    for(int row : overlapHits){
+        size_t slot;
+        Chunk& chunk = World::chunkOf(archetype, row, slot);
+        archetype.u(chunk, COMP_COLLECTIBLE)[slot] |= ENTITY_COLLECTED;
+        score += 10;
+        collectibleGrid.remove(row, archetype.f(chunk, COMP_POSITION, POS_X)[slot],
+                               archetype.f(chunk, COMP_POSITION, POS_Z)[slot]);
+        collectiblesRemaining--;
     }
+}
 
-    // Level switch
-    bool allCollected = true;
-    for(auto& c : collectibles) if(!c.collected) allCollected = false;
+void checkPortal(){
+    bool allCollected = collectiblesRemaining == 0;
 
-    if(allCollected && distXZ(playerPos, portal.pos) < portal.radius + 0.8f){
+    float radius = *world.f(portalEntity, COMP_RADIUS);
+    if(allCollected && distXZ(playerPos, entityPosition(portalEntity)) < radius + 0.8f){
         if(currentLevel == 1) setupSnow();
         else setupDesert();
     }
+}
+
+void update(float dt){
+    ProfileScope zone("update");
+    animTime += dt;
+
+    // movement ---+                  +-- fire spirit --+
+    //              +-- collisions ---+                 +-- portal
+    // icicles -----+                  +-- collectibles -+
+    tickGraph.clear();
+    JobId move    = addPhase(PHASE_MOVEMENT, [dt]{ movePlayer(dt); });
+    JobId icicles = addPhase(PHASE_OBSTACLES, [dt]{
+        parallelChunks(OBSTACLE_ARCHETYPE, obstacleChunks,
+                       [dt](const ChunkView& v){ icicleFallChunk(v, dt); });
+    });
+    JobId hits    = addPhase(PHASE_COLLISIONS, handlePlayerCollisions, { move, icicles });
+    JobId follow  = addPhase(PHASE_FIRE_SPIRIT, []{
+        followSystem(world, playerPos.x, playerPos.y, playerPos.z, playerYaw, animTime);
+    }, { hits });
+    JobId collect = addPhase(PHASE_COLLECTIBLES, updateCollectibles, { hits });
+    // Last: a level switch rebuilds the world
+    addPhase(PHASE_PORTAL, checkPortal, { follow, collect });
+    jobs.run(tickGraph);
 
     float bound = WORLD_HALF - playerRadius - 0.1f;
     playerPos.x = clampf(playerPos.x, -bound, bound);
@@ -765,142 +1297,219 @@ void update(float dt){
 
 // =======================================================
 // SETUP DYNAMIC LIGHTING
+// The frame's lights as one list: sun, fire spirit, then (snow) the
+// portal and every crystal. The per-pixel path (see Lighting.h) uses all
+// of them; the fixed-function fallback the first FIXED_LIGHTS.
 // =======================================================
-void setupDynamicLighting(){
-    glEnable(GL_LIGHTING);
-    glEnable(GL_COLOR_MATERIAL);
-    glColorMaterial(GL_FRONT_AND_BACK, GL_AMBIENT_AND_DIFFUSE);
+bool fixedFunctionLighting = false;     // --fixed-lighting, or no shader support
+const int FIXED_LIGHTS = 6;
+std::vector<PointLight> sceneLights;
+
+PointLight& addSceneLight(const Vec3& pos, float constant, float linear, float quadratic){
+    PointLight l = {};
+    l.position[0] = pos.x;
+    l.position[1] = pos.y;
+    l.position[2] = pos.z;
+    l.constant = constant;
+    l.linear = linear;
+    l.quadratic = quadratic;
+    sceneLights.push_back(l);
+    return sceneLights.back();
+}
 
-    // ========== LIGHT 0: Animated Sun/Main Light ==========
-    glEnable(GL_LIGHT0);
-    
-    if(currentLevel == 1){
+void setRGB(float* dst, float r, float g, float b){
+    dst[0] = r;
+    dst[1] = g;
+    dst[2] = b;
+}
+
+void gatherSceneLights(){
+    sceneLights.clear();
+
+    // ========== Animated Sun/Main Light ==========
+    if(frame.level == 1){
         // Day cycle: orange dawn -> white noon -> orange dusk
-        float dayTime = std::sin(animTime * 0.15f) * 0.5f + 0.5f;
+        float dayTime = std::sin(frame.animTime * 0.15f) * 0.5f + 0.5f;
         
-        float sun[] = {18, 45, 12, 1};
-        float diff[] = {
-            lerp(1.2f, 1.05f, dayTime),
-            lerp(0.7f, 0.95f, dayTime),
-            lerp(0.4f, 0.85f, dayTime),
-            1.0f
-        };
-        float amb[] = {
-            lerp(0.6f, 0.5f, dayTime),
-            lerp(0.45f, 0.48f, dayTime),
-            lerp(0.3f, 0.42f, dayTime),
-            1.0f
-        };
-        float spec[] = {0.4f, 0.4f, 0.3f, 1.0f};
-
-        glLightfv(GL_LIGHT0, GL_POSITION, sun);
-        glLightfv(GL_LIGHT0, GL_DIFFUSE, diff);
-        glLightfv(GL_LIGHT0, GL_AMBIENT, amb);
-        glLightfv(GL_LIGHT0, GL_SPECULAR, spec);
+        PointLight& sun = addSceneLight(Vec3(18, 45, 12), 1.0f, 0.0f, 0.0f);
+        setRGB(sun.diffuse, lerp(1.2f, 1.05f, dayTime), lerp(0.7f, 0.95f, dayTime), lerp(0.4f, 0.85f, dayTime));
+        setRGB(sun.ambient, lerp(0.6f, 0.5f, dayTime), lerp(0.45f, 0.48f, dayTime), lerp(0.3f, 0.42f, dayTime));
+        setRGB(sun.specular, 0.4f, 0.4f, 0.3f);
     }
     else {
-        float sun[] = {12, 50, 18, 1};
-        float diff[] = {0.80f, 0.88f, 1.05f, 1.0f};
-        float amb[] = {0.62f, 0.68f, 0.78f, 1.0f};
-        float spec[] = {0.5f, 0.5f, 0.6f, 1.0f};
-
-        glLightfv(GL_LIGHT0, GL_POSITION, sun);
-        glLightfv(GL_LIGHT0, GL_DIFFUSE, diff);
-        glLightfv(GL_LIGHT0, GL_AMBIENT, amb);
-        glLightfv(GL_LIGHT0, GL_SPECULAR, spec);
+        PointLight& sun = addSceneLight(Vec3(12, 50, 18), 1.0f, 0.0f, 0.0f);
+        setRGB(sun.diffuse, 0.80f, 0.88f, 1.05f);
+        setRGB(sun.ambient, 0.62f, 0.68f, 0.78f);
+        setRGB(sun.specular, 0.5f, 0.5f, 0.6f);
     }
 
-    // ========== LIGHT 1: Fire Spirit Orb ==========
-    glEnable(GL_LIGHT1);
-    
-    float firePulse = std::sin(animTime * 4.0f) * 0.3f + 0.7f;
-    float firePos[] = {fireSpirit.pos.x, fireSpirit.pos.y, fireSpirit.pos.z, 1.0f};
-    float fireDiff[] = {1.0f * firePulse, 0.5f * firePulse, 0.2f * firePulse, 1.0f};
-    float fireAmb[] = {0.3f * firePulse, 0.15f * firePulse, 0.05f * firePulse, 1.0f};
+    // ========== Fire Spirit Orb ==========
+    float firePulse = std::sin(frame.animTime * 4.0f) * 0.3f + 0.7f;
+    PointLight& fire = addSceneLight(frame.fireSpirit, 1.0f, 0.09f, 0.032f);
+    setRGB(fire.diffuse, 1.0f * firePulse, 0.5f * firePulse, 0.2f * firePulse);
+    setRGB(fire.ambient, 0.3f * firePulse, 0.15f * firePulse, 0.05f * firePulse);
+
+    if(frame.level != 2) return;
+
+    // ========== Portal Light ==========
+    float portalShift = std::sin(frame.animTime * 1.5f) * 0.5f + 0.5f;
+    Vec3 portal = frame.portal;
+    PointLight& gate = addSceneLight(Vec3(portal.x, portal.y + 1.2f, portal.z), 1.0f, 0.14f, 0.07f);
+    setRGB(gate.diffuse, lerp(0.4f, 0.6f, portalShift), lerp(0.5f, 0.3f, portalShift), lerp(0.8f, 1.0f, portalShift));
+    setRGB(gate.ambient, 0.2f * gate.diffuse[0], 0.2f * gate.diffuse[1], 0.2f * gate.diffuse[2]);
     
-    glLightfv(GL_LIGHT1, GL_POSITION, firePos);
-    glLightfv(GL_LIGHT1, GL_DIFFUSE, fireDiff);
-    glLightfv(GL_LIGHT1, GL_AMBIENT, fireAmb);
-    glLightf(GL_LIGHT1, GL_CONSTANT_ATTENUATION, 1.0f);
-    glLightf(GL_LIGHT1, GL_LINEAR_ATTENUATION, 0.09f);
-    glLightf(GL_LIGHT1, GL_QUADRATIC_ATTENUATION, 0.032f);
-
-    // ========== LIGHT 2: Portal Light ==========
-    if(currentLevel == 2){
-        glEnable(GL_LIGHT2);
-        
-        float portalShift = std::sin(animTime * 1.5f) * 0.5f + 0.5f;
-        float portalPos[] = {portal.pos.x, portal.pos.y + 1.2f, portal.pos.z, 1.0f};
-        float portalDiff[] = {
-            lerp(0.4f, 0.6f, portalShift),
-            lerp(0.5f, 0.3f, portalShift),
-            lerp(0.8f, 1.0f, portalShift),
-            1.0f
-        };
-        float portalAmb[] = {
-            0.2f * portalDiff[0],
-            0.2f * portalDiff[1],
-            0.2f * portalDiff[2],
-            1.0f
-        };
-        
-        glLightfv(GL_LIGHT2, GL_POSITION, portalPos);
-        glLightfv(GL_LIGHT2, GL_DIFFUSE, portalDiff);
-        glLightfv(GL_LIGHT2, GL_AMBIENT, portalAmb);
-        glLightf(GL_LIGHT2, GL_CONSTANT_ATTENUATION, 1.0f);
-        glLightf(GL_LIGHT2, GL_LINEAR_ATTENUATION, 0.14f);
-        glLightf(GL_LIGHT2, GL_QUADRATIC_ATTENUATION, 0.07f);
-    } else {
-        glDisable(GL_LIGHT2);
+    // ========== Crystal Pulsing Lights ==========
+    for(const LightSample& crystal : snapshots.current().crystalLights){
+        float pulse = crystal.wave * 0.4f + 0.6f;
+        PointLight& l = addSceneLight(crystal.pos, 1.0f, 0.22f, 0.20f);
+        setRGB(l.diffuse, 0.3f * pulse, 0.5f * pulse, 0.8f * pulse);
+        setRGB(l.ambient, 0.1f * pulse, 0.2f * pulse, 0.3f * pulse);
     }
-    
-    // ========== LIGHTS 3-5: Crystal Pulsing Lights (Snow Level) ==========
-    if(currentLevel == 2){
-        for(int i=0; i<std::min(3, (int)crystals.size()); i++){
-            glEnable(GL_LIGHT3 + i);
-            
-            float pulse = std::sin(animTime * 2.0f + crystals[i].glowPhase) * 0.4f + 0.6f;
-            float crystalPos[] = {crystals[i].pos.x, crystals[i].pos.y, crystals[i].pos.z, 1.0f};
-            float crystalDiff[] = {0.3f * pulse, 0.5f * pulse, 0.8f * pulse, 1.0f};
-            float crystalAmb[] = {0.1f * pulse, 0.2f * pulse, 0.3f * pulse, 1.0f};
-            
-            glLightfv(GL_LIGHT3 + i, GL_POSITION, crystalPos);
-            glLightfv(GL_LIGHT3 + i, GL_DIFFUSE, crystalDiff);
-            glLightfv(GL_LIGHT3 + i, GL_AMBIENT, crystalAmb);
-            glLightf(GL_LIGHT3 + i, GL_CONSTANT_ATTENUATION, 1.0f);
-            glLightf(GL_LIGHT3 + i, GL_LINEAR_ATTENUATION, 0.22f);
-            glLightf(GL_LIGHT3 + i, GL_QUADRATIC_ATTENUATION, 0.20f);
+}
+
+void applyFixedFunctionLights(){
+    glState.enable(GL_LIGHTING);
+    glState.enable(GL_COLOR_MATERIAL);
+    glState.colorMaterial(GL_FRONT_AND_BACK, GL_AMBIENT_AND_DIFFUSE);
+
+    for(int i=0; i<FIXED_LIGHTS; i++){
+        GLenum id = GL_LIGHT0 + i;
+        if(i >= (int)sceneLights.size()){
+            glState.disable(id);
+            continue;
+        }
+        const PointLight& l = sceneLights[i];
+        float pos[] = {l.position[0], l.position[1], l.position[2], 1.0f};
+        float diff[] = {l.diffuse[0], l.diffuse[1], l.diffuse[2], 1.0f};
+        float amb[] = {l.ambient[0], l.ambient[1], l.ambient[2], 1.0f};
+        float spec[] = {l.specular[0], l.specular[1], l.specular[2], 1.0f};
+
+        glState.enable(id);
+        glLightfv(id, GL_POSITION, pos);
+        glLightfv(id, GL_DIFFUSE, diff);
+        glLightfv(id, GL_AMBIENT, amb);
+        glLightfv(id, GL_SPECULAR, spec);
+        glLightf(id, GL_CONSTANT_ATTENUATION, l.constant);
+        glLightf(id, GL_LINEAR_ATTENUATION, l.linear);
+        glLightf(id, GL_QUADRATIC_ATTENUATION, l.quadratic);
+    }
+}
+
+// After the camera is set: light positions are taken in its space.
+void setupDynamicLighting(){
+    gatherSceneLights();
+    if(lighting.active()) lighting.update(sceneLights, screenW, screenH);
+    else applyFixedFunctionLights();
+}
+
+// =======================================================
+// CAMERA PATHS
+// One pose per rendered frame, as text:  level x y z yaw pitch mode
+// (mode 0 third person, 1 first person; '#' starts a comment line).
+// --record-camera writes the path the player takes; the render
+// benchmark replays it, or orbits each level when none is given.
+// =======================================================
+struct CameraKey {
+    int level;
+    Vec3 pos;
+    float yaw, pitch;
+    CameraMode mode;
+};
+
+std::ofstream cameraRecording;
+
+// GL thread, once per drawn frame.
+void recordCameraKey(){
+    cameraRecording << frame.level << ' ' << frame.playerPos.x << ' ' << frame.playerPos.y << ' '
+                    << frame.playerPos.z << ' ' << frame.playerYaw << ' ' << frame.cameraPitch << ' '
+                    << (cameraMode == CAM_FIRST ? 1 : 0) << '\n';
+}
+
+bool loadCameraPath(const std::string& path, std::vector<CameraKey>& keys){
+    std::ifstream in(path);
+    if(!in.is_open()){
+        std::cout << "ERROR: Cannot open camera path: " << path << "\n";
+        return false;
+    }
+
+    std::string line;
+    while(std::getline(in, line)){
+        if(line.empty() || line[0] == '#') continue;
+        std::istringstream iss(line);
+        CameraKey k;
+        int mode = 0;
+        if(!(iss >> k.level >> k.pos.x >> k.pos.y >> k.pos.z >> k.yaw >> k.pitch >> mode)) continue;
+        if(k.level != 1 && k.level != 2) continue;
+        k.mode = mode ? CAM_FIRST : CAM_THIRD;
+        keys.push_back(k);
+    }
+    return true;
+}
+
+// A lap around each level facing the centre: third person for the first
+// half, then first person with a slow look up and down.
+void buildOrbitPath(int framesPerLevel, std::vector<CameraKey>& keys){
+    const float radius = WORLD_HALF * 0.55f;
+    for(int level=1; level<=2; level++){
+        for(int i=0; i<framesPerLevel; i++){
+            float u = float(i) / float(framesPerLevel);
+            float angle = u * 6.2831853f;
+            CameraKey k;
+            k.level = level;
+            k.pos = Vec3(radius * std::cos(angle), 1.0f, radius * std::sin(angle));
+            k.yaw = std::atan2(-k.pos.x, k.pos.z);
+            k.mode = u < 0.5f ? CAM_THIRD : CAM_FIRST;
+            k.pitch = k.mode == CAM_FIRST ? 0.25f * std::sin(u * 12.566371f) : 0.0f;
+            keys.push_back(k);
         }
-    } else {
-        glDisable(GL_LIGHT3);
-        glDisable(GL_LIGHT4);
-        glDisable(GL_LIGHT5);
     }
 }
 
 // =======================================================
 // RENDER SCENE
 // =======================================================
+// P toggles the profiler overlay, T writes the recorded zones to
+// traceFile; --trace records from startup and writes on exit.
+bool profilerOverlay = false;
+bool printGLStateStats = false;     // --gl-stats: one line per frame
+bool traceOnExit = false;
+std::string traceFile = "frame_trace.json";
+
 void renderScene(){
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-    glEnable(GL_DEPTH_TEST);
+    profiler.beginFrame();
+    {
+        ProfileScope zone("textures.pump");
+        textures.pump(textureUploadBudgetMs);
+    }
+    {
+        ProfileScope zone("prepareFrame");
+        if(!prepareFrame()) return;
+    }
+    if(cameraRecording.is_open()) recordCameraKey();
+    // Uploads and level rebuilds above bind textures directly
+    glState.beginFrame();
 
+    // Fog first: it picks the clear colour
     setupFog();
 
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    glState.enable(GL_DEPTH_TEST);
+
     // Camera
     glMatrixMode(GL_PROJECTION);
     glLoadIdentity();
-    gluPerspective(60.0f, float(screenW)/float(screenH), 0.1f, 300.0f);
+    gluPerspective(60.0f, float(screenW)/float(screenH), 0.1f, fogViewDistance(frame.level));
 
     glMatrixMode(GL_MODELVIEW);
     glLoadIdentity();
 
     if(cameraMode == CAM_FIRST){
-        Vec3 eye(playerPos.x, playerPos.y+0.8f, playerPos.z);
-        float sy = std::sin(cameraYaw), cy = std::cos(cameraYaw);
-        float lookX = sy * std::cos(cameraPitch);
-        float lookY = std::sin(cameraPitch);
-        float lookZ = -cy * std::cos(cameraPitch);
+        Vec3 eye(frame.playerPos.x, frame.playerPos.y+0.8f, frame.playerPos.z);
+        viewEye = eye;
+        float sy = std::sin(frame.cameraYaw), cy = std::cos(frame.cameraYaw);
+        float lookX = sy * std::cos(frame.cameraPitch);
+        float lookY = std::sin(frame.cameraPitch);
+        float lookZ = -cy * std::cos(frame.cameraPitch);
 
         gluLookAt(eye.x,eye.y,eye.z,
                   eye.x+lookX,eye.y+lookY,eye.z+lookZ,
@@ -910,155 +1519,64 @@ void renderScene(){
         float dist = 6.0f;
         float h = 2.2f;
 
-        float sy = std::sin(playerYaw);
-        float cy = std::cos(playerYaw);
+        float sy = std::sin(frame.playerYaw);
+        float cy = std::cos(frame.playerYaw);
 
         Vec3 forward(sy,0,-cy);
         Vec3 cam(
-            playerPos.x - forward.x*dist,
-            playerPos.y + h,
-            playerPos.z - forward.z*dist
+            frame.playerPos.x - forward.x*dist,
+            frame.playerPos.y + h,
+            frame.playerPos.z - forward.z*dist
         );
+        viewEye = cam;
 
         gluLookAt(cam.x,cam.y,cam.z,
-                  playerPos.x,playerPos.y+0.6f,playerPos.z,
+                  frame.playerPos.x,frame.playerPos.y+0.6f,frame.playerPos.z,
                   0,1,0);
     }
 
-    // Setup dynamic lighting
-    setupDynamicLighting();
-
-    // Draw environment
-    drawGroundAndEnvironment();
-    drawPortal();
-    drawCrystals();
-    drawFireSpirit();
-
-    // ========== OBSTACLES ==========
-    for(auto& o : obstacles){
-        glPushMatrix();
-        glTranslatef(o.pos.x, o.pos.y, o.pos.z);
-
-        if(o.type == "stone" && currentLevel == 1){
-            glEnable(GL_TEXTURE_2D);
-            glBindTexture(GL_TEXTURE_2D, desertStoneTex);
-            glColor3f(1.0f, 1.0f, 1.0f);
-
-            GLfloat mat_specular[] = {0.3f, 0.3f, 0.3f, 1.0f};
-            GLfloat mat_shininess[] = {25.0f};
-            glMaterialfv(GL_FRONT, GL_SPECULAR, mat_specular);
-            glMaterialfv(GL_FRONT, GL_SHININESS, mat_shininess);
-
-            GLUquadric* quad = gluNewQuadric();
-            gluQuadricTexture(quad, GL_TRUE);
-            gluQuadricNormals(quad, GLU_SMOOTH);
-            gluSphere(quad, o.radius, 32, 32);
-            gluDeleteQuadric(quad);
-
-            glDisable(GL_TEXTURE_2D);
-        }
-        else if(o.type == "stone"){
-            glColor3f(0.42f,0.36f,0.31f);
-            glutSolidSphere(o.radius,28,20);
-        }
-        else {
-            glColor3f(0.92f,0.97f,1.0f);
-            glRotatef(-90,1,0,0);
-            glutSolidCone(0.45f,1.8f,18,6);
-        }
-
-        glPopMatrix();
-    }
-
-    // ========== COLLECTIBLES - Fixed Golden Octahedrons with Proper Texture ==========
-    for(size_t i=0;i<collectibles.size();i++){
-        auto& c = collectibles[i];
-        if(!c.collected){
-            float bob = std::sin(animTime*2 + i) * 0.25f;
-
-            glPushMatrix();
-            glTranslatef(c.pos.x, c.pos.y + bob, c.pos.z);
-            glRotatef(animTime*60 + i*20, 0,1,0);
-
-            if(currentLevel == 1){
-                // Golden textured octahedrons - FIXED
-                glEnable(GL_TEXTURE_2D);
-                glBindTexture(GL_TEXTURE_2D, desertGoldTex);
-                
-                // WHITE color for proper texture display
-                glColor3f(1.0f, 1.0f, 1.0f);
-
-                GLfloat mat_specular[] = {0.9f, 0.8f, 0.4f, 1.0f};
-                GLfloat mat_shininess[] = {70.0f};
-                GLfloat mat_emission[] = {0.15f, 0.12f, 0.02f, 1.0f};
-                
-                glMaterialfv(GL_FRONT, GL_SPECULAR, mat_specular);
-                glMaterialfv(GL_FRONT, GL_SHININESS, mat_shininess);
-                glMaterialfv(GL_FRONT, GL_EMISSION, mat_emission);
-
-                glScalef(0.5f, 0.5f, 0.5f);
-                
-                // Use sphere mapping for proper octahedron texture
-                glEnable(GL_TEXTURE_GEN_S);
-                glEnable(GL_TEXTURE_GEN_T);
-                glTexGeni(GL_S, GL_TEXTURE_GEN_MODE, GL_OBJECT_LINEAR);
-                glTexGeni(GL_T, GL_TEXTURE_GEN_MODE, GL_OBJECT_LINEAR);
-                
-                GLfloat s_plane[] = {1.0f, 0.0f, 0.0f, 0.0f};
-                GLfloat t_plane[] = {0.0f, 1.0f, 0.0f, 0.0f};
-                glTexGenfv(GL_S, GL_OBJECT_PLANE, s_plane);
-                glTexGenfv(GL_T, GL_OBJECT_PLANE, t_plane);
-                
-                glutSolidOctahedron();
-                
-                glDisable(GL_TEXTURE_GEN_S);
-                glDisable(GL_TEXTURE_GEN_T);
-
-                GLfloat no_emission[] = {0.0f, 0.0f, 0.0f, 1.0f};
-                glMaterialfv(GL_FRONT, GL_EMISSION, no_emission);
-                
-                glDisable(GL_TEXTURE_2D);
-            }
-            else {
-                // Snow level - blue octahedrons (no texture)
-                glColor3f(0.55f,0.85f,1.0f);
-                glScalef(0.5f, 0.5f, 0.5f);
-                glutSolidOctahedron();
-            }
-
-            glPopMatrix();
-        }
-    }
-
-    // ========== PLAYER ==========
-    glDisable(GL_TEXTURE_2D);
-    
-    glPushMatrix();
-    glTranslatef(playerPos.x, playerPos.y, playerPos.z);
-    glRotatef(playerYaw * 57.2958f, 0,1,0);
-
-    if(!playerMesh.empty()){
-        glColor3f(0.9f,0.6f,0.4f);
-        glBegin(GL_TRIANGLES);
-        for(const auto& v : playerMesh.verts)
-            glVertex3f(v.x, v.y, v.z);
-        glEnd();
-    }
-    else {
-        glColor3f(0.9f,0.6f,0.4f);
-        glutSolidSphere(0.28f,16,12);
+    // World-space frustum of the camera just set, for culling
+    float projection[16], modelview[16];
+    glGetFloatv(GL_PROJECTION_MATRIX, projection);
+    glGetFloatv(GL_MODELVIEW_MATRIX, modelview);
+    viewFrustum.extract(projection, modelview);
+    viewPixelScale = 0.5f * screenH * projection[5];
+    cullStats.visible = cullStats.culled = 0;
 
-        glColor3f(0.7f,0.3f,0.2f);
-        glTranslatef(0,-0.55f,0);
-        glScalef(0.6f,0.9f,0.35f);
-        glutSolidCube(1.0f);
+    // Setup dynamic lighting
+    { ProfileScope zone("setupDynamicLighting", true); setupDynamicLighting(); }
+
+    // Queue the scene, then draw it sorted by state
+    renderQueue.clear();
+    // queue* zones time the CPU submission; the draw* zone set alongside
+    // each times its GL work inside execute()
+    renderQueue.setZone("drawGroundAndEnvironment");
+    { ProfileScope zone("queueGroundAndEnvironment"); queueGroundAndEnvironment(); }
+    renderQueue.setZone("drawPortal");
+    { ProfileScope zone("queuePortal"); queuePortal(); }
+    renderQueue.setZone("drawCrystals");
+    { ProfileScope zone("queueCrystals"); queueCrystals(); }
+    renderQueue.setZone("drawFireSpirit");
+    { ProfileScope zone("queueFireSpirit"); queueFireSpirit(); }
+    renderQueue.setZone("drawObstacles");
+    { ProfileScope zone("queueObstacles"); queueObstacles(); }
+    renderQueue.setZone("drawCollectibles");
+    { ProfileScope zone("queueCollectibles"); queueCollectibles(); }
+    renderQueue.setZone("drawPlayer");
+    { ProfileScope zone("queuePlayer"); queuePlayer(); }
+
+    {
+        // CPU only: GPU timer queries cannot nest, and each draw zone
+        // inside runs its own
+        ProfileScope zone("renderQueue.execute");
+        lighting.bind();
+        renderQueue.execute();
+        lighting.unbind();
     }
 
-    glPopMatrix();
-
     // ========== HUD ==========
-    glDisable(GL_LIGHTING);
-    glDisable(GL_DEPTH_TEST);
+    glState.disable(GL_LIGHTING);
+    glState.disable(GL_DEPTH_TEST);
 
     glMatrixMode(GL_PROJECTION);
     glPushMatrix();
@@ -1069,24 +1587,123 @@ void renderScene(){
     glPushMatrix();
     glLoadIdentity();
 
-    glColor3f(1,1,1);
+    glState.color(1,1,1);
 
-    std::string title = (currentLevel==1 ? "DESERT TEMPLE RUINS" : "FROZEN CAVES");
+    std::string title = (frame.level==1 ? "DESERT TEMPLE RUINS" : "FROZEN CAVES");
     glRasterPos2f(20,screenH-34);
     for(char c : title) glutBitmapCharacter(GLUT_BITMAP_HELVETICA_18,c);
 
-    std::string sc = "Score: " + std::to_string(score);
+    std::string sc = "Score: " + std::to_string(frame.score);
     glRasterPos2f(20,screenH-58);
     for(char c : sc) glutBitmapCharacter(GLUT_BITMAP_HELVETICA_18,c);
 
+    if(profilerOverlay) profiler.drawOverlay(screenW, screenH);
+    if(printGLStateStats)
+        std::cout << glState.frameSummary() << ", queue " << renderQueue.size() << " draws, "
+                  << renderQueue.materialChanges() << " materials, "
+                  << renderQueue.textureChanges() << " textures, culled "
+                  << cullStats.culled << " of " << cullStats.visible + cullStats.culled << " entities\n";
+
     glPopMatrix();
     glMatrixMode(GL_PROJECTION);
     glPopMatrix();
     glMatrixMode(GL_MODELVIEW);
 
+    // Includes any wait for vsync
+    ProfileScope swapZone("glutSwapBuffers");
     glutSwapBuffers();
 }
 
+// =======================================================
+// SIMULATION THREAD
+// Ticks update() at a fixed simStep on its own thread and publishes a
+// snapshot after each batch of ticks, so a slow frame (e.g. a texture upload) does not
+// stall physics and a slow tick does not hold up drawing. GLUT input
+// is queued and applied at the start of the next tick.
+// =======================================================
+struct PendingInput {
+    bool keys[512];
+    float yawDelta, pitchDelta;     // mouse look since the last tick
+    char levelCommand;              // 'l' next level, 'r' restart, 0 none
+};
+
+std::mutex inputLock;
+PendingInput pendingInput = {};
+
+std::thread simThread;
+std::atomic<bool> simStopping(false);
+
+void applyPendingInput(){
+    char command;
+    {
+        std::lock_guard<std::mutex> guard(inputLock);
+        memcpy(keys, pendingInput.keys, sizeof(keys));
+        playerYaw += pendingInput.yawDelta;
+        cameraYaw  = playerYaw;
+        cameraPitch = clampf(cameraPitch + pendingInput.pitchDelta, -1.2f, 1.2f);
+        command = pendingInput.levelCommand;
+        pendingInput.yawDelta = pendingInput.pitchDelta = 0.0f;
+        pendingInput.levelCommand = 0;
+    }
+
+    if(command == 'l'){
+        if(currentLevel == 1) setupSnow();
+        else setupDesert();
+    }
+    if(command == 'r'){
+        if(currentLevel == 1) setupDesert();
+        else setupSnow();
+    }
+}
+
+// Fixed-timestep accumulator: real time accumulates, whole steps are
+// consumed from it. Each wake-up runs at most maxSimSteps ticks; any
+// backlog beyond that is dropped, so a long hitch slows the game down
+// instead of spiralling into ever longer catch-up bursts.
+void simulationLoop(){
+    profiler.nameThread("simulation");
+    typedef std::chrono::steady_clock Clock;
+    const Clock::duration step =
+        std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(simStep));
+
+    Clock::duration accumulator = step;     // first tick straight away
+    Clock::time_point last = Clock::now();
+    while(!simStopping){
+        Clock::time_point now = Clock::now();
+        accumulator += now - last;
+        last = now;
+
+        int steps = 0;
+        while(accumulator >= step && steps < maxSimSteps){
+            applyPendingInput();
+            update(simStep);
+            accumulator -= step;
+            steps++;
+        }
+        if(accumulator >= step) accumulator %= step;
+
+        // Stamped with the time the last tick stands for, not the publish
+        // time, so scheduling jitter does not show up as stutter
+        if(steps > 0)
+            publishSnapshot(std::chrono::duration<double>((now - accumulator).time_since_epoch()).count());
+
+        std::this_thread::sleep_until(now + (step - accumulator));
+    }
+}
+
+void stopSimulation(){
+    if(!simThread.joinable()) return;
+    simStopping = true;
+    simThread.join();
+}
+
+void startSimulation(){
+    simStopping = false;
+    simThread = std::thread(simulationLoop);
+    // Registered after the globals it touches exist, so it runs before they are destroyed
+    std::atexit(stopSimulation);
+}
+
 // =======================================================
 // INPUT
 // =======================================================
@@ -1097,28 +1714,26 @@ void reshape(int w,int h){
 }
 
 void onKeyDown(unsigned char key,int,int){
-    keys[key] = true;
-
     if(key == 27) exit(0);
 
-    if(key=='c' || key=='C'){
+    if(key=='c' || key=='C')
         cameraMode = (cameraMode==CAM_FIRST ? CAM_THIRD : CAM_FIRST);
-        cameraYaw = playerYaw;
-    }
 
-    if(key=='l' || key=='L'){
-        if(currentLevel == 1) setupSnow();
-        else setupDesert();
+    if(key=='p' || key=='P'){
+        profilerOverlay = !profilerOverlay;
+        profiler.setEnabled(profilerOverlay || traceOnExit);
     }
+    if(key=='t' || key=='T') profiler.writeChromeTrace(traceFile);
 
-    if(key=='r' || key=='R'){
-        if(currentLevel == 1) setupDesert();
-        else setupSnow();
-    }
+    std::lock_guard<std::mutex> guard(inputLock);
+    pendingInput.keys[key] = true;
+    if(key=='l' || key=='L') pendingInput.levelCommand = 'l';
+    if(key=='r' || key=='R') pendingInput.levelCommand = 'r';
 }
 
 void onKeyUp(unsigned char key,int,int){
-    keys[key] = false;
+    std::lock_guard<std::mutex> guard(inputLock);
+    pendingInput.keys[key] = false;
 }
 
 bool firstMouse = true;
@@ -1141,39 +1756,495 @@ void onMouseMove(int x,int y){
 
     float sens = 0.0045f;
 
-    playerYaw += dx * sens;
-    cameraYaw  = playerYaw;
-
-    cameraPitch -= dy * sens;
-    cameraPitch = clampf(cameraPitch, -1.2f, 1.2f);
+    std::lock_guard<std::mutex> guard(inputLock);
+    pendingInput.yawDelta += dx * sens;
+    pendingInput.pitchDelta -= dy * sens;
 }
 
 // =======================================================
 // IDLE
 // =======================================================
-void idle(){
-    float t = glutGet(GLUT_ELAPSED_TIME)/1000.0f;
-    float dt = (lastTime==0 ? 1.0f/60.0f : (t-lastTime));
-    lastTime = t;
+// Paces redraws to --max-fps; swaps may also wait on vsync.
+FrameLimiter frameLimiter;
 
-    update(dt);
+void idle(){
+    frameLimiter.wait();
     glutPostRedisplay();
 }
 
+// =======================================================
+// HEADLESS FIXED-TIMESTEP SIMULATION
+// Runs setup + update() with no window so simulation cost can be
+// measured on machines without a GPU. Input comes from a script:
+//   <tick> key <char> down|up
+//   <tick> yaw <radians>
+// Without --script a deterministic wander pattern is built from the seed.
+// =======================================================
+struct ScriptEvent {
+    int tick;
+    bool isYaw;
+    unsigned char key;
+    bool down;
+    float yaw;
+};
+
+struct HeadlessOptions {
+    bool enabled;
+    int ticks;
+    unsigned seed;
+    float dt;
+    std::string scriptPath;
+
+    HeadlessOptions() : enabled(false), ticks(10000), seed(1), dt(1.0f/60.0f) {}
+};
+
+bool loadInputScript(const std::string& path, std::vector<ScriptEvent>& events){
+    std::ifstream in(path);
+    if(!in.is_open()){
+        std::cout << "ERROR: Cannot open input script: " << path << "\n";
+        return false;
+    }
+
+    std::string line;
+    while(std::getline(in, line)){
+        if(line.empty() || line[0] == '#') continue;
+
+        std::istringstream iss(line);
+        ScriptEvent e = { 0, false, 0, false, 0.0f };
+        std::string kind;
+        iss >> e.tick >> kind;
+
+        if(kind == "yaw"){
+            e.isYaw = true;
+            iss >> e.yaw;
+        }
+        else if(kind == "key"){
+            std::string k, state;
+            iss >> k >> state;
+            if(k.empty()) continue;
+            e.key = (unsigned char)k[0];
+            e.down = (state == "down");
+        }
+        else continue;
+
+        events.push_back(e);
+    }
+
+    std::stable_sort(events.begin(), events.end(),
+        [](const ScriptEvent& a, const ScriptEvent& b){ return a.tick < b.tick; });
+    return true;
+}
+
+void buildWanderScript(unsigned seed, int ticks, std::vector<ScriptEvent>& events){
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> turn(-1.2f, 1.2f);
+    std::uniform_int_distribution<int> strafe(0, 2);
+
+    float yaw = 0.0f;
+    events.push_back({ 0, false, 'w', true, 0.0f });
+
+    unsigned char held = 0;
+    for(int t = 90; t < ticks; t += 90){
+        yaw += turn(rng);
+        events.push_back({ t, true, 0, false, yaw });
+
+        if(held) events.push_back({ t, false, held, false, 0.0f });
+        int s = strafe(rng);
+        held = (s == 0 ? 0 : (s == 1 ? 'a' : 'd'));
+        if(held) events.push_back({ t, false, held, true, 0.0f });
+    }
+}
+
+int runHeadless(const HeadlessOptions& opt){
+    std::vector<ScriptEvent> script;
+    if(!opt.scriptPath.empty()){
+        if(!loadInputScript(opt.scriptPath, script)) return 1;
+    }
+    else buildWanderScript(opt.seed, opt.ticks, script);
+
+    srand(opt.seed);
+    setupDesert();
+
+    for(int p=0; p<PHASE_COUNT; p++) phaseSeconds[p] = 0.0;
+    phaseTimingEnabled = true;
+
+    int levelSwitches = 0;
+    size_t next = 0;
+
+    auto start = std::chrono::steady_clock::now();
+
+    for(int tick=0; tick<opt.ticks; tick++){
+        while(next < script.size() && script[next].tick <= tick){
+            const ScriptEvent& e = script[next++];
+            if(e.isYaw){
+                playerYaw = cameraYaw = e.yaw;
+            } else {
+                keys[e.key] = e.down;
+            }
+        }
+
+        int level = currentLevel;
+        update(opt.dt);
+        if(currentLevel != level) levelSwitches++;
+    }
+
+    std::chrono::duration<double> wall = std::chrono::steady_clock::now() - start;
+    phaseTimingEnabled = false;
+
+    double total = wall.count();
+    std::cout << "Headless run: " << opt.ticks << " ticks, dt "
+              << opt.dt << " s, seed " << opt.seed << ", "
+              << jobs.threadCount() << " job threads\n";
+    std::cout << "  wall time : " << total << " s ("
+              << (total > 0 ? opt.ticks / total : 0.0) << " ticks/s)\n";
+
+    for(int p=0; p<PHASE_COUNT; p++){
+        double perTick = opt.ticks > 0 ? phaseSeconds[p] * 1e9 / opt.ticks : 0.0;
+        std::cout << "  " << simPhaseNames[p] << " : "
+                  << perTick << " ns/tick ("
+                  << (total > 0 ? 100.0 * phaseSeconds[p] / total : 0.0) << "%)\n";
+    }
+
+    std::cout << "  final state : level " << currentLevel
+              << ", score " << score
+              << ", level switches " << levelSwitches
+              << ", player (" << playerPos.x << ", " << playerPos.z << ")\n";
+    return 0;
+}
+
+// =======================================================
+// RENDER BENCHMARK
+// Renders a camera path through both levels back to back and reports
+// frame-time percentiles and draw calls. The simulation thread is not
+// started: each frame poses the player from the path and publishes a
+// snapshot directly, so a run renders the same images every time and
+// frames can be checked against a reference set. Runs in the window in
+// the game build; the renderbench target runs it offscreen.
+// =======================================================
+struct RenderBenchOptions {
+    bool enabled;
+    int framesPerLevel;     // orbit path length when no --camera-path
+    int warmup;             // frames skipped in the stats after each level load
+    std::string pathFile;
+    std::string dumpDir;    // --dump-frames: write frame_NNNNN.ppm
+    std::string compareDir; // --compare-frames: diff against a dump
+    int tolerance;          // per-channel difference still counted as equal
+
+    RenderBenchOptions() : enabled(false), framesPerLevel(300), warmup(10), tolerance(2) {}
+};
+
+std::string frameFileName(const std::string& dir, size_t index){
+    char name[32];
+    snprintf(name, sizeof(name), "/frame_%05u.ppm", (unsigned)index);
+    return dir + name;
+}
+
+// Reads back the current frame as top-down RGB.
+void readFrame(std::vector<unsigned char>& rgb){
+    rgb.resize((size_t)screenW * screenH * 3);
+    std::vector<unsigned char> rows(rgb.size());
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, screenW, screenH, GL_RGB, GL_UNSIGNED_BYTE, &rows[0]);
+    size_t stride = (size_t)screenW * 3;
+    for(int y=0; y<screenH; y++)
+        memcpy(&rgb[y * stride], &rows[(screenH - 1 - y) * stride], stride);
+}
+
+bool writePPM(const std::string& path, const std::vector<unsigned char>& rgb){
+    std::ofstream out(path, std::ios::binary);
+    if(!out){
+        std::cout << "ERROR: Cannot write frame: " << path << "\n";
+        return false;
+    }
+    out << "P6\n" << screenW << " " << screenH << "\n255\n";
+    out.write((const char*)&rgb[0], rgb.size());
+    return true;
+}
+
+bool readPPM(const std::string& path, int& w, int& h, std::vector<unsigned char>& rgb){
+    std::ifstream in(path, std::ios::binary);
+    std::string magic;
+    int maxValue = 0;
+    if(!(in >> magic >> w >> h >> maxValue) || magic != "P6" || maxValue != 255) return false;
+    in.get();
+    rgb.resize((size_t)w * h * 3);
+    return (bool)in.read((char*)&rgb[0], rgb.size());
+}
+
+// Pixels with any channel off by more than `tolerance`.
+size_t countDifferentPixels(const std::vector<unsigned char>& a, const std::vector<unsigned char>& b, int tolerance){
+    size_t n = 0;
+    for(size_t i=0; i+2<a.size(); i+=3)
+        if(std::abs(a[i]-b[i]) > tolerance || std::abs(a[i+1]-b[i+1]) > tolerance ||
+           std::abs(a[i+2]-b[i+2]) > tolerance) n++;
+    return n;
+}
+
+double percentile(const std::vector<double>& sorted, int p){
+    return sorted.empty() ? 0.0 : sorted[(sorted.size() - 1) * p / 100];
+}
+
+int runRenderBenchmark(const RenderBenchOptions& opt){
+    std::vector<CameraKey> path;
+    if(!opt.pathFile.empty()){
+        if(!loadCameraPath(opt.pathFile, path)) return 1;
+    }
+    else buildOrbitPath(opt.framesPerLevel, path);
+    if(path.empty()){
+        std::cout << "ERROR: Camera path has no frames\n";
+        return 1;
+    }
+    if(!opt.dumpDir.empty()) mkdir(opt.dumpDir.c_str(), 0755);
+
+    std::vector<double> frameMs;
+    unsigned long calls = 0, triangles = 0, stateIssued = 0, stateSkipped = 0;
+    unsigned long lightsTotal = 0;
+    double lightsPerCluster = 0;
+    unsigned long entitiesVisible = 0, entitiesCulled = 0;
+    size_t compared = 0, mismatched = 0;
+    std::vector<unsigned char> rgb, reference;
+
+    int level = 0, sinceLoad = 0;
+    for(size_t i=0; i<path.size(); i++){
+        const CameraKey& k = path[i];
+        bool load = k.level != level;
+        if(load){
+            level = k.level;
+            sinceLoad = 0;
+            srand(1);   // same layout every run
+            if(level == 1) setupDesert();
+            else setupSnow();
+        }
+        playerPos = k.pos;
+        playerYaw = cameraYaw = k.yaw;
+        cameraPitch = k.pitch;
+        cameraMode = k.mode;
+        animTime = i * simStep;
+        followSystem(world, playerPos.x, playerPos.y, playerPos.z, playerYaw, animTime);
+        // Stamped in the past so prepareFrame draws it as is, unblended
+        publishSnapshot(secondsNow() - 1.0);
+        if(load){
+            // Build the level's GL side and finish its textures before timing
+            prepareFrame();
+            while(textures.pendingCount() > 0){
+                textures.pump(1000.0);
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        }
+
+        drawStats.calls = drawStats.triangles = 0;
+        double start = secondsNow();
+        renderScene();
+        glFinish();
+        double ms = (secondsNow() - start) * 1000.0;
+
+        if(sinceLoad++ >= opt.warmup){
+            frameMs.push_back(ms);
+            calls += drawStats.calls;
+            triangles += drawStats.triangles;
+            stateIssued += glState.total().issued;
+            stateSkipped += glState.total().skipped;
+            lightsTotal += sceneLights.size();
+            lightsPerCluster += lighting.averageLightsPerCluster();
+            entitiesVisible += cullStats.visible;
+            entitiesCulled += cullStats.culled;
+        }
+
+        if(opt.dumpDir.empty() && opt.compareDir.empty()) continue;
+        readFrame(rgb);
+        if(!opt.dumpDir.empty() && !writePPM(frameFileName(opt.dumpDir, i), rgb)) return 1;
+        if(!opt.compareDir.empty()){
+            int w = 0, h = 0;
+            compared++;
+            if(!readPPM(frameFileName(opt.compareDir, i), w, h, reference) || w != screenW || h != screenH){
+                std::cout << "  frame " << i << ": no matching reference\n";
+                mismatched++;
+                continue;
+            }
+            size_t diff = countDifferentPixels(rgb, reference, opt.tolerance);
+            if(diff > 0){
+                std::cout << "  frame " << i << ": " << diff << " pixels differ\n";
+                mismatched++;
+            }
+        }
+    }
+
+    std::vector<double> sorted(frameMs);
+    std::sort(sorted.begin(), sorted.end());
+    double total = 0;
+    for(double ms : frameMs) total += ms;
+    size_t n = frameMs.size();
+
+    std::cout << "Render benchmark: " << path.size() << " frames at " << screenW << "x" << screenH
+              << ", " << n << " timed\n";
+    std::cout << "  frame time : avg " << (n ? total / n : 0.0) << " ms, p50 " << percentile(sorted, 50)
+              << " ms, p95 " << percentile(sorted, 95) << " ms, p99 " << percentile(sorted, 99)
+              << " ms, max " << (n ? sorted.back() : 0.0) << " ms\n";
+    std::cout << "  per frame  : " << (n ? double(calls) / n : 0.0) << " draw calls, "
+              << (n ? double(triangles) / n : 0.0) << " triangles, "
+              << (n ? double(stateIssued) / n : 0.0) << " state changes ("
+              << (n ? double(stateSkipped) / n : 0.0) << " redundant skipped)\n";
+    std::cout << "  lighting   : " << (fixedFunctionLighting ? "fixed-function, " : "per-pixel, ")
+              << (n ? double(lightsTotal) / n : 0.0) << " lights";
+    if(!fixedFunctionLighting) std::cout << ", " << (n ? lightsPerCluster / n : 0.0) << " per lit cluster";
+    std::cout << "\n";
+    std::cout << "  culling    : " << (n ? double(entitiesVisible) / n : 0.0) << " entities drawn, "
+              << (n ? double(entitiesCulled) / n : 0.0) << " culled\n";
+    if(!opt.dumpDir.empty())
+        std::cout << "  frames written to " << opt.dumpDir << "\n";
+    if(!opt.compareDir.empty())
+        std::cout << "  compared " << compared << " frames with " << opt.compareDir << ": "
+                  << mismatched << " differ\n";
+    return mismatched > 0 ? 1 : 0;
+}
+
 // =======================================================
 // MAIN
 // =======================================================
+void writeExitTrace(){
+    profiler.writeChromeTrace(traceFile);
+}
+
 int main(int argc,char** argv){
-    srand((unsigned)time(nullptr));
+    registerGameComponents(world);
+
+    HeadlessOptions headless;
+    int jobThreads = 0;
+    int tickHz = 60;
+    double maxFps = 0;      // 0 = unlimited
+    int vsync = 1;
+    RenderBenchOptions renderBench;
+#ifdef OFFSCREEN_GLUT
+    // No window to play in; the offscreen build only benchmarks
+    renderBench.enabled = true;
+#endif
+    for(int i=1; i<argc; i++){
+        std::string arg = argv[i];
+        if(arg == "--headless") headless.enabled = true;
+        else if(arg == "--ticks" && i+1 < argc) headless.ticks = atoi(argv[++i]);
+        else if(arg == "--seed" && i+1 < argc) headless.seed = (unsigned)strtoul(argv[++i], nullptr, 10);
+        else if(arg == "--dt" && i+1 < argc) headless.dt = (float)atof(argv[++i]);
+        else if(arg == "--script" && i+1 < argc) headless.scriptPath = argv[++i];
+        else if(arg == "--collectibles" && i+1 < argc) countOverride.collectibles = atoi(argv[++i]);
+        else if(arg == "--obstacles" && i+1 < argc) countOverride.obstacles = atoi(argv[++i]);
+        else if(arg == "--crystals" && i+1 < argc) countOverride.crystals = atoi(argv[++i]);
+        else if(arg == "--threads" && i+1 < argc) jobThreads = atoi(argv[++i]);
+        else if(arg == "--tick-hz" && i+1 < argc) tickHz = atoi(argv[++i]);
+        else if(arg == "--max-steps" && i+1 < argc) maxSimSteps = std::max(1, atoi(argv[++i]));
+        else if(arg == "--max-fps" && i+1 < argc) maxFps = atof(argv[++i]);
+        else if(arg == "--vsync" && i+1 < argc) vsync = atoi(argv[++i]);
+        else if(arg == "--profile") profilerOverlay = true;
+        else if(arg == "--gl-stats") printGLStateStats = true;
+        else if(arg == "--fixed-lighting") fixedFunctionLighting = true;
+        else if(arg == "--bench-render"){
+            renderBench.enabled = true;
+            if(i+1 < argc && isdigit((unsigned char)argv[i+1][0])) renderBench.framesPerLevel = atoi(argv[++i]);
+        }
+        else if(arg == "--camera-path" && i+1 < argc) renderBench.pathFile = argv[++i];
+        else if(arg == "--dump-frames" && i+1 < argc) renderBench.dumpDir = argv[++i];
+        else if(arg == "--compare-frames" && i+1 < argc) renderBench.compareDir = argv[++i];
+        else if(arg == "--frame-tolerance" && i+1 < argc) renderBench.tolerance = atoi(argv[++i]);
+        else if(arg == "--size" && i+2 < argc){
+            screenW = std::max(1, atoi(argv[++i]));
+            screenH = std::max(1, atoi(argv[++i]));
+        }
+        else if(arg == "--record-camera" && i+1 < argc){
+            cameraRecording.open(argv[++i]);
+            if(!cameraRecording) std::cout << "ERROR: Cannot write camera path: " << argv[i] << "\n";
+            else {
+                cameraRecording.precision(9);   // replays the same frames
+                cameraRecording << "# level x y z yaw pitch mode\n";
+            }
+        }
+        else if(arg == "--trace" && i+1 < argc){
+            traceFile = argv[++i];
+            traceOnExit = true;
+        }
+        else if(arg == "--texture-budget-ms" && i+1 < argc) textureUploadBudgetMs = atof(argv[++i]);
+        else if(arg == "--bake-mesh"){
+            // Offline bake: --bake-mesh a.obj b.obj ...
+            bool ok = true;
+            while(i+1 < argc && argv[i+1][0] != '-'){
+                ObjModel model;
+                ok = model.bake(argv[++i]) && ok;
+            }
+            return ok ? 0 : 1;
+        }
+        else if(arg == "--bench-obj"){
+            int faces = (i+1 < argc && isdigit((unsigned char)argv[i+1][0])) ? atoi(argv[++i]) : 0;
+            return runObjParserBenchmark(faces);
+        }
+        else if(arg == "--bench-grid"){
+            int entities = (i+1 < argc && isdigit((unsigned char)argv[i+1][0])) ? atoi(argv[++i]) : 0;
+            return runSpatialGridBenchmark(entities);
+        }
+        else if(arg == "--bench-soa"){
+            int entities = (i+1 < argc && isdigit((unsigned char)argv[i+1][0])) ? atoi(argv[++i]) : 0;
+            return runEntityLayoutBenchmark(entities);
+        }
+        else if(arg == "--bench-lights"){
+            int lights = (i+1 < argc && isdigit((unsigned char)argv[i+1][0])) ? atoi(argv[++i]) : 0;
+            jobs.start(jobThreads);
+            return runLightClusterBenchmark(lights);
+        }
+        else if(arg == "--bench-cull"){
+            int spheres = (i+1 < argc && isdigit((unsigned char)argv[i+1][0])) ? atoi(argv[++i]) : 0;
+            return runFrustumCullBenchmark(spheres);
+        }
+    }
 
-    playerMesh = loadOBJ("player.obj");
+    profiler.nameThread("main");
+    profiler.setEnabled(profilerOverlay || traceOnExit);
+    // Written after the simulation thread stops (atexit runs in reverse)
+    if(traceOnExit) std::atexit(writeExitTrace);
 
-    setupDesert();
+    // Simulation and render-list jobs; 0 = one thread per core
+    jobs.start(jobThreads);
+
+    if(headless.enabled)
+        return runHeadless(headless);
+
+    srand((unsigned)time(nullptr));
+
+    // Optional model; the sphere + cube fallback is drawn without it
+    if(std::ifstream("player.obj").good() || std::ifstream("player.obj.bake").good())
+        playerModel.load("player.obj");
 
     glutInit(&argc,argv);
     glutInitDisplayMode(GLUT_DOUBLE | GLUT_RGBA | GLUT_DEPTH);
     glutInitWindowSize(screenW,screenH);
     glutCreateWindow("GLUT Game — Enhanced Lighting");
+    glContextReady = true;
+
+    if(tickHz <= 0){
+        std::cout << "ERROR: --tick-hz must be positive, using 60\n";
+        tickHz = 60;
+    }
+    simStep = 1.0f / float(tickHz);
+    if(renderBench.enabled) setSwapInterval(0);     // time frames, not the display
+    else if(!setSwapInterval(vsync ? 1 : 0) && vsync && maxFps <= 0){
+        // Without vsync or a cap, idle() would redraw flat out
+        std::cout << "Vsync control unavailable, capping at 60 fps\n";
+        maxFps = 60;
+    }
+    frameLimiter.setRate(maxFps);
+
+    // Textures stream in the background; a placeholder is bound until each is ready
+    textures.start();
+
+    // Tessellate every primitive the levels use up front
+    for(int k=0;k<MAX_LOD_LEVELS;k++){
+        primitiveMesh(PRIM_SPHERE, SPHERE_LODS[k][0], SPHERE_LODS[k][1]);
+        primitiveMesh(PRIM_CONE, ICICLE_LODS[k][0], ICICLE_LODS[k][1]);
+    }
+    primitiveMesh(PRIM_SPHERE, 16, 12);     // player fallback head
+    primitiveMesh(PRIM_OCTAHEDRON);
+    setupInstanceBatches();
+
+    // First level is built here; the GL side is set up from its snapshot
+    setupDesert();
+    publishSnapshot(secondsNow());
+    prepareFrame();
 
     glEnable(GL_DEPTH_TEST);
     glEnable(GL_NORMALIZE);
@@ -1188,37 +2259,17 @@ int main(int argc,char** argv){
     glEnable(GL_BLEND);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
-    // Load all textures
-    std::cout << "Loading textures...\n";
-    
-    desertWallTex   = loadBMP("rock_boulder_cracked_diff_4k.bmp");
-    if(desertWallTex) std::cout << "  ✓ Desert wall texture loaded\n";
-    
-    snowWallTex     = loadBMP("jersey_melange_diff_4k.bmp");
-    if(snowWallTex) std::cout << "  ✓ Snow wall texture loaded\n";
-    
-    desertFloorTex  = loadBMP("Ground095A_4K-JPG_Color.bmp");
-    if(desertFloorTex) std::cout << "  ✓ Desert floor texture loaded\n";
-    
-    snowFloorTex    = loadBMP("Snow008A_4K-JPG_Color.bmp");
-    if(snowFloorTex) std::cout << "  ✓ Snow floor texture loaded\n";
-    
-    desertStoneTex  = loadBMP("large_sandstone_blocks_01_diff_4k.bmp");
-    if(desertStoneTex) std::cout << "  ✓ Desert stone texture loaded\n";
-    
-    desertGoldTex   = loadBMP("Metal042B.bmp");
-    if(desertGoldTex) std::cout << "  ✓ Desert gold texture loaded\n";
-    
-    roofTex = loadBMP("large_sandstone_blocks_01_diff_4k.bmp");
-    if(roofTex) std::cout << "  ✓ Roof texture loaded\n";
-    
-    fireSpiritTex = loadBMP("ChristmasTreeOrnament014_4K-JPG_Color.bmp");
-    if(fireSpiritTex) std::cout << "  ✓ Fire spirit texture loaded\n";
-    
-    portalTex = loadBMP("large_sandstone_blocks_01_diff_4k.bmp");
-    if(portalTex) std::cout << "  ✓ Portal texture loaded\n";
-    
-    std::cout << "\n✨ All textures loaded successfully!\n\n";
+    if(!fixedFunctionLighting && !lighting.init()) fixedFunctionLighting = true;
+
+    if(renderBench.enabled)
+        return runRenderBenchmark(renderBench);
+
+    std::cout << "\n✨ Streaming " << textures.pendingCount() << " textures\n";
+    std::cout << "Simulation " << tickHz << " Hz (up to " << maxSimSteps << " catch-up ticks), vsync "
+              << (vsync ? "on" : "off") << ", "
+              << (fixedFunctionLighting ? "fixed-function" : "per-pixel") << " lighting, frame cap ";
+    if(maxFps > 0) std::cout << maxFps << " fps\n\n";
+    else std::cout << "none\n\n";
     std::cout << "🎮 ENHANCED FEATURES:\n";
     std::cout << "  • Dynamic day/night cycle (desert)\n";
     std::cout << "  • Pulsing crystal lights (snow caves)\n";
@@ -1229,6 +2280,7 @@ int main(int argc,char** argv){
     std::cout << "  WASD - Move\n";
     std::cout << "  Mouse - Look around\n";
     std::cout << "  C - Toggle camera mode\n";
+    std::cout << "  P - Profiler overlay, T - Write trace (" << traceFile << ")\n";
     std::cout << "  L - Next level\n";
     std::cout << "  R - Restart level\n";
     std::cout << "  ESC - Quit\n\n";
@@ -1241,6 +2293,7 @@ int main(int argc,char** argv){
     glutMotionFunc(onMouseMove);
     glutIdleFunc(idle);
 
+    startSimulation();
     glutMainLoop();
     return 0;
 }